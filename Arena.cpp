@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+#include "Arena.h"
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <vector>
+using namespace std;
+
+/** @brief Chunk size, for those who need its address */
+const size_t Arena::CHUNK_SIZE;
+
+/** @brief Constructor */
+Arena::Arena():
+	chunks(), cursor( NULL ), remaining( 0 ), reserved( 0 ) {}
+
+/** @brief Destructor */
+Arena::~Arena()
+{
+	release();
+}
+
+/** @brief New chunk */
+void* Arena::refill( size_t bytes, size_t alignment )
+{
+	size_t length=max( CHUNK_SIZE, bytes+alignment-1 ); //room to align
+	
+	chunks.reserve( chunks.size()+1 ); //so that push_back() can't throw
+	cursor=static_cast< char* >( ::operator new( length ) );
+	chunks.push_back( cursor );
+	remaining=length;
+	reserved+=length;
+	
+	return allocate( bytes, alignment );
+}
+
+/** @brief Free it all */
+void Arena::release()
+{
+	for( vector< char* >::iterator chunk=chunks.begin();
+		chunk!=chunks.end(); ++chunk )
+		::operator delete( *chunk );
+	chunks.clear();
+	cursor=NULL;
+	remaining=reserved=0;
+}
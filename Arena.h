@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/**
+A bump allocator that carves allocations out of large chunks and frees them
+all at once.  Individual allocations are never returned; instead, the whole
+arena is released together, which makes tearing down millions of small
+objects as cheap as freeing a handful of chunks.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+class Arena
+{
+	private:
+		/** How many bytes each chunk holds, unless a single
+			allocation needs more */
+		static const std::size_t CHUNK_SIZE=1<<20;
+		
+		/** Every chunk we've obtained since we were last released */
+		std::vector< char* > chunks;
+		
+		/** Where the next allocation may begin */
+		char* cursor;
+		
+		/** How many bytes are left after <tt>cursor</tt> */
+		std::size_t remaining;
+		
+		/** How many bytes the chunks add up to */
+		std::size_t reserved;
+		
+		/**
+		Copy constructor.  Not implemented, since an arena owns its
+			chunks.
+		*/
+		Arena( const Arena& );
+		
+		/**
+		Assignment operator.  Not implemented, for the same reason.
+		*/
+		Arena& operator=( const Arena& );
+		
+		/**
+		Starts a new chunk that can accommodate an allocation.
+		@param bytes the allocation's size
+		@param alignment the allocation's alignment
+		@return the allocation
+		@throws std::bad_alloc if the system has no more to give
+		*/
+		void* refill( std::size_t bytes, std::size_t alignment );
+	
+	public:
+		/**
+		Constructor, which doesn't allocate anything yet.
+		*/
+		Arena( void );
+		
+		/**
+		Destructor, which releases everything.
+		*/
+		~Arena( void );
+		
+		/**
+		Allocates some memory, which remains valid until the next
+			<tt>release()</tt>.
+		@pre <tt>alignment</tt> is a power of two.
+		@param bytes how much
+		@param alignment the boundary it should start on
+		@return the memory
+		@throws std::bad_alloc if the system has no more to give
+		*/
+		inline void* allocate( std::size_t bytes, std::size_t
+			alignment );
+		
+		/**
+		Frees everything ever allocated from the arena.
+		*/
+		void release( void );
+		
+		/**
+		Counts the memory we're holding onto.
+		@return the total size of our chunks, in bytes
+		*/
+		inline std::size_t size( void ) const;
+};
+
+/**
+A standard allocator that draws from an <tt>Arena</tt>, so that containers can
+keep their contents there.  Deallocating is a no-op, as the arena reclaims
+everything at once.  An allocator without an arena falls back to the heap,
+and it's what copies start out with: a container only lands in an arena when
+it's explicitly constructed with an allocator for one, and it stays there
+(and its copies stay out) regardless of what's later assigned to it.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+template< class Type >
+class ArenaAllocator
+{
+	private:
+		/** Where to allocate from, or <tt>NULL</tt> for the heap */
+		Arena* arena;
+	
+	public:
+		/** What we allocate */
+		typedef Type value_type;
+		
+		/** Assignments keep their destination's allocator */
+		typedef std::false_type propagate_on_container_copy_assignment;
+		
+		/** Moves do too */
+		typedef std::false_type propagate_on_container_move_assignment;
+		
+		/** As do swaps */
+		typedef std::false_type propagate_on_container_swap;
+		
+		/**
+		Constructor.
+		@param source the arena to allocate from, or <tt>NULL</tt> for
+			the heap
+		*/
+		inline explicit ArenaAllocator( Arena* source=NULL );
+		
+		/**
+		Converting constructor, for the containers that allocate
+			something other than their elements.
+		@param another an allocator for another type
+		*/
+		template< class Other >
+		inline ArenaAllocator( const ArenaAllocator< Other >& another );
+		
+		/**
+		Reveals where we allocate from.
+		@return our arena, or <tt>NULL</tt> for the heap
+		*/
+		inline Arena* source( void ) const;
+		
+		/**
+		Allocates room for some objects.
+		@param count how many
+		@return the uninitialized room
+		@throws std::bad_alloc if there is no more to be had
+		*/
+		inline Type* allocate( std::size_t count );
+		
+		/**
+		Frees some room, if it came from the heap.
+		@param room what <tt>allocate</tt> gave us
+		@param count how many objects it was for
+		*/
+		inline void deallocate( Type* room, std::size_t count );
+		
+		/**
+		Chooses the allocator for a copy of a container using this
+			one.
+		@return one for the heap
+		*/
+		inline ArenaAllocator select_on_container_copy_construction(
+			void ) const;
+};
+
+/**
+Checks whether two allocators can free each other's allocations.
+@param first one allocator
+@param second another allocator
+@return whether they share an arena (or lack of one)
+*/
+template< class Type, class Other >
+inline bool operator==( const ArenaAllocator< Type >& first, const
+	ArenaAllocator< Other >& second );
+
+/**
+Checks whether two allocators can't free each other's allocations.
+@param first one allocator
+@param second another allocator
+@return whether they don't share an arena (or lack of one)
+*/
+template< class Type, class Other >
+inline bool operator!=( const ArenaAllocator< Type >& first, const
+	ArenaAllocator< Other >& second );
+
+/** @brief Bump */
+void* Arena::allocate( std::size_t bytes, std::size_t alignment )
+{
+	std::size_t skip=-reinterpret_cast< std::size_t >( cursor )&(
+		alignment-1 ); //to the next boundary
+	
+	if( cursor==NULL || skip+bytes>remaining )
+		return refill( bytes, alignment );
+	
+	void* allocation=cursor+skip;
+	
+	cursor+=skip+bytes;
+	remaining-=skip+bytes;
+	
+	return allocation;
+}
+
+/** @brief How big? */
+std::size_t Arena::size() const
+{
+	return reserved;
+}
+
+#include "Arena.t.h"
+
+#endif
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+//included from "Arena.h"
+#include <cstddef>
+#include <new>
+
+/** @brief Constructor */
+template< class Type >
+ArenaAllocator< Type >::ArenaAllocator( Arena* source ):
+	arena( source ) {}
+
+/** @brief Rebinding constructor */
+template< class Type >
+template< class Other >
+ArenaAllocator< Type >::ArenaAllocator( const ArenaAllocator< Other >&
+	another ):
+	arena( another.source() ) {}
+
+/** @brief Whence? */
+template< class Type >
+Arena* ArenaAllocator< Type >::source() const
+{
+	return arena;
+}
+
+/** @brief Get room */
+template< class Type >
+Type* ArenaAllocator< Type >::allocate( std::size_t count )
+{
+	if( arena==NULL )
+		return static_cast< Type* >( ::operator new( count*sizeof(
+			Type ) ) );
+	else
+		return static_cast< Type* >( arena->allocate( count*sizeof(
+			Type ), alignof( Type ) ) );
+}
+
+/** @brief Give back room */
+template< class Type >
+void ArenaAllocator< Type >::deallocate( Type* room, std::size_t )
+{
+	if( arena==NULL ) ::operator delete( room );
+	//else the arena will get it back all at once
+}
+
+/** @brief Copies start out on the heap */
+template< class Type >
+ArenaAllocator< Type > ArenaAllocator< Type
+	>::select_on_container_copy_construction() const
+{
+	return ArenaAllocator();
+}
+
+/** @brief Interchangeable? */
+template< class Type, class Other >
+bool operator==( const ArenaAllocator< Type >& first, const ArenaAllocator<
+	Other >& second )
+{
+	return first.source()==second.source();
+}
+
+/** @brief Not interchangeable? */
+template< class Type, class Other >
+bool operator!=( const ArenaAllocator< Type >& first, const ArenaAllocator<
+	Other >& second )
+{
+	return !( first==second );
+}
@@ -0,0 +1,403 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+#include "Cluster.h"
+#include "Encoding.h"
+#include <chrono>
+#include <fstream>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <unistd.h>
+using namespace std;
+
+/** @brief How long to keep calling */
+const int Cluster::PATIENCE;
+
+/** @brief Destructor */
+Cluster::Handler::~Handler() {}
+
+/** @brief Constructor */
+Cluster::Link::Link( int connection ):
+	socket( connection ), lock(), ready(), outbound(), urgent( false ),
+	open( true ), closing( false ), reader(), writer() {}
+
+/** @brief Constructor */
+Cluster::Cluster():
+	links( 1, static_cast< Link* >( NULL ) ), node( 0 ), handler( NULL ) {}
+
+/** @brief Destructor */
+Cluster::~Cluster()
+{
+	leave();
+}
+
+/** @brief Who's who */
+bool Cluster::list( const char* path, vector< pair< string, string > >& hosts )
+{
+	ifstream file( path );
+	string line;
+	
+	if( file.fail() ) return false;
+	
+	while( getline( file, line ) )
+	{
+		istringstream fields( line );
+		string host, port;
+		
+		if( !( fields>>host ) ) continue; //blank
+		if( !( fields>>port ) ) return false;
+		hosts.push_back( make_pair( host, port ) );
+	}
+	
+	return !hosts.empty();
+}
+
+/** @brief Call up */
+int Cluster::dial( const string& host, const string& port )
+{
+	chrono::steady_clock::time_point deadline=chrono::steady_clock::now()+
+		chrono::seconds( PATIENCE );
+	
+	do
+	{
+		struct addrinfo hints={};
+		struct addrinfo* found;
+		
+		hints.ai_family=AF_UNSPEC;
+		hints.ai_socktype=SOCK_STREAM;
+		if( getaddrinfo( host.c_str(), port.c_str(), &hints, &found )==0 )
+		{
+			for( struct addrinfo* address=found; address!=NULL;
+				address=address->ai_next )
+			{
+				int connection=::socket( address->ai_family,
+					address->ai_socktype, address->ai_protocol );
+				
+				if( connection<0 ) continue;
+				if( connect( connection, address->ai_addr,
+					address->ai_addrlen )==0 )
+				{
+					freeaddrinfo( found );
+					
+					return connection;
+				}
+				close( connection );
+			}
+			freeaddrinfo( found );
+		}
+		this_thread::sleep_for( chrono::milliseconds( 100 ) ); //it may
+			//not be listening yet
+	}
+	while( chrono::steady_clock::now()<deadline );
+	
+	return -1;
+}
+
+/** @brief Open up */
+int Cluster::listen( const string& port )
+{
+	struct addrinfo hints={};
+	struct addrinfo* found;
+	int listener=-1;
+	int yes=1;
+	
+	hints.ai_family=AF_INET6; //which also hears IPv4
+	hints.ai_socktype=SOCK_STREAM;
+	hints.ai_flags=AI_PASSIVE;
+	if( getaddrinfo( NULL, port.c_str(), &hints, &found )!=0 ) return -1;
+	
+	if( ( listener=::socket( found->ai_family, found->ai_socktype,
+		found->ai_protocol ) )>=0 )
+	{
+		setsockopt( listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes );
+		if( bind( listener, found->ai_addr, found->ai_addrlen )!=0 ||
+			::listen( listener, SOMAXCONN )!=0 )
+		{
+			close( listener );
+			listener=-1;
+		}
+	}
+	freeaddrinfo( found );
+	
+	return listener;
+}
+
+/** @brief Write it all */
+bool Cluster::deliver( int socket, const string& bytes )
+{
+	for( size_t sent=0; sent<bytes.size(); )
+	{
+		ssize_t wrote=::send( socket, bytes.data()+sent, bytes.size()-sent,
+			MSG_NOSIGNAL );
+		
+		if( wrote<=0 ) return false;
+		sent+=wrote;
+	}
+	
+	return true;
+}
+
+/** @brief Who's calling? */
+bool Cluster::greet( int connection, uint64_t& peer )
+{
+	char hello[10]; //as long as a varint gets
+	const char* cursor=hello;
+	
+	for( size_t length=0; length<sizeof hello; )
+		if( recv( connection, hello+length, 1, MSG_WAITALL )!=1 )
+			return false;
+		else if( ( hello[length++]&0x80 )==0 ) //that's the whole thing
+			return Encoding::readVarint( cursor, hello+length, peer );
+	
+	return false;
+}
+
+/** @brief Get together */
+bool Cluster::join( const char* path, unsigned int self, Handler& listener )
+{
+	vector< pair< string, string > > hosts;
+	int yes=1;
+	
+	leave();
+	if( !list( path, hosts ) || self>=hosts.size() ) return false;
+	
+	node=self;
+	handler=&listener;
+	links.assign( hosts.size(), NULL );
+	
+	int door=hosts.size()>1 ? listen( hosts[self].second ) : -1;
+	if( hosts.size()>1 && door<0 ) return false;
+	
+	//we call those before us, then answer those after us, each of whom
+	//says who it is first:
+	bool reached=true;
+	for( unsigned int peer=0; peer<self && reached; ++peer )
+	{
+		int connection=dial( hosts[peer].first, hosts[peer].second );
+		string hello;
+		
+		Encoding::appendVarint( hello, self );
+		if( connection<0 || !deliver( connection, hello ) )
+		{
+			if( connection>=0 ) close( connection );
+			reached=false;
+		}
+		else links[peer]=new Link( connection );
+	}
+	for( unsigned int answered=self+1; answered<hosts.size() && reached;
+		++answered )
+	{
+		int connection=accept( door, NULL, NULL );
+		uint64_t peer=hosts.size();
+		
+		if( connection<0 )
+		{
+			reached=false;
+			break;
+		}
+		if( !greet( connection, peer ) || peer<=self || peer>=hosts.size()
+			|| links[peer]!=NULL ) //a stranger, or an impostor
+		{
+			close( connection );
+			--answered;
+			continue;
+		}
+		links[peer]=new Link( connection );
+	}
+	if( door>=0 ) close( door );
+	
+	for( unsigned int peer=0; peer<links.size(); ++peer )
+		if( links[peer]!=NULL )
+		{
+			if( !reached ) //hang up on whoever we did reach
+			{
+				close( links[peer]->socket );
+				delete links[peer];
+				links[peer]=NULL;
+				continue;
+			}
+			
+			setsockopt( links[peer]->socket, IPPROTO_TCP, TCP_NODELAY,
+				&yes, sizeof yes ); //we do our own batching
+			links[peer]->reader=thread( &Cluster::read, this, peer );
+			links[peer]->writer=thread( &Cluster::write, this, peer );
+		}
+	if( !reached ) leave();
+	
+	return reached;
+}
+
+/** @brief Part ways */
+void Cluster::leave()
+{
+	for( unsigned int peer=0; peer<links.size(); ++peer )
+		if( links[peer]!=NULL )
+		{
+			{
+				lock_guard< mutex > guard( links[peer]->lock );
+				
+				links[peer]->closing=true;
+			}
+			links[peer]->ready.notify_one();
+		}
+	for( unsigned int peer=0; peer<links.size(); ++peer )
+		if( links[peer]!=NULL )
+		{
+			if( links[peer]->writer.joinable() )
+				links[peer]->writer.join(); //which hangs up
+			if( links[peer]->reader.joinable() )
+				links[peer]->reader.join();
+			close( links[peer]->socket );
+			delete links[peer];
+		}
+	
+	links.assign( 1, NULL );
+	node=0;
+	handler=NULL;
+}
+
+/** @brief Head count */
+unsigned int Cluster::size() const
+{
+	return links.size();
+}
+
+/** @brief Identity */
+unsigned int Cluster::self() const
+{
+	return node;
+}
+
+/** @brief Batch it */
+bool Cluster::post( unsigned int peer, char kind, const string& payload )
+{
+	Link& link=*links[peer];
+	bool full;
+	
+	{
+		lock_guard< mutex > guard( link.lock );
+		
+		if( !link.open ) return false;
+		link.outbound.push_back( kind );
+		Encoding::appendVarint( link.outbound, payload.size() );
+		link.outbound.append( payload );
+		full=link.outbound.size()>=BATCH_BYTES;
+	}
+	if( full ) link.ready.notify_one();
+	
+	return true;
+}
+
+/** @brief Send the batch */
+bool Cluster::flush( unsigned int peer )
+{
+	Link& link=*links[peer];
+	
+	{
+		lock_guard< mutex > guard( link.lock );
+		
+		if( !link.open ) return false;
+		link.urgent=true;
+	}
+	link.ready.notify_one();
+	
+	return true;
+}
+
+/** @brief Send it now */
+bool Cluster::send( unsigned int peer, char kind, const string& payload )
+{
+	return post( peer, kind, payload ) && flush( peer );
+}
+
+/** @brief Outgoing */
+void Cluster::write( unsigned int peer )
+{
+	Link& link=*links[peer];
+	unique_lock< mutex > guard( link.lock );
+	string batch;
+	
+	for( ;; )
+	{
+		while( !link.closing && ( link.outbound.empty() || ( !link.urgent &&
+			link.outbound.size()<BATCH_BYTES ) ) )
+			link.ready.wait( guard );
+		
+		bool last=link.closing;
+		
+		batch.swap( link.outbound );
+		link.urgent=false;
+		guard.unlock();
+		
+		bool delivered=deliver( link.socket, batch );
+		
+		batch.clear();
+		guard.lock();
+		if( !delivered ) link.open=false; //it's hung up on us
+		if( last ) break;
+	}
+	
+	link.open=false;
+	guard.unlock();
+	shutdown( link.socket, SHUT_WR ); //they'll hear that we've gone
+}
+
+/** @brief Incoming */
+void Cluster::read( unsigned int peer )
+{
+	Link& link=*links[peer];
+	string buffer;
+	char chunk[1<<16];
+	ssize_t got;
+	
+	while( ( got=recv( link.socket, chunk, sizeof chunk, 0 ) )>0 )
+	{
+		const char* cursor;
+		const char* end;
+		const char* message;
+		const char* after;
+		
+		buffer.append( chunk, got );
+		cursor=buffer.data();
+		end=cursor+buffer.size();
+		
+		//hand over every complete message, leaving any partial one:
+		for( const char* start=cursor; cursor<end; start=cursor )
+		{
+			char kind=*cursor++;
+			
+			if( !Encoding::readRecord( cursor, end, message, after ) )
+			{
+				cursor=start;
+				break;
+			}
+			handler->receive( peer, kind, message, after );
+			cursor=after;
+		}
+		buffer.erase( 0, cursor-buffer.data() );
+	}
+	
+	{
+		lock_guard< mutex > guard( link.lock );
+		
+		link.open=false; //in case they just crashed
+	}
+	handler->depart( peer );
+}
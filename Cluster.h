@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+A group of processes, typically on different machines, that solve a game
+together over TCP.  Every node connects to every other one, as listed in a
+hosts file with one <tt>host port</tt> line per node, whose order numbers them
+from 0.  They exchange messages, each a kind and a payload; those that are
+<tt>post()</tt>ed collect in a batch per recipient, which goes out in one write
+once it's big enough or somebody <tt>flush()</tt>es it, so that a node sharing
+many small messages never waits on the network to deliver each one.  Each
+connection has a thread of its own that reads whatever arrives on it and hands
+it to a <tt>Handler</tt>.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+class Cluster
+{
+	public:
+		/**
+		Hears from the other nodes, on the thread that reads each one's
+			connection, so that messages from one node arrive in the
+			order it sent them.
+		*/
+		class Handler
+		{
+			public:
+				/**
+				Destroys the <tt>Handler</tt>.
+				*/
+				virtual ~Handler( void );
+				
+				/**
+				Handles a message.
+				@param peer the node that sent it
+				@param kind what sort of message it is
+				@param payload where its payload starts
+				@param end just past where it ends
+				*/
+				virtual void receive( unsigned int peer, char kind,
+					const char* payload, const char* end )=0;
+				
+				/**
+				Learns that a node has gone, after the last of
+					its messages.
+				@param peer the node
+				*/
+				virtual void depart( unsigned int peer )=0;
+		};
+	
+	private:
+		/**
+		Our connection to one other node.
+		*/
+		struct Link
+		{
+			/** The socket */
+			int socket;
+			
+			/** Protects the rest */
+			std::mutex lock;
+			
+			/** Wakes up the <tt>writer</tt> */
+			std::condition_variable ready;
+			
+			/** The messages waiting to go out */
+			std::string outbound;
+			
+			/** Whether somebody wants <tt>outbound</tt> sent even
+				though it isn't big enough yet */
+			bool urgent;
+			
+			/** Whether we can still write to the socket */
+			bool open;
+			
+			/** Whether we're leaving */
+			bool closing;
+			
+			/** Reads what arrives */
+			std::thread reader;
+			
+			/** Writes what's batched, so that nobody who posts a
+				message ever waits on the network, not even a
+				<tt>Handler</tt> replying to one */
+			std::thread writer;
+			
+			/**
+			Wraps a connected socket.
+			@param connection the socket
+			*/
+			explicit Link( int connection );
+		};
+		
+		/** Each node's link, or <tt>NULL</tt> for our own */
+		std::vector< Link* > links;
+		
+		/** Our own node's number */
+		unsigned int node;
+		
+		/** Who hears from the other nodes */
+		Handler* handler;
+		
+		/**
+		Reads a hosts file.
+		@param path where it lives
+		@param hosts where to put each node's host and port
+		@return whether it was readable and every line had both
+		*/
+		static bool list( const char* path, std::vector< std::pair<
+			std::string, std::string > >& hosts );
+		
+		/**
+		Connects to another node, waiting for it to start listening.
+		@param host its host name or address
+		@param port its port
+		@return the connected socket, or <tt>-1</tt> if it never did
+		*/
+		static int dial( const std::string& host, const std::string& port
+			);
+		
+		/**
+		Starts listening for the other nodes.
+		@param port which port to listen on
+		@return the listening socket, or <tt>-1</tt> if we can't
+		*/
+		static int listen( const std::string& port );
+		
+		/**
+		Hears who has called us, as the caller says first thing.
+		@param connection the call
+		@param peer where to put the caller's number
+		@return whether the caller said
+		*/
+		static bool greet( int connection, uint64_t& peer );
+		
+		/**
+		Writes everything to a socket.
+		@param socket where to write
+		@param bytes what to write
+		@return whether it all went out
+		*/
+		static bool deliver( int socket, const std::string& bytes );
+		
+		/**
+		Sends another node its batches as they fill up or are flushed,
+			until we leave.
+		@param peer the node
+		*/
+		void write( unsigned int peer );
+		
+		/**
+		Reads messages from another node and hands them to our
+			<tt>Handler</tt> until its connection closes.
+		@param peer the node
+		*/
+		void read( unsigned int peer );
+		
+		/**
+		Copying is unsupported.
+		*/
+		Cluster( const Cluster& );
+		
+		/**
+		Assignment is unsupported.
+		*/
+		Cluster& operator=( const Cluster& );
+	
+	public:
+		/** How big a batch may get before it goes out on its own */
+		static const size_t BATCH_BYTES=1<<16;
+		
+		/** How many seconds to keep trying to reach another node */
+		static const int PATIENCE=60;
+		
+		/**
+		Creates a cluster of one, which hasn't joined any others.
+		*/
+		Cluster( void );
+		
+		/**
+		Leaves the cluster.
+		*/
+		~Cluster( void );
+		
+		/**
+		Connects to every other node in a hosts file, which must each
+			be doing the same, and starts hearing from them.
+		@param path the hosts file
+		@param self our own node's number in it
+		@param listener who hears from the others, which must outlive
+			our membership
+		@return whether every node could be reached
+		*/
+		bool join( const char* path, unsigned int self, Handler& listener
+			);
+		
+		/**
+		Sends everything still batched and disconnects from every other
+			node, which makes each of them hear us <tt>depart()</tt>,
+			then waits for each to disconnect from us in turn.
+		*/
+		void leave( void );
+		
+		/**
+		Counts the nodes.
+		@return how many there are, including ourselves
+		*/
+		unsigned int size( void ) const;
+		
+		/**
+		Tells which node we are.
+		@return our number
+		*/
+		unsigned int self( void ) const;
+		
+		/**
+		Adds a message to the batch for another node, sending the batch
+			if that makes it big enough.
+		@param peer the recipient
+		@param kind what sort of message it is
+		@param payload the message itself
+		@return whether the recipient is still connected
+		*/
+		bool post( unsigned int peer, char kind, const std::string&
+			payload );
+		
+		/**
+		Sends whatever is batched up for another node.
+		@param peer the recipient
+		@return whether the recipient is still connected
+		*/
+		bool flush( unsigned int peer );
+		
+		/**
+		Sends a message to another node right away, along with anything
+			batched before it.
+		@param peer the recipient
+		@param kind what sort of message it is
+		@param payload the message itself
+		@return whether the recipient is still connected
+		*/
+		bool send( unsigned int peer, char kind, const std::string&
+			payload );
+};
+
+#endif
@@ -17,6 +17,7 @@
 /** @author Sol Boucher <slb1566@rit.edu> */
 #include "Connect3Helper.h"
 #include "Connect3State.h"
+#include "Encoding.h"
 #include <iostream>
 #include <istream>
 #include <vector>
@@ -61,3 +62,46 @@ bool Connect3Helper::decodeBoard( istream& save, vector< vector< char > >&
 	
 	return true;
 }
+
+/** @brief Unpack bitboards */
+bool Connect3Helper::unpackBoard( const char*& cursor, const char* end,
+	unsigned int& width, unsigned int& height, Connect3State::Board
+	pieces[2] )
+{
+	typedef Connect3State::Board Board;
+	const uint64_t LARGEST=1<<16; //far past any that fits
+	uint64_t columns, elements;
+	
+	pieces[0]=pieces[1]=0;
+	if( !Encoding::readVarint( cursor, end, columns ) ||
+		!Encoding::readVarint( cursor, end, elements ) ||
+		columns>LARGEST || elements>LARGEST )
+		return false;
+	width=unsigned( columns );
+	height=unsigned( elements );
+	
+	uint64_t bytes=( columns*( elements+1 )+7 )/8;
+	if( uint64_t( end-cursor )<2*bytes ) return false;
+	if( !Connect3State::fits( width, height ) ) //skip it
+	{
+		cursor+=2*bytes;
+		
+		return true;
+	}
+	
+	Encoding::readFixed( cursor, end, pieces[0], bytes );
+	Encoding::readFixed( cursor, end, pieces[1], bytes );
+	
+	Board column=( Board( 1 )<<height )-1; //one column's cells
+	Board cells=0;
+	for( unsigned int col=0; col<width; ++col )
+	{
+		Board stack=( pieces[0]|pieces[1] )>>col*( height+1 )&column;
+		
+		if( ( stack&( stack+1 ) )!=0 ) return false; //floating
+		cells|=column<<col*( height+1 );
+	}
+	
+	return ( pieces[0]&pieces[1] )==0 && ( ( pieces[0]|pieces[1] )&~cells
+		)==0;
+}
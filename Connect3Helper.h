@@ -18,12 +18,14 @@
 #ifndef CONNECT3HELPER_H
 #define CONNECT3HELPER_H
 
+#include "Connect3State.h"
 #include <istream>
 #include <vector>
 
 /**
-Contains ONLY ONE helper method for the Connect3 main.  This is considered by
-	some theorists as a general waste of time, effort, and space.
+Contains ONLY TWO helper methods for the Connect3 main, one per way of writing
+	a board down.  This is considered by some theorists as a general waste
+	of time, effort, and space.
 
 @author Sol Boucher <slb1566@rit.edu>
 */
@@ -40,6 +42,27 @@ class Connect3Helper
 		*/
 		static bool decodeBoard( std::istream& save, std::vector<
 			std::vector< char > >& use, int& height );
+		
+		/**
+		Reads a packed board straight from memory: its width and
+			height written as varints, followed by the cells of
+			each of <tt>Connect3State::SYMBOLS</tt> in turn as a
+			bitboard in the <tt>Connect3State</tt> layout, written
+			fixed-width in as many bytes as it takes to hold
+			width*(height+1) bits.
+		@param cursor where the board starts, which is advanced past
+			it
+		@param end where the input ends
+		@param width the number of columns
+		@param height the number of elements per column
+		@param pieces the bitboards, which are left empty if the
+			board doesn't <tt>fits()</tt> this build
+		@return whether it was well formed, with every piece resting
+			on another or on the bottom
+		*/
+		static bool unpackBoard( const char*& cursor, const char* end,
+			unsigned int& width, unsigned int& height,
+			Connect3State::Board pieces[2] );
 };
 
 #endif
@@ -1,5 +1,6 @@
 /** @author Sol Boucher <slb1566@rit.edu> */
 #include "Connect3State.h"
+#include "Encoding.h"
 #include <cassert>
 #include <climits>
 #include <algorithm>
@@ -12,61 +13,243 @@ using namespace std;
 /** @brief Board symbols */
 const char Connect3State::SYMBOLS[2]={'X', 'O'};
 
+/** @brief Symmetry mode */
+bool Connect3State::symmetric=true;
+
+/** @brief Hash keys */
+const Connect3State::Keys Connect3State::KEYS;
+
+/** @brief Draw the keys */
+Connect3State::Keys::Keys()
+{
+	uint64_t state=0x853c49e6748fea9bULL; //splitmix64, from a fixed seed
+	uint64_t* destinations[2*BITS+2];
+	unsigned int count=0;
+	
+	for( unsigned int symbol=0; symbol<2; ++symbol )
+		for( unsigned int cell=0; cell<BITS; ++cell )
+			destinations[count++]=&cells[symbol][cell];
+	destinations[count++]=&ourTurn;
+	destinations[count++]=&mySymbol;
+	
+	for( unsigned int which=0; which<count; ++which )
+	{
+		uint64_t mixed=( state+=0x9e3779b97f4a7c15ULL );
+		
+		mixed=( mixed^( mixed>>30 ) )*0xbf58476d1ce4e5b9ULL;
+		mixed=( mixed^( mixed>>27 ) )*0x94d049bb133111ebULL;
+		*destinations[which]=mixed^( mixed>>31 );
+	}
+}
+
 /** @brief Constructor */
 Connect3State::Connect3State( unsigned int columnCount,
 	unsigned int elementCount,
 	const std::vector< std::vector< char > >& original, bool weAreUp ):
 	COLUMNS( columnCount ), ELEMENTS( elementCount ),
-	mySymbol( 0 ), board( original ), ourTurn( weAreUp) 
+	mySymbol( 0 ), ourTurn( weAreUp ), finalOutcome( TIE ),
+	key( weAreUp ? KEYS.ourTurn : 0 ), mirrorKey( key )
 {
-	assert( board.size()==COLUMNS );
-	for( vector< vector< char > >::iterator col=board.begin();
-		col!=board.end(); ++col )
-		assert( col->size()<=ELEMENTS );
+	assert( fits( COLUMNS, ELEMENTS ) );
+	assert( original.size()==COLUMNS );
+	
+	pieces[0]=pieces[1]=mirrored[0]=mirrored[1]=0;
+	for( unsigned int col=0; col<original.size(); ++col )
+	{
+		assert( original[col].size()<=ELEMENTS );
+		for( unsigned int el=0; el<original[col].size(); ++el )
+		{
+			int symbol=original[col][el]==SYMBOLS[1] ? 1 : 0;
+			Board cell=bottomOf( col )<<el;
+			Board image=bottomOf( COLUMNS-1-col )<<el;
+			
+			pieces[symbol]|=cell;
+			key^=KEYS.cells[symbol][indexOf( cell )];
+			mirrored[symbol]|=image;
+			mirrorKey^=KEYS.cells[symbol][indexOf( image )];
+		}
+	}
+	
+	finalOutcome=computeWinner();
+}
+
+/** @brief Bitboard constructor */
+Connect3State::Connect3State( unsigned int columnCount, unsigned int
+	elementCount, const Board original[2], bool weAreUp, int moving ):
+	COLUMNS( columnCount ), ELEMENTS( elementCount ),
+	mySymbol( moving ), ourTurn( weAreUp ), finalOutcome( TIE ),
+	key( ( weAreUp ? KEYS.ourTurn : 0 )^( moving==1 ? KEYS.mySymbol : 0 )
+		), mirrorKey( key ) //as though we'd got here by moving
+{
+	assert( fits( COLUMNS, ELEMENTS ) );
+	assert( moving==0 || moving==1 );
+	
+	for( int symbol=0; symbol<2; ++symbol )
+	{
+		pieces[symbol]=original[symbol];
+		mirrored[symbol]=0;
+		for( unsigned int col=0; col<COLUMNS; ++col )
+			mirrored[symbol]|=( pieces[symbol]&columnOf( col ) )>>col*(
+				ELEMENTS+1 )<<( COLUMNS-1-col )*( ELEMENTS+1 );
+		
+		for( Board rest=pieces[symbol]; rest!=0; rest&=rest-1 )
+			key^=KEYS.cells[symbol][indexOf( rest&( ~rest+1 ) )];
+		for( Board rest=mirrored[symbol]; rest!=0; rest&=rest-1 )
+			mirrorKey^=KEYS.cells[symbol][indexOf( rest&( ~rest+1 ) )];
+	}
+	assert( ( pieces[0]&pieces[1] )==0 );
 	
 	finalOutcome=computeWinner();
-	cacheHash();
 }
 
 /** @brief Advancing constructor */
 Connect3State::Connect3State( const Connect3State& baseState,
 	unsigned int column ):
 	COLUMNS( baseState.COLUMNS ), ELEMENTS( baseState.ELEMENTS ),
-	mySymbol( 1-baseState.mySymbol ), board( baseState.board ),
-	ourTurn ( !baseState.ourTurn )
+	mySymbol( 1-baseState.mySymbol ), ourTurn ( !baseState.ourTurn ),
+	finalOutcome( TIE ), key( baseState.key^KEYS.ourTurn^KEYS.mySymbol ),
+	mirrorKey( baseState.mirrorKey^KEYS.ourTurn^KEYS.mySymbol )
 {
-	assert( column<board.size() );
-	board[column].push_back( SYMBOLS[1-mySymbol] ); //the other player
-		//placed it!
-	assert( board[column].size()<=ELEMENTS );
+	assert( column<COLUMNS );
+	assert( baseState.hasSpaceAt( column ) );
+	
+	int placer=1-mySymbol; //the other player placed it!
+	Board cell=( ( baseState.pieces[0]|baseState.pieces[1] )+bottomOf(
+		column ) )&columnOf( column ); //carries up past the pieces
+		//already there to the lowest empty cell
 	
-	finalOutcome=computeWinner( column );
-	cacheHash();
+	Board image=( cell>>column*( ELEMENTS+1 ) )<<( COLUMNS-1-column )*(
+		ELEMENTS+1 ); //the same height in the opposite column
+	
+	pieces[0]=baseState.pieces[0];
+	pieces[1]=baseState.pieces[1];
+	pieces[placer]|=cell;
+	key^=KEYS.cells[placer][indexOf( cell )];
+	mirrored[0]=baseState.mirrored[0];
+	mirrored[1]=baseState.mirrored[1];
+	mirrored[placer]|=image;
+	mirrorKey^=KEYS.cells[placer][indexOf( image )];
+	
+	if( connections( pieces[placer] )!=0 ) //they just made a line
+		finalOutcome=ourTurn ? LOSS : VICTORY;
 }
 
 /** @brief Are we out of objects? */
 bool Connect3State::gameOver() const
 {
-	bool boardFull=true;
+	return finalOutcome!=TIE || remaining()==0; //someone has won or the
+		//board is full
+}
+
+/** @brief How much room? */
+unsigned int Connect3State::remaining() const
+{
+	Board filled=pieces[0]|pieces[1];
+	unsigned int count=__builtin_popcountll( uint64_t( filled ) );
 	
-	for( vector< vector< char > >::const_iterator column=board.begin();
-		column!=board.end(); ++column )
-		if( column->size()<ELEMENTS )
-		{
-			boardFull=false; //column not complete
-			break;
-		}
+	#ifdef CONNECT3_WIDE
+		count+=__builtin_popcountll( uint64_t( filled>>64 ) );
+	#endif
 	
-	return boardFull || finalOutcome!=TIE; //has anyone won?
+	return COLUMNS*ELEMENTS-count;
 }
 
 /** @brief What might happen next? */
-void Connect3State::successors( vector< Connect3State >& possibilities ) const
+void Connect3State::successors( MoveBuffer< Connect3State >& possibilities )
+	const
 {
-	for( unsigned int column=0; column<board.size(); ++column )
-		if( board[column].size()<ELEMENTS )
+	bool reversed=symmetric && !canonical(); //follow our mirror image's
+		//column order instead
+	
+	for( unsigned int index=0; index<COLUMNS; ++index )
+	{
+		unsigned int column=reversed ? COLUMNS-1-index : index;
+		
+		if( hasSpaceAt( column ) )
 			possibilities.push_back( Connect3State( *this, column
 				) );
+	}
+}
+
+/** @brief Middle out */
+void Connect3State::orderedSuccessors( vector< unsigned int >& order ) const
+{
+	bool reversed=symmetric && !canonical();
+	unsigned int middle=( COLUMNS-1 )/2;
+	vector< unsigned int > slot( COLUMNS, COLUMNS ); //successor index, by
+		//column in the order successors() lists them
+	unsigned int playable=0;
+	
+	for( unsigned int index=0; index<COLUMNS; ++index )
+		if( hasSpaceAt( reversed ? COLUMNS-1-index : index ) )
+			slot[index]=playable++;
+	
+	//work from the middle outward, where lines are most likely to be made:
+	for( unsigned int index=0; index<COLUMNS; ++index )
+	{
+		unsigned int column=index%2==1 ? middle+( index+1 )/2 :
+			middle-index/2;
+		
+		if( slot[column]<COLUMNS ) order.push_back( slot[column] );
+	}
+}
+
+/** @brief Open lines */
+int Connect3State::evaluate() const
+{
+	int computer=ourTurn ? mySymbol : 1-mySymbol;
+	Board cells=0;
+	
+	for( unsigned int column=0; column<COLUMNS; ++column )
+		cells|=columnOf( column )^bottomOf( column )<<ELEMENTS; //but
+			//not the sentinel
+	
+	Board open=cells&~( pieces[0]|pieces[1] );
+	Board ours=threats( pieces[computer] )&open;
+	Board theirs=threats( pieces[1-computer] )&open;
+	int balance=__builtin_popcountll( uint64_t( ours ) )-
+		__builtin_popcountll( uint64_t( theirs ) );
+	
+	#ifdef CONNECT3_WIDE
+		balance+=__builtin_popcountll( uint64_t( ours>>64 ) )-
+			__builtin_popcountll( uint64_t( theirs>>64 ) );
+	#endif
+	
+	return balance;
+}
+
+/** @brief Winning moves */
+int Connect3State::winningSuccessor() const
+{
+	Board cells=0;
+	Board bottoms=0;
+	
+	if( finalOutcome!=TIE ) return -1; //it's too late
+	
+	for( unsigned int column=0; column<COLUMNS; ++column )
+	{
+		cells|=columnOf( column )^bottomOf( column )<<ELEMENTS;
+		bottoms|=bottomOf( column );
+	}
+	
+	Board landings=( ( pieces[0]|pieces[1] )+bottoms )&cells; //carries up
+		//each column to its lowest empty cell, or a full one's sentinel
+	Board wins=threats( pieces[mySymbol] )&landings;
+	
+	if( wins==0 ) return -1;
+	
+	bool reversed=symmetric && !canonical(); //as successors() lists them
+	int index=0;
+	
+	for( unsigned int listed=0; listed<COLUMNS; ++listed )
+	{
+		Board column=columnOf( reversed ? COLUMNS-1-listed : listed );
+		
+		if( ( wins&column )!=0 ) return index;
+		if( ( landings&column )!=0 ) ++index;
+	}
+	
+	return -1;
 }
 
 /** @brief Textualizes */
@@ -80,11 +263,14 @@ string Connect3State::str() const
 	for( int el=ELEMENTS-1; el>=0; --el )
 	{
 		assembler<<PRINTVBAR;
-		for( vector< vector< char > >::const_iterator
-			col=board.begin(); col!=board.end(); ++col )
+		for( unsigned int col=0; col<COLUMNS; ++col )
 		{
-			if( unsigned( el )<col->size() )
-				assembler<<(*col)[el];
+			Board cell=bottomOf( col )<<el;
+			
+			if( pieces[0]&cell )
+				assembler<<SYMBOLS[0];
+			else if( pieces[1]&cell )
+				assembler<<SYMBOLS[1];
 			else
 				assembler<<PRINTHOLDER;
 			assembler<<PRINTVBAR;
@@ -103,24 +289,59 @@ string Connect3State::str() const
 	return assembler.str();
 }
 
-/** @brief Same state? */
-bool Connect3State::operator==( const Connect3State& another ) const
+/** @brief Which board? */
+string Connect3State::variant() const
+{
+	stringstream assembler;
+	
+	assembler<<"connect3 "<<COLUMNS<<'x'<<ELEMENTS<<( symmetric ?
+		" mirrored" : "" ); //mirror images' moves are only comparable
+		//if they're listed in mirrored order
+	
+	return assembler.str();
+}
+
+/** @brief Serializes */
+void Connect3State::encode( string& bytes ) const
+{
+	const Board* board=symmetric && !canonical() ? mirrored : pieces;
+	unsigned int width=( COLUMNS*( ELEMENTS+1 )+7 )/8; //bytes per board
+	
+	bytes.push_back( char( mySymbol<<1|( ourTurn ? 1 : 0 ) ) );
+	Encoding::appendFixed( bytes, board[0], width );
+	Encoding::appendFixed( bytes, board[1], width );
+}
+
+/** @brief Deserializes */
+bool Connect3State::decode( const string& bytes )
 {
-	if( this->hash()!=another.hash() ) return false;
+	unsigned int width=( COLUMNS*( ELEMENTS+1 )+7 )/8;
+	const char* cursor=bytes.data();
+	const char* end=cursor+bytes.size();
+	Board board[2];
+	Board cells=0;
+	
+	if( bytes.size()!=1+2*width ) return false;
 	
-	if( this->mySymbol!=another.mySymbol ||
-		this->COLUMNS!=another.COLUMNS ||
-		this->ELEMENTS!=another.ELEMENTS ||
-		this->ourTurn!=another.ourTurn ||
-		this->board.size()!=another.board.size() )
+	unsigned char turn=static_cast< unsigned char >( *cursor++ );
+	
+	if( turn>3 || !Encoding::readFixed( cursor, end, board[0], width ) ||
+		!Encoding::readFixed( cursor, end, board[1], width ) )
 		return false;
 	
-	for( unsigned int group=0; group<COLUMNS; ++group )
-		if( this->board[group].size()!=another.board[group].size() ||
-			!equal( this->board[group].begin(),
-			this->board[group].end(),
-			another.board[group].begin() ) )
-			return false;
+	for( unsigned int column=0; column<COLUMNS; ++column )
+		cells|=columnOf( column )^bottomOf( column )<<ELEMENTS;
+	if( ( board[0]&board[1] )!=0 || ( ( board[0]|board[1] )&~cells )!=0 )
+		return false; //a cell held twice, or one off the board
+	for( unsigned int column=0; column<COLUMNS; ++column )
+	{
+		Board stack=( ( board[0]|board[1] )&columnOf( column ) )>>column*(
+			ELEMENTS+1 );
+		
+		if( ( stack&( stack+1 ) )!=0 ) return false; //something floats
+	}
+	
+	*this=Connect3State( COLUMNS, ELEMENTS, board, ( turn&1 )!=0, turn>>1 );
 	
 	return true;
 }
@@ -134,10 +355,14 @@ Connect3State& Connect3State::operator=( const Connect3State& another )
 	if( this!=&another ) //don't copy over ourself
 	{
 		this->mySymbol=another.mySymbol;
-		this->board=another.board;
+		this->pieces[0]=another.pieces[0];
+		this->pieces[1]=another.pieces[1];
+		this->mirrored[0]=another.mirrored[0];
+		this->mirrored[1]=another.mirrored[1];
 		this->ourTurn=another.ourTurn;
 		this->finalOutcome=another.finalOutcome;
-		this->hashCode=another.hashCode;
+		this->key=another.key;
+		this->mirrorKey=another.mirrorKey;
 	}
 	
 	return *this;
@@ -148,19 +373,20 @@ bool Connect3State::areSubsequent( const Connect3State& first,
 	const Connect3State& next )
 {
 	if( first.mySymbol==next.mySymbol || first.COLUMNS!=next.COLUMNS ||
-		first.ELEMENTS!=next.ELEMENTS || first.ourTurn==next.ourTurn
-		|| first.board.size()!=next.board.size() )
+		first.ELEMENTS!=next.ELEMENTS || first.ourTurn==next.ourTurn )
 		return false;
 	
 	bool seenDifference=false;
 	for( unsigned int group=0; group<first.COLUMNS; ++group )
 	{
-		if( first.board[group]>next.board[group] ||
-			!equal( first.board[group].begin(),
-			first.board[group].end(),
-			next.board[group].begin() ) )
+		Board column=first.columnOf( group );
+		Board before=( first.pieces[0]|first.pieces[1] )&column;
+		Board after=( next.pieces[0]|next.pieces[1] )&column;
+		
+		if( ( before&~after )!=0 || ( ( first.pieces[0]^next.pieces[0]
+			)&before )!=0 ) //the old column isn't a prefix
 			return false;
-		else if( first.board[group]<next.board[group] )
+		else if( before!=after )
 		{
 			if( !seenDifference ) seenDifference=true;
 			else return false; //more than one move was taken
@@ -179,119 +405,103 @@ int Connect3State::diff( const Connect3State& first, const
 	
 	assert( subsequentStates );
 	for( unsigned int group=0; group<first.COLUMNS; ++group )
-		if( first.board[group].size()!=next.board[group].size() )
+	{
+		Board column=first.columnOf( group );
+		
+		if( ( ( first.pieces[0]|first.pieces[1] )&column )!=( (
+			next.pieces[0]|next.pieces[1] )&column ) )
 			return group;
+	}
 	
 	assert( true ); //shouldn't have gotten here!
 	return -1;
 }
 
-/** @brief Sorting */
-void Connect3State::cacheHash()
+/** @brief Lines */
+Connect3State::Board Connect3State::connections( Board player ) const
 {
-	hashCode=( ourTurn ? 1 : 0 )<<COLUMNS*ELEMENTS;
-	for( vector< vector< char > >::iterator col=board.begin();
-		col!=board.end(); ++col )
-		for( vector< char >::iterator el=col->begin(); el!=col->end();
-			++el )
-			hashCode+=( *el )<<( ELEMENTS*( col-board.begin() )
-				+( el-col->begin() ) );
-	hashCode=abs( hashCode );
-	assert( hashCode>=0 );
+	const unsigned int stride=ELEMENTS+1; //from a cell to its neighbor
+		//in the next column
+	const unsigned int directions[]={ 1, stride, stride+1, stride-1 };
+		//up, across, and both diagonals
+	Board lines=0;
+	
+	for( unsigned int direction=0; direction<sizeof directions/sizeof
+		*directions; ++direction )
+	{
+		unsigned int step=directions[direction];
+		Board starts=player; //cells at which a line begins
+		
+		for( int advance=1; advance<CONNECTABLE; ++advance )
+			starts&=player>>advance*step;
+		for( int advance=0; advance<CONNECTABLE; ++advance )
+			lines|=starts<<advance*step;
+	}
+	
+	return lines;
 }
 
-/** @brief Compute winner */
-Connect3State::Score Connect3State::computeWinner( int baseCol, int baseEl )
+/** @brief Almost lines */
+Connect3State::Board Connect3State::threats( Board player ) const
 {
-	if( baseCol!=-1 ) //only check things related to the move that was
-		//just made
+	const unsigned int stride=ELEMENTS+1;
+	const unsigned int directions[]={ 1, stride, stride+1, stride-1 };
+	Board cells=0;
+	
+	for( unsigned int direction=0; direction<sizeof directions/sizeof
+		*directions; ++direction )
 	{
-		if( baseEl==-1 ) baseEl=board[baseCol].size()-1;
-		char match=board[baseCol][baseEl];
+		unsigned int step=directions[direction];
 		
-		for( int deltaCol=-1; deltaCol<=1; ++deltaCol )
-			for( int deltaEl=-1; deltaEl<=1; ++deltaEl )
-				if( deltaCol!=0 || deltaEl!=0 )
-					{
-						int inARow=0;
-						for( int advance=
-							-CONNECTABLE+1;
-							advance<CONNECTABLE;
-							++advance )
-						{
-							int colIndex=baseCol+
-								deltaCol*
-								advance;
-							int elIndex=baseEl+
-								deltaEl*
-								advance;
-							
-							#ifdef DEBUG
-								cout<<'('
-								<<colIndex
-								<<','<<elIndex
-								<<')'<<endl;
-							#endif
-							
-							++inARow;
-							
-							if( colIndex<0 ||
-								unsigned(
-								colIndex )>=
-								board.size()
-								|| elIndex<0
-								|| unsigned(
-								elIndex )>=
-								board[colIndex
-								].size() ||
-								board[colIndex
-								][elIndex]!=
-								match )
-								inARow=0;
-								//here's a
-								//discontinui
-								//ty
-							else if( inARow==
-								CONNECTABLE )
-								//&& board
-								//[colIndex]
-								//[elIndex]==
-								//match
-							{
-								if( ourTurn ^
-									(match
-									!=
-									SYMBOLS
-									[
-									mySymbol
-									]) )
-									return
-									VICTORY
-									;
-								else
-									return
-									LOSS;
-							}
-							//else we need more
-								//matches to
-								//make
-								//CONNECTABLE
-								//of them
-						}
-					}
+		for( int gap=0; gap<CONNECTABLE; ++gap ) //where the line's
+			//missing piece goes
+		{
+			Board missing=~Board( 0 );
+			
+			for( int place=0; place<CONNECTABLE; ++place )
+				if( place>gap )
+					missing&=player>>( place-gap )*step;
+				else if( place<gap )
+					missing&=player<<( gap-place )*step;
+			cells|=missing;
+		}
 	}
-	else //check the entire board
-		for( unsigned int col=0; col<board.size(); ++col )
-			for( unsigned int el=0; el<board[col].size(); ++el )
-			{
-				#ifdef DEBUG
-					cout<<'<'<<col<<','<<el<<'>'<<endl;
-				#endif
-				
-				const Score& result=computeWinner( col, el );
-				
-				if( result!=TIE ) return result;
-			}
-	
-	return TIE;
+	
+	return cells;
+}
+
+/** @brief Find a cell */
+unsigned int Connect3State::indexOf( Board cell )
+{
+	assert( cell!=0 && ( cell&( cell-1 ) )==0 );
+	
+	#ifdef CONNECT3_WIDE
+		if( uint64_t( cell )==0 )
+			return 64+__builtin_ctzll( uint64_t( cell>>64 ) );
+	#endif
+	
+	return __builtin_ctzll( uint64_t( cell ) );
+}
+
+/** @brief Compute winner */
+Connect3State::Score Connect3State::computeWinner() const
+{
+	Board lines[2]={ connections( pieces[0] ), connections( pieces[1] ) };
+	Board either=lines[0]|lines[1];
+	
+	if( either==0 ) return TIE;
+	
+	Board lowest=either&( ~either+1 ); //its lowest cell
+	int match=( lines[0]&lowest )!=0 ? 0 : 1;
+	
+	#ifdef DEBUG
+		cout<<"Line of "<<SYMBOLS[match]<<" through <"<<indexOf(
+			lowest )/( ELEMENTS+1 )<<','<<indexOf( lowest)%(
+			ELEMENTS+1 )<<'>'<<endl;
+	#endif
+	
+	if( ourTurn ^ ( match!=mySymbol ) )
+		return VICTORY;
+	else
+		return LOSS;
 }
@@ -17,12 +17,19 @@
 #ifndef CONNECT3STATE_H
 #define CONNECT3STATE_H
 
+#include "MoveBuffer.h"
 #include <cassert>
+#include <stdint.h>
 #include <string>
 #include <vector>
 
 /**
-Represents the Connect-3 game state at some fixed point in time.
+Represents the Connect-3 game state at some fixed point in time.  Each
+player's pieces are kept as a bitboard, one bit per cell: column <i>c</i>,
+element <i>e</i> lives at bit <i>c</i>(<tt>ELEMENTS</tt>+1)+<i>e</i>, so every
+column has an always-empty sentinel bit above its top that keeps lines from
+wrapping into the next column.  A board must fit in <tt>Board</tt>, which is 64
+bits, or 128 if built with <tt>CONNECT3_WIDE</tt> defined.
 
 @author Sol Boucher <slb1566@rit.edu>
 */
@@ -47,6 +54,11 @@ class Connect3State
 		/** The character running along the bottom of the printout */
 		static const char PRINTFOOTER='-';
 		
+		/** Whether a board and its left-right mirror image are treated
+			as the same position, which they are for the purposes of
+			play; on unless turned off before the first move */
+		static bool symmetric;
+		
 		/** The major size */
 		const unsigned int COLUMNS;
 		
@@ -62,12 +74,52 @@ class Connect3State
 			VICTORY=1
 		};
 	
+	public: //types
+		/** A set of cells */
+		#ifdef CONNECT3_WIDE
+			typedef unsigned __int128 Board;
+		#else
+			typedef uint64_t Board;
+		#endif
+	
+	private: //types
+		/** How many cells a <tt>Board</tt> can hold */
+		static const unsigned int BITS=8*sizeof( Board );
+		
+		/**
+		The random numbers that make up hash keys: one for each
+			symbol in each cell, plus some for the turn.
+		*/
+		struct Keys
+		{
+			/** Whose symbol goes with each cell */
+			uint64_t cells[2][BITS];
+			
+			/** Whether the computer player is up */
+			uint64_t ourTurn;
+			
+			/** Whose symbol is up */
+			uint64_t mySymbol;
+			
+			/**
+			Draws the numbers from a fixed seed, so every run gets
+				the same ones.
+			*/
+			Keys( void );
+		};
+		
+		/** Our hash keys */
+		static const Keys KEYS;
+	
 	private: //state
 		/** The index of my symbol in <tt>SYMBOLS</tt> */
 		int mySymbol;
 		
-		/** Stores one pin count per group of pins */
-		std::vector< std::vector< char > > board;
+		/** Where each of <tt>SYMBOLS</tt> has been placed */
+		Board pieces[2];
+		
+		/** The same, on the board's mirror image */
+		Board mirrored[2];
 		
 		/** Whether the computer player is up */
 		bool ourTurn;
@@ -75,8 +127,11 @@ class Connect3State
 		/** The victor of this particular round. */
 		Score finalOutcome;
 		
-		/** Caches the current hash code */
-		int hashCode;
+		/** The current Zobrist key, from which the hash code comes */
+		uint64_t key;
+		
+		/** The Zobrist key of the board's mirror image */
+		uint64_t mirrorKey;
 	
 	public: //behavior
 		/**
@@ -95,6 +150,24 @@ class Connect3State
 				original=std::vector< std::vector< char > >(),
 			bool weAreUp=true );
 		
+		/**
+		Creates a new game from its players' bitboards, as they're
+			packed, without going through a board of characters.
+		@pre <tt>original</tt> holds the cells of each of
+			<tt>SYMBOLS</tt> in turn, laid out as described above,
+			with no cell in both, none outside the board, and none
+			above an empty one
+		@param columnCount how many columns per board
+		@param elementCount how many elements per column
+		@param original the starting board state
+		@param weAreUp whether or not the "good guy" is up
+		@param moving the index of the symbol that's up in
+			<tt>SYMBOLS</tt>
+		*/
+		Connect3State( unsigned int columnCount, unsigned int
+			elementCount, const Board original[2], bool weAreUp=true,
+			int moving=0 );
+		
 		/**
 		Creates the move resulting from marking the top of the specifi
 			fied column of the board.
@@ -117,6 +190,12 @@ class Connect3State
 		*/
 		bool gameOver( void ) const;
 		
+		/**
+		Counts the empty cells, one of which every move fills.
+		@return how many there are
+		*/
+		unsigned int remaining( void ) const;
+		
 		/**
 		Devines the match score, which is only meaningful if the game 
 			is over.
@@ -142,10 +221,42 @@ class Connect3State
 		inline bool hasSpaceAt( unsigned int column ) const;
 		
 		/**
-		Returns all possible successor states.
+		Returns all possible successor states, from left to right.
+			When we're <tt>symmetric</tt>, this is done in the
+			canonical orientation, so a board and its mirror image
+			list corresponding moves in the same order.
 		@return whatever might happen next
 		*/
-		void successors( std::vector< Connect3State >& result ) const;
+		void successors( MoveBuffer< Connect3State >& result ) const;
+		
+		/**
+		Suggests the order in which to try our successors: from the
+			middle column outward, where lines are most likely to be
+			made.  Like <tt>successors</tt>, it treats mirror images
+			alike.
+		@param order the (initially empty) destination for indices
+			into <tt>successors</tt>'s result, best guess first
+		*/
+		void orderedSuccessors( std::vector< unsigned int >& order )
+			const;
+		
+		/**
+		Guesses how an unfinished game will turn out by counting open
+			threats: the empty cells that would complete a line for
+			one player or the other.
+		@return the computer's threats less the human's
+		*/
+		int evaluate( void ) const;
+		
+		/**
+		Looks for a move that completes a line for whoever's moving,
+			by matching the cells where their next pieces would
+			land in every column at once against those that would
+			complete their lines.
+		@return the index of that move among our
+			<tt>successors</tt>, or <tt>-1</tt> if there isn't one
+		*/
+		int winningSuccessor( void ) const;
 		
 		/**
 		Produces a synopsis of this <tt>State</tt>'s particulars.
@@ -153,6 +264,30 @@ class Connect3State
 		*/
 		std::string str( void ) const;
 		
+		/**
+		Names the variant of the game this <tt>State</tt> belongs
+			to, which decides which others it can be compared with.
+		@return the name, including any parameters of the rules
+		*/
+		std::string variant( void ) const;
+		
+		/**
+		Identifies this <tt>State</tt> among the others of its
+			<tt>variant()</tt>.
+		@param bytes where to append a byte string that equal
+			<tt>State</tt>s, and they alone, share
+		*/
+		void encode( std::string& bytes ) const;
+		
+		/**
+		Becomes the <tt>State</tt> of our <tt>variant()</tt> that
+			<tt>encode()</tt>d some bytes, which may be the mirror
+			image of the one that did.
+		@param bytes the encoding
+		@return whether it was one, without which we're unchanged
+		*/
+		bool decode( const std::string& bytes );
+		
 		/**
 		Hashes the <tt>State</tt>.
 		@pre <tt>hashCode</tt> is up to date
@@ -163,11 +298,12 @@ class Connect3State
 		
 		/**
 		Checks identity.
-		@pre <tt>sorted</tt> is up to date
 		@param another comparable <tt>State</tt>
-		@return whether the turns and pin groups are the same
+		@return whether the turns and boards are the same, or when
+			we're <tt>symmetric</tt>, whether one board is the mirror
+			image of the other
 		*/
-		bool operator==( const Connect3State& another ) const;
+		inline bool operator==( const Connect3State& another ) const;
 		
 		/**
 		Performs assignment.
@@ -196,6 +332,15 @@ class Connect3State
 		static int diff( const Connect3State& first,
 			const Connect3State& next );
 	
+		/**
+		Checks whether a board of the given size can be represented.
+		@param columnCount how many columns per board
+		@param elementCount how many elements per column
+		@return whether it fits
+		*/
+		inline static bool fits( unsigned int columnCount, unsigned int
+			elementCount );
+		
 		/**
 		Determines whether the given character is a valid board
 			marking.
@@ -207,26 +352,61 @@ class Connect3State
 	
 	private: //helpers
 		/**
-		Recomputes hash code; must be called every time <tt>pins</tt>
-		is mutated.
+		Finds the cells belonging to a column.
+		@param column the column in question
+		@return all of that column's cells, including the sentinel
 		*/
-		void cacheHash( void );
+		inline Board columnOf( unsigned int column ) const;
 		
 		/**
-		Recomputes the game's winner; must be called after mutation.
-		It only checks the entire board if <tt>baseCol</tt> isn't
-		supplied.
-		Otherwise, only combinations including <tt>baseCol</tt> are
-		considered.
-		@pre <tt>baseCol</tt>, if supplied, is positive and in range
-		@pre <tt>baseEl</tt> should normally be omitted, but must be
-			in range
-		@param baseCol the column that was just modified
-		@param baseEl the corresponding element of that column
+		Finds the bottom cell of a column.
+		@param column the column in question
+		@return that cell
+		*/
+		inline Board bottomOf( unsigned int column ) const;
+		
+		/**
+		Checks whether this is the lesser of the board and its mirror
+			image, which is the one whose column order we follow.
+		@return whether the board is in its canonical orientation
+		*/
+		inline bool canonical( void ) const;
+		
+		/**
+		Finds the cells that are part of a line of <tt>CONNECTABLE</tt>
+			pieces, in any direction.
+		@param player whose pieces to consider
+		@return the cells belonging to any such line
+		*/
+		Board connections( Board player ) const;
+		
+		/**
+		Finds the cells that would complete a line of
+			<tt>CONNECTABLE</tt> pieces, in any direction, if they
+			held one more.
+		@param player whose pieces to consider
+		@return the cells, whether empty or not, which may include
+			some beyond the board
+		*/
+		Board threats( Board player ) const;
+		
+		/**
+		Finds the position of a cell.
+		@pre <tt>cell</tt> contains exactly one cell
+		@param cell the cell in question
+		@return its bit index
+		*/
+		static unsigned int indexOf( Board cell );
+		
+		/**
+		Recomputes the game's winner from scratch; must be called after
+			building a board by hand.  If both players have lines, the
+			one owning the lowest cell, counting up each column in
+			turn, is the winner.
 		@return a score, with <tt>TIE</tt> representing a nonterminal
 			state
 		*/
-		Score computeWinner( int baseCol=-1, int baseEl=-1 );
+		Score computeWinner( void ) const;
 };
 
 /** @brief Destructor */
@@ -249,13 +429,57 @@ bool Connect3State::hasSpaceAt( unsigned int column ) const
 {
 	assert( column<COLUMNS );
 	
-	return board[column].size()<ELEMENTS; //room to grow
+	return ELEMENTS>0 && ( ( pieces[0]|pieces[1] )&( bottomOf( column )<<(
+		ELEMENTS-1 ) ) )==0; //room to grow
 }
 
 /** @brief Hashing */
 int Connect3State::hash() const
 {
-	return hashCode;
+	uint64_t code=symmetric && mirrorKey<key ? mirrorKey : key;
+	
+	return int( code>>33 ); //the high bits, which no sign bit can spoil
+}
+
+/** @brief Big enough? */
+bool Connect3State::fits( unsigned int columnCount, unsigned int
+	elementCount )
+{
+	return columnCount*( elementCount+1 )<=BITS;
+}
+
+/** @brief Which column? */
+Connect3State::Board Connect3State::columnOf( unsigned int column ) const
+{
+	return ~Board( 0 )>>( BITS-ELEMENTS-1 )<<column*( ELEMENTS+1 );
+}
+
+/** @brief Which cell? */
+Connect3State::Board Connect3State::bottomOf( unsigned int column ) const
+{
+	return Board( 1 )<<column*( ELEMENTS+1 );
+}
+
+/** @brief Same state? */
+bool Connect3State::operator==( const Connect3State& another ) const
+{
+	return ( ( this->key==another.key && //almost certainly settles it
+		this->pieces[0]==another.pieces[0] &&
+		this->pieces[1]==another.pieces[1] ) || ( symmetric &&
+		this->key==another.mirrorKey &&
+		this->pieces[0]==another.mirrored[0] &&
+		this->pieces[1]==another.mirrored[1] ) ) &&
+		this->mySymbol==another.mySymbol &&
+		this->ourTurn==another.ourTurn &&
+		this->COLUMNS==another.COLUMNS &&
+		this->ELEMENTS==another.ELEMENTS;
+}
+
+/** @brief Which way around? */
+bool Connect3State::canonical() const
+{
+	return pieces[0]<mirrored[0] || ( pieces[0]==mirrored[0] &&
+		pieces[1]<=mirrored[1] );
 }
 
 /** @brief Board-building check */
@@ -1,5 +1,6 @@
 /** @author Sol Boucher <slb1566@rit.edu> */
 #include "CrossoutState.h"
+#include "Encoding.h"
 #include <cassert>
 #include <algorithm>
 #include <iostream>
@@ -9,63 +10,51 @@ using namespace std;
 
 /** @brief Constructor */
 CrossoutState::CrossoutState( int greedyDivide, int highValue, bool weAreUp ):
-	MAX_SUM( greedyDivide ), tray(), ourTurn( weAreUp )
+	MAX_SUM( greedyDivide ), highest( highValue ), tray( 0 ),
+	ourTurn( weAreUp ), pairs( 0 ), loners( 0 ), canonical( 0 ),
+	hashCode( 0 )
 {
-	for( int index=0; index<highValue; ++index )
-		tray.push_back( true );
+	assert( fits( greedyDivide, highValue ) );
 	
+	tray=upTo( min( MAX_SUM, highest ) ); //the others are just for show
 	cacheHash();
 }
 
 /** @brief Advancing constructor */
 CrossoutState::CrossoutState( const CrossoutState& baseState,
 	int firstTheft, int secondTheft ):
-	MAX_SUM( baseState.MAX_SUM ), tray( baseState.tray ),
-	ourTurn( !baseState.ourTurn ), hashCode( 0 )
+	MAX_SUM( baseState.MAX_SUM ), highest( baseState.highest ), tray( 0 ),
+	ourTurn( !baseState.ourTurn ), pairs( 0 ), loners( 0 ),
+	canonical( 0 ), hashCode( 0 )
 {
-	--firstTheft; //switch to 0-based indexing
-	--secondTheft; //likewise
-	assert( firstTheft>=0 && unsigned( firstTheft )<tray.size() );
-	assert( secondTheft<signed( tray.size() ) );
-	
-	tray[firstTheft]=false;
-	
-	if( secondTheft>-1 )
-		tray[secondTheft]=false;
-	
-	cacheHash();
-}
-
-/** @brief Are we out of objects? */
-bool CrossoutState::gameOver() const
-{
-	for( unsigned int location=1; location<=tray.size() &&
-		location<=MAX_SUM; ++location )
-		if( tray[location-1] ) return false;
-	
-	return true;
+	advance( baseState, firstTheft, secondTheft );
 }
 
 /** @brief What might happen next? */
-void CrossoutState::successors( vector< CrossoutState >& possibilities ) const
+void CrossoutState::successors( MoveBuffer< CrossoutState >& possibilities )
+	const
 {
 	#ifdef DEBUG
 		cout<<"Success calculating successors for "<<str()<<'\n';
 	#endif
 	
-	for( unsigned int first=1; first<=tray.size() && first<=MAX_SUM;
-		++first )
-		if( tray[first-1] )
-		{
-			possibilities.push_back( CrossoutState( *this, first
-				) );
-			assert( possibilities.size() );
-			for( unsigned int second=first+1; second<=tray.size()
-				&& first+second<=MAX_SUM; ++second )
-				if( tray[second-1] ) possibilities.push_back(
-					CrossoutState( *this, first, second )
-						);
-		}
+	//the numbers that can still be paired, alone and in pairs:
+	for( Tray firsts=pairs; firsts!=0; firsts&=firsts-1 )
+	{
+		unsigned int first=lowestOf( firsts );
+		
+		possibilities.reuse( *this ).advance( *this, first );
+		for( Tray seconds=tray&~upTo( first )&upTo( MAX_SUM-first );
+			seconds!=0; seconds&=seconds-1 )
+			possibilities.reuse( *this ).advance( *this, first,
+				lowestOf( seconds ) );
+	}
+	
+	//then the loners, which all lead to equal positions, so that equal
+	//positions list equal successors in the same order:
+	for( Tray singles=tray&~pairs; singles!=0; singles&=singles-1 )
+		possibilities.reuse( *this ).advance( *this, lowestOf( singles
+			) );
 }
 
 /** @brief Textualizes */
@@ -75,15 +64,25 @@ string CrossoutState::str() const
 	
 	assembler<<"It is the "<<( ourTurn ? "computer" : "human" )<<
 		"'s turn and the pins are: ";
-	for( vector< bool >::const_iterator num=tray.begin();
-		num<tray.end(); ++num )
-		if( *num )
-			assembler<<( num-tray.begin()+1 )<<' ';
+	for( unsigned int num=1; num<=highest; ++num )
+		if( num>MAX_SUM || ( tray&Tray( 1 )<<( num-1 ) )!=0 )
+			assembler<<num<<' ';
 	assembler.flush();
 	
 	return assembler.str();
 }
 
+/** @brief Which rules? */
+string CrossoutState::variant() const
+{
+	stringstream assembler;
+	
+	assembler<<"crossout "<<MAX_SUM; //positions with any highest number
+		//can be compared
+	
+	return assembler.str();
+}
+
 /** @brief Assignment */
 CrossoutState& CrossoutState::operator=( const CrossoutState& another )
 {
@@ -91,8 +90,12 @@ CrossoutState& CrossoutState::operator=( const CrossoutState& another )
 	
 	if( this!=&another ) //no funny business
 	{
+		this->highest=another.highest;
 		this->tray=another.tray;
 		this->ourTurn=another.ourTurn;
+		this->pairs=another.pairs;
+		this->loners=another.loners;
+		this->canonical=another.canonical;
 		this->hashCode=another.hashCode;
 	}
 	
@@ -104,21 +107,16 @@ bool CrossoutState::areSubsequent( const CrossoutState& first, const
 	CrossoutState& next )
 {
 	if( first.MAX_SUM!=next.MAX_SUM ||
-		first.tray.size()!=next.tray.size() ||
-		first.ourTurn==next.ourTurn )
+		first.highest!=next.highest ||
+		first.ourTurn==next.ourTurn ||
+		( next.tray&~first.tray )!=0 ) //UNcrossed something!
 		return false;
 	
 	unsigned int count=0, sum=0;
-	for( unsigned int num=0; num<first.tray.size(); ++num )
+	for( Tray taken=first.tray&~next.tray; taken!=0; taken&=taken-1 )
 	{
-		if( next.tray[num] && !first.tray[num] ) //UNcrossed
-			//something!
-			return false;
-		else if( first.tray[num] && !next.tray[num] )
-		{
-			++count;
-			sum+=num+1;
-		}
+		++count;
+		sum+=lowestOf( taken );
 	}
 	
 	return count>=MIN_TAKEN && count<=MAX_TAKEN && sum<=first.MAX_SUM;
@@ -132,20 +130,62 @@ vector< int > CrossoutState::diff( const CrossoutState& first, const
 	
 	assert( subsequentStates );
 	vector< int > diffs;
-	for( unsigned int num=0; num<first.tray.size(); ++num )
-		if( first.tray[num]!=next.tray[num] )
-			diffs.push_back( num+1 );
+	for( Tray taken=first.tray^next.tray; taken!=0; taken&=taken-1 )
+		diffs.push_back( lowestOf( taken ) );
 	
 	return diffs;
 }
 
+/** @brief Cross some out */
+void CrossoutState::advance( const CrossoutState& baseState, int firstTheft,
+	int secondTheft )
+{
+	assert( this!=&baseState );
+	assert( this->MAX_SUM==baseState.MAX_SUM );
+	assert( firstTheft>0 && unsigned( firstTheft )<=min( MAX_SUM,
+		baseState.highest ) );
+	assert( secondTheft>=0 && unsigned( secondTheft )<=min( MAX_SUM,
+		baseState.highest ) );
+	
+	highest=baseState.highest;
+	tray=baseState.tray&~( Tray( 1 )<<( firstTheft-1 ) );
+	if( secondTheft>0 ) tray&=~( Tray( 1 )<<( secondTheft-1 ) );
+	ourTurn=!baseState.ourTurn;
+	
+	cacheHash();
+}
+
 /** Sorting */
 void CrossoutState::cacheHash()
 {
-	hashCode=( ourTurn ? 1 : 0 )<<tray.size();
-	for( vector< bool >::iterator count=tray.begin(); count!=tray.end();
-		++count )
-		hashCode+=( *count ? 1 : 0 )<<( count-tray.begin() );
-	hashCode=abs( hashCode );
+	unsigned int lowest=tray!=0 ? lowestOf( tray ) : 0;
+	Tray rest=tray&( tray-1 ); //all but the lowest
+	
+	pairs=0;
+	if( lowest!=0 && lowest<MAX_SUM )
+	{
+		Tray lowestBit=tray&~rest;
+		
+		pairs=rest&upTo( MAX_SUM-lowest ); //they can go with it
+		if( pairs!=0 ) pairs|=lowestBit; //so it can go with them
+	}
+	
+	Tray others=tray&~pairs;
+	loners=__builtin_popcountll( others );
+	
+	//stand the loners in for the largest numbers that aren't pairable,
+	//which would be just as lonely:
+	Tray spares=upTo( min( MAX_SUM, highest ) )&~pairs;
+	canonical=pairs;
+	for( unsigned int count=0; count<loners; ++count )
+	{
+		Tray largest=Tray( 1 )<<( BITS-1-__builtin_clzll( spares ) );
+		
+		canonical|=largest;
+		spares&=~largest;
+	}
+	
+	uint64_t mixed=index()*0x9e3779b97f4a7c15ULL; //scatter the low bits
+	hashCode=int( mixed>>33 );
 	assert( hashCode>=0 );
 }
@@ -17,11 +17,17 @@
 #ifndef CROSSOUTSTATE_H
 #define CROSSOUTSTATE_H
 
+#include "MoveBuffer.h"
+#include <algorithm>
+#include <cassert>
+#include <stdint.h>
 #include <string>
 #include <vector>
 
 /**
-Represents the Crossout game state at some fixed point in time.
+Represents the Crossout game state at some fixed point in time.  Only the
+numbers no greater than the maximum sum can ever be taken, so those are kept
+as the bits of a single word, and the rest are merely counted.
 
 @author Sol Boucher <slb1566@rit.edu>
 */
@@ -49,19 +55,47 @@ class CrossoutState
 			VICTORY=1
 		};
 	
+	public: //representation
+		/** A set of numbers, where bit n-1 stands for n; it's what
+			limits how many numbers may be in play */
+		typedef uint64_t Tray;
+		
+		/** How many numbers a <tt>Tray</tt> can hold */
+		static const unsigned int BITS=8*sizeof( Tray );
+	
 	private: //state
-		/** Position n-1 tells whether n is still uncrossed */
-		std::vector< bool > tray;
+		/** How many numbers there are, some of which may forever be
+			too large to take */
+		unsigned int highest;
+		
+		/** Which of the numbers that may ever be taken are still
+			uncrossed */
+		Tray tray;
 		
 		/** Whether the computer player is up */
 		bool ourTurn;
 		
+		/** The numbers still uncrossed that may be taken together with
+			some other one */
+		Tray pairs;
+		
+		/** How many of the numbers that may be taken alone are too big
+			to be taken along with anything else; since that will
+			never change, they are interchangeable */
+		unsigned int loners;
+		
+		/** The tray of the position's canonical form: its
+			<tt>pairs</tt>, plus <tt>loners</tt> of the largest other
+			numbers, which is equal to us */
+		Tray canonical;
+		
 		/** Caches the current hash code */
 		int hashCode;
 	
 	public: //behavior
 		/**
 		Creates a new game given its initial circumstances.
+		@pre The game <tt>fits()</tt>.
 		@param greedyDivide how large a sum may be taken per turn
 		@param highValue the highest-numbered piece to generate
 		@param weAreUp whether or not the "good guy" is up
@@ -74,7 +108,8 @@ class CrossoutState
 			of pins.  This makes the most sense when a positive nu
 			mber of them are taken, and preferably ones that haven
 			't already been taken; however, this is not required.
-		@pre The theft targets are in range.
+		@pre The theft targets are in range, and no greater than
+			<tt>MAX_SUM</tt>.
 		@pre The targets haven't yet been crossed out.
 		@post The new state reflects the fact that it is now the oppos
 			ite player's turn.
@@ -90,6 +125,14 @@ class CrossoutState
 		*/
 		inline ~CrossoutState( void );
 		
+		/**
+		Checks whether a game is small enough to represent.
+		@param greedyDivide how large a sum may be taken per turn
+		@param highValue the highest-numbered piece
+		@return whether each number that may ever be taken gets a bit
+		*/
+		inline static bool fits( int greedyDivide, int highValue );
+		
 		/**
 		Reveals the number of numbers in this game.
 		@return the count
@@ -100,7 +143,23 @@ class CrossoutState
 		Judges whether the game is over.
 		@return whether there are no pins left
 		*/
-		bool gameOver( void ) const;
+		inline bool gameOver( void ) const;
+		
+		/**
+		Counts the numbers that may still be crossed out, at least one
+			of which every move takes.
+		@return how many there are
+		*/
+		inline unsigned int remaining( void ) const;
+		
+		/**
+		Looks for a move that crosses out the last of the numbers,
+			which takes there being one, or two that may be taken
+			together.
+		@return the index of that move among our
+			<tt>successors</tt>, or <tt>-1</tt> if there isn't one
+		*/
+		inline int winningSuccessor( void ) const;
 		
 		/**
 		Devines the match score, which is only meaningful if the game 
@@ -121,7 +180,7 @@ class CrossoutState
 		Returns all possible successor states.
 		@return whatever might happen next
 		*/
-		void successors( std::vector< CrossoutState >& result ) const;
+		void successors( MoveBuffer< CrossoutState >& result ) const;
 		
 		/**
 		Produces a synopsis of this <tt>State</tt>'s particulars.
@@ -129,6 +188,13 @@ class CrossoutState
 		*/
 		std::string str( void ) const;
 		
+		/**
+		Names the variant of the game this <tt>State</tt> belongs
+			to, which decides which others it can be compared with.
+		@return the name, including any parameters of the rules
+		*/
+		std::string variant( void ) const;
+		
 		/**
 		Hashes the <tt>State</tt>.
 		@pre <tt>hashCode</tt> is up to date
@@ -137,11 +203,29 @@ class CrossoutState
 		*/
 		inline int hash( void ) const;
 		
+		/**
+		Numbers the <tt>State</tt> for a <tt>DirectTable</tt>.
+		@pre <tt>canonical</tt> is up to date
+		@post The result is less than <tt>indices()</tt>, and equal
+			positions get the same one.
+		@return a number unique to this position and those equal to it
+		*/
+		inline uint64_t index( void ) const;
+		
+		/**
+		Counts the numbers <tt>index()</tt> might return.
+		@return how many positions of this game could be told apart,
+			or the largest representable number if that's more
+		*/
+		inline uint64_t indices( void ) const;
+		
 		/**
 		Checks identity
-		@pre <tt>sorted</tt> is up to date
+		@pre <tt>canonical</tt> is up to date
 		@param another comparable <tt>State</tt>
-		@return whether the turns and pin groups are the same
+		@return whether the turns are the same and the same numbers may
+			be taken in pairs, with as many left that may only be
+			taken alone
 		*/
 		inline bool operator==( const CrossoutState& another ) const;
 		
@@ -179,8 +263,38 @@ class CrossoutState
 	
 	private: //helpers
 		/**
-		Recomputes hash code; must be called every time <tt>tray</
-			tt> is mutated.
+		Overwrites this state in place with the one resulting from
+			crossing values out of another; it's what the advancing
+			constructor does.
+		@pre <tt>baseState</tt> is some other object.
+		@pre The two instances' constant data match
+		@param baseState the state on which to base this one
+		@param firstTheft the first value to take
+		@param secondTheft the (optional) second value to take
+		*/
+		void advance( const CrossoutState& baseState, int firstTheft,
+			int secondTheft=0 );
+		
+		/**
+		Finds the numbers no greater than some bound.
+		@param value the bound
+		@return the <tt>Tray</tt> with every number up to
+			<tt>value</tt>, up to as many as fit
+		*/
+		inline static Tray upTo( unsigned int value );
+		
+		/**
+		Identifies the smallest number in a <tt>Tray</tt>.
+		@pre <tt>numbers</tt> isn't empty.
+		@param numbers the <tt>Tray</tt>
+		@return that number
+		*/
+		inline static unsigned int lowestOf( Tray numbers );
+		
+		/**
+		Recomputes <tt>pairs</tt>, <tt>loners</tt>,
+			<tt>canonical</tt>, and the hash code; must be called
+			every time <tt>tray</tt> is mutated.
 		*/
 		void cacheHash( void );
 };
@@ -188,10 +302,37 @@ class CrossoutState
 /** @brief Destructor */
 CrossoutState::~CrossoutState() {}
 
+/** @brief Representable? */
+bool CrossoutState::fits( int greedyDivide, int highValue )
+{
+	return unsigned( std::min( greedyDivide, highValue ) )<=BITS;
+}
+
 /** @brief An idea of our bounds */
 int CrossoutState::traySize() const
 {
-	return tray.size();
+	return highest;
+}
+
+/** @brief Are we out of objects? */
+bool CrossoutState::gameOver() const
+{
+	return tray==0; //it only holds numbers that could be taken
+}
+
+/** @brief How many could go? */
+unsigned int CrossoutState::remaining() const
+{
+	return __builtin_popcountll( tray );
+}
+
+/** @brief Winning moves */
+int CrossoutState::winningSuccessor() const
+{
+	if( tray!=0 && ( tray&( tray-1 ) )==0 ) return 0; //just the one
+	if( remaining()==2 && pairs==tray ) return 1; //after the smaller alone
+	
+	return -1;
 }
 
 /** @brief Who won? */
@@ -215,13 +356,41 @@ int CrossoutState::hash() const
 	return hashCode;
 }
 
+/** @brief Numbering */
+uint64_t CrossoutState::index() const
+{
+	return canonical<<1|( ourTurn ? 1 : 0 );
+}
+
+/** @brief How many numbers? */
+uint64_t CrossoutState::indices() const
+{
+	unsigned int bits=std::min( MAX_SUM, highest )+1; //and one for the
+		//turn
+	
+	return bits<BITS ? uint64_t( 1 )<<bits : ~uint64_t( 0 );
+}
+
 /** @brief Same state? */
 bool CrossoutState::operator==( const CrossoutState& another ) const
 {
 	return this->MAX_SUM==another.MAX_SUM &&
-		equal( this->tray.begin(), this->tray.end(),
-		another.tray.begin() ) &&
-		this->ourTurn==another.ourTurn;
+		this->ourTurn==another.ourTurn &&
+		this->canonical==another.canonical;
+}
+
+/** @brief Low end */
+CrossoutState::Tray CrossoutState::upTo( unsigned int value )
+{
+	return value>=BITS ? ~Tray( 0 ) : ( Tray( 1 )<<value )-1;
+}
+
+/** @brief Smallest */
+unsigned int CrossoutState::lowestOf( Tray numbers )
+{
+	assert( numbers!=0 );
+	
+	return __builtin_ctzll( numbers )+1;
 }
 
 #endif
@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DIRECTTABLE_H
+#define DIRECTTABLE_H
+
+#include "HashTable.h"
+#include <cstddef>
+#include <stdint.h>
+
+/**
+A table that stores each value at its key's own index in a flat array, for
+keys that provide the <tt>public uint64_t index(void) const</tt> and
+<tt>public uint64_t indices(void) const</tt> methods, where equal keys share an
+index strictly less than the latter.  No keys are stored, so a lookup is a
+single array access.  Nor are whole values: a value packs itself into a
+nonzero code with <tt>public unsigned int pack(void) const</tt>, which must
+fit in its <tt>public static const unsigned int PACKED_BITS</tt> (a divisor of
+64), and is rebuilt from one by its <tt>public explicit Value(unsigned
+int)</tt> constructor, so it only keeps what fits in those bits.  An index
+whose code is zero holds nothing.  The array is sized by the first key it
+sees; if that key says there are too many indices to allocate outright, the
+table falls back to a <tt>HashTable</tt> instead, and it offers the same
+interface whichever it uses.  Later keys whose indices lie beyond the array go
+to that same <tt>HashTable</tt>, so a key needn't know the largest index of
+every position that will ever be stored alongside it, and there values are
+kept whole.  A table <tt>limit()</tt>ed to a fixed number of bytes only uses
+the array if it fits, and gives the <tt>HashTable</tt> whatever is left.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+template< class Key, class Value >
+class DirectTable
+{
+	private:
+		/** The most indices we'll allocate room for */
+		static const uint64_t MAX_INDICES=uint64_t( 1 )<<27;
+		
+		/** How many indices fit in each word of <tt>codes</tt> */
+		static const unsigned int PER_WORD=8*sizeof( uint64_t )/
+			Value::PACKED_BITS;
+		
+		/** Picks one index's code out of its word */
+		static const uint64_t MASK=( uint64_t( 1 )<<Value::PACKED_BITS )-1;
+		
+		/** How we're storing things */
+		enum Mode
+		{
+			UNDECIDED, //we haven't seen a key yet
+			DIRECT, //in the array
+			HASHED //in the fallback table
+		};
+		
+		/** How we're storing things now */
+		Mode mode;
+		
+		/** How many indices the array covers */
+		uint64_t range;
+		
+		/** The packed value at each index, or <tt>0</tt> where there's
+			none */
+		uint64_t* codes;
+		
+		/** The value <tt>find()</tt> unpacked last */
+		Value unpacked;
+		
+		/** The number of indices holding values */
+		int occupied;
+		
+		/** The most memory we may occupy, or <tt>0</tt> for no limit */
+		uint64_t budget;
+		
+		/** What the array has been through */
+		TableStatistics counts;
+		
+		/** Where everything goes if the array would be too big, and
+			whatever lies past them otherwise */
+		HashTable< Key, Value > fallback;
+		
+		/**
+		Passes a fallback table's entries on to a visitor by their
+			keys' indices, as though we were direct.
+		*/
+		template< class Visitor > class ByIndex
+		{
+			private:
+				/** Whoever's really visiting */
+				Visitor& inner;
+			
+			public:
+				/**
+				Passes entries on to a particular visitor.
+				@param visitor whoever's really visiting
+				*/
+				explicit ByIndex( Visitor& visitor ): inner(
+					visitor ) {}
+				
+				/**
+				Passes one entry on.
+				@param key the entry's key
+				@param value its value
+				*/
+				void operator()( const Key& key, const Value& value )
+				{
+					inner( key.index(), value );
+				}
+		};
+		
+		/**
+		Chooses how to store things, if we haven't already.
+		@param key a representative key
+		*/
+		void decide( const Key& key );
+		
+		/**
+		Copying is unsupported.
+		*/
+		DirectTable( const DirectTable& );
+		
+		/**
+		Assignment is unsupported.
+		*/
+		DirectTable& operator=( const DirectTable& );
+	
+	public:
+		/**
+		Remembers where a lookup left off, so that storing the same
+			key afterward needn't find it again.
+		*/
+		class Locator
+		{
+			friend class DirectTable;
+			
+			private:
+				/** The key's index, when we're direct */
+				uint64_t slot;
+				
+				/** Where the fallback table left off */
+				typename HashTable< Key, Value >::Locator
+					hashed;
+			
+			public:
+				/**
+				Creates a <tt>Locator</tt> that doesn't yet
+					point anywhere.
+				*/
+				Locator( void ): slot( 0 ), hashed() {}
+		};
+		
+		/**
+		Create a <tt>DirectTable</tt>, deferring any allocation until
+			we know how large the keys' indices get.
+		*/
+		DirectTable( void );
+		
+		/**
+		Destroys a <tt>DirectTable</tt>.
+		*/
+		~DirectTable( void );
+		
+		/**
+		Looks up a key and remembers where it went, so that a
+			subsequent <tt>store()</tt> of the same key needn't
+			search again.
+		@param key the key to look up
+		@param where set to the key's location
+		@return the stored value, which remains valid until the next
+			lookup in or modification of the table, or
+			<tt>NULL</tt> if the key is absent
+		*/
+		const Value* find( const Key& key, Locator& where );
+		
+		/**
+		Inserts or overwrites the value for a key.
+		@pre <tt>where</tt> came from a <tt>find()</tt> of this same
+			key.
+		@param where the key's location
+		@param key the key to store
+		@param value its new value
+		@param worth how much the entry is worth keeping, which only
+			matters once a <tt>limit()</tt>ed table's fallback is
+			full
+		@return whether the table had room
+		*/
+		bool store( Locator& where, const Key& key, const Value& value,
+			unsigned char worth=0 );
+		
+		/**
+		Counts the stored values.
+		@return how many
+		*/
+		inline int size( void ) const;
+		
+		/**
+		Calls <tt>visitor( index, value )</tt> on each stored value in
+			turn, where <tt>index</tt> is a <tt>uint64_t</tt>, the
+			same whether we're direct or not.
+		@param visitor the function object to call
+		*/
+		template< class Visitor > void visit( Visitor& visitor ) const;
+		
+		/**
+		Removes every entry not stored by index for which
+			<tt>doomed( key, value )</tt> is <tt>true</tt>, as
+			<tt>HashTable::sweep()</tt> does.  Entries stored by
+			index are left be, since we don't keep their keys and
+			their array doesn't grow anyway.
+		@param doomed the function object to ask
+		@return how many entries were removed
+		*/
+		template< class Filter > uint64_t sweep( const Filter& doomed );
+		
+		/**
+		Empties the table of all its entries, and frees its array
+			until it's needed again.
+		*/
+		void purge( void );
+		
+		/**
+		Empties the table and limits the memory it may occupy from now
+			on, as <tt>HashTable::limit()</tt> does.
+		@param bytes the most memory the table may occupy,
+			or <tt>0</tt> for no limit
+		@return whether the fallback table could get that memory
+		*/
+		bool limit( uint64_t bytes );
+		
+		/**
+		Adds what the table has been through to a running total, as
+			<tt>HashTable::tally()</tt> does, counting each direct
+			lookup as a single probe.
+		@param into the total
+		*/
+		void tally( TableStatistics& into ) const;
+};
+
+/** @brief How full? */
+template< class Key, class Value >
+int DirectTable< Key, Value >::size() const
+{
+	return occupied+fallback.size();
+}
+
+#include "DirectTable.t.h"
+
+#endif
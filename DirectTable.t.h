@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+//included from "DirectTable.h"
+#include <cassert>
+#include <cstddef>
+#include <new>
+
+/** @brief Constructor */
+template< class Key, class Value >
+DirectTable< Key, Value >::DirectTable():
+	mode( UNDECIDED ), range( 0 ), codes( NULL ), unpacked(), occupied( 0 ),
+	budget( 0 ), counts(), fallback()
+{
+	static_assert( 8*sizeof( uint64_t )%Value::PACKED_BITS==0,
+		"codes mustn't straddle words" );
+}
+
+/** @brief Destructor */
+template< class Key, class Value >
+DirectTable< Key, Value >::~DirectTable()
+{
+	purge();
+}
+
+/** @brief Pick a representation */
+template< class Key, class Value >
+void DirectTable< Key, Value >::decide( const Key& key )
+{
+	uint64_t array;
+	
+	if( mode!=UNDECIDED ) return;
+	
+	range=key.indices();
+	array=( range+PER_WORD-1 )/PER_WORD*sizeof( uint64_t );
+	mode=HASHED; //unless we can get the array
+	if( range<=MAX_INDICES && ( budget==0 || array<=budget ) )
+		try
+		{
+			codes=new uint64_t[( range+PER_WORD-1 )/PER_WORD]();
+			mode=DIRECT;
+		}
+		catch( const std::bad_alloc& noExceptions )
+		{
+			codes=NULL;
+		}
+	
+	if( budget!=0 ) //the fallback gets whatever the array doesn't use
+		fallback.limit( mode==HASHED ? budget : array<budget ?
+			budget-array : 1 );
+}
+
+/** @brief Single-access lookup */
+template< class Key, class Value >
+const Value* DirectTable< Key, Value >::find( const Key& key, Locator& where )
+{
+	decide( key );
+	where.slot=key.index();
+	if( mode==HASHED || where.slot>=range ) //past what we were sized for
+		return fallback.find( key, where.hashed );
+	
+	++counts.lookups;
+	++counts.probes;
+	counts.longestProbe=1;
+	unsigned int code=codes[where.slot/PER_WORD]>>where.slot%PER_WORD*
+		Value::PACKED_BITS&MASK;
+	
+	if( code==0 ) return NULL;
+	unpacked=Value( code );
+	
+	return &unpacked;
+}
+
+/** @brief Insert or overwrite */
+template< class Key, class Value >
+bool DirectTable< Key, Value >::store( Locator& where, const Key& key, const
+	Value& value, unsigned char worth )
+{
+	if( mode!=DIRECT ) //we may not have decided yet
+	{
+		decide( key );
+		where.slot=key.index();
+	}
+	assert( where.slot==key.index() );
+	if( mode==HASHED || where.slot>=range )
+		return fallback.store( where.hashed, key, value, worth );
+	
+	uint64_t& word=codes[where.slot/PER_WORD];
+	unsigned int shift=where.slot%PER_WORD*Value::PACKED_BITS;
+	uint64_t code=value.pack();
+	
+	assert( code!=0 && code<=MASK );
+	if( ( word>>shift&MASK )==0 )
+	{
+		++occupied;
+		if( uint64_t( occupied )>counts.peakEntries )
+			counts.peakEntries=occupied;
+	}
+	word=( word&~( MASK<<shift ) )|code<<shift;
+	
+	return true;
+}
+
+/** @brief Tour */
+template< class Key, class Value >
+template< class Visitor >
+void DirectTable< Key, Value >::visit( Visitor& visitor ) const
+{
+	ByIndex< Visitor > translator( visitor );
+	
+	fallback.visit( translator );
+	if( mode==DIRECT )
+		for( uint64_t word=0; word<( range+PER_WORD-1 )/PER_WORD;
+			++word )
+			for( uint64_t bits=codes[word]; bits!=0; )
+			{
+				unsigned int entry=__builtin_ctzll( bits )/
+					Value::PACKED_BITS;
+				unsigned int shift=entry*Value::PACKED_BITS;
+				
+				visitor( word*PER_WORD+entry, Value( static_cast<
+					unsigned int >( bits>>shift&MASK ) ) );
+				bits&=~( MASK<<shift );
+			}
+}
+
+/** @brief Weed out */
+template< class Key, class Value >
+template< class Filter >
+uint64_t DirectTable< Key, Value >::sweep( const Filter& doomed )
+{
+	return fallback.sweep( doomed );
+}
+
+/** @brief Hose it all */
+template< class Key, class Value >
+void DirectTable< Key, Value >::purge()
+{
+	delete[] codes;
+	codes=NULL;
+	occupied=0;
+	fallback.purge();
+	mode=UNDECIDED;
+	range=0;
+}
+
+/** @brief Report */
+template< class Key, class Value >
+void DirectTable< Key, Value >::tally( TableStatistics& into ) const
+{
+	TableStatistics mine=counts;
+	
+	mine.entries=occupied;
+	mine.capacity=range;
+	into.add( mine );
+	fallback.tally( into );
+}
+
+/** @brief Budget */
+template< class Key, class Value >
+bool DirectTable< Key, Value >::limit( uint64_t bytes )
+{
+	purge();
+	budget=bytes;
+	
+	return fallback.limit( bytes ); //until we know whether we need it
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENCODING_H
+#define ENCODING_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+
+/**
+Writes the compact byte strings by which states identify themselves outside
+the process, as in a <tt>SolutionDatabase</tt>, and reads them back, as from
+the packed queries of a batch.  Each function that writes appends to whatever
+the string already holds, so a state can build its key from several fields in
+turn; each that reads advances a cursor through memory that it never copies,
+and refuses to read past the end.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+class Encoding
+{
+	private:
+		/**
+		Nobody needs an instance.
+		*/
+		Encoding( void );
+	
+	public:
+		/**
+		Appends a number in as few bytes as it needs: seven bits to a
+			byte, least significant first, with every byte but the
+			last having its high bit set.
+		@param bytes where to append it
+		@param number the number
+		*/
+		static inline void appendVarint( std::string& bytes, uint64_t
+			number );
+		
+		/**
+		Appends a number in exactly as many bytes as asked, least
+			significant first.
+		@param bytes where to append it
+		@param number the number, which should fit
+		@param width how many bytes to use
+		*/
+		template< typename Number > static inline void appendFixed(
+			std::string& bytes, Number number, unsigned int width );
+		
+		/**
+		Reads a number written by <tt>appendVarint()</tt>.
+		@param cursor where it starts, which is advanced past it
+		@param end where the input ends
+		@param number where to put it
+		@return whether it was all there and fit in 64 bits
+		*/
+		static inline bool readVarint( const char*& cursor, const char*
+			end, uint64_t& number );
+		
+		/**
+		Reads a number written by <tt>appendFixed()</tt>.
+		@param cursor where it starts, which is advanced past it
+		@param end where the input ends
+		@param number where to put it
+		@param width how many bytes it takes
+		@return whether it was all there
+		*/
+		template< typename Number > static inline bool readFixed( const
+			char*& cursor, const char* end, Number& number,
+			unsigned int width );
+		
+		/**
+		Reads a record: a length, as written by
+			<tt>appendVarint()</tt>, followed by that many bytes.
+		@param cursor where it starts, which is advanced past it
+		@param end where the input ends
+		@param record where to put the start of its bytes
+		@param recordEnd where to put the end of its bytes
+		@return whether it was all there
+		*/
+		static inline bool readRecord( const char*& cursor, const char*
+			end, const char*& record, const char*& recordEnd );
+		
+		/**
+		Hashes a byte string to 64 bits (by FNV-1a, then mixed so that
+			every bit depends on every byte), the same way in every
+			run, build, and host, so that separate processes agree
+			on which of them a state belongs to.
+		@param bytes the string
+		@return the hash
+		*/
+		static inline uint64_t digest( const std::string& bytes );
+};
+
+/** @brief Variable width */
+void Encoding::appendVarint( std::string& bytes, uint64_t number )
+{
+	for( ; number>=0x80; number>>=7 )
+		bytes.push_back( char( ( number&0x7f )|0x80 ) );
+	bytes.push_back( char( number ) );
+}
+
+/** @brief Fixed width */
+template< typename Number >
+void Encoding::appendFixed( std::string& bytes, Number number, unsigned int
+	width )
+{
+	for( ; width>0; --width, number>>=8 )
+		bytes.push_back( char( number&0xff ) );
+}
+
+/** @brief Variable width */
+bool Encoding::readVarint( const char*& cursor, const char* end, uint64_t&
+	number )
+{
+	const char* start=cursor;
+	
+	number=0;
+	for( unsigned int shift=0; cursor<end && shift<64; shift+=7 )
+	{
+		unsigned char byte=static_cast< unsigned char >( *cursor++ );
+		
+		number|=uint64_t( byte&0x7f )<<shift;
+		if( ( byte&0x80 )==0 ) return true;
+	}
+	
+	cursor=start; //it ran off the end, or on too long
+	
+	return false;
+}
+
+/** @brief Fixed width */
+template< typename Number >
+bool Encoding::readFixed( const char*& cursor, const char* end, Number&
+	number, unsigned int width )
+{
+	if( end-cursor<std::ptrdiff_t( width ) ) return false;
+	
+	number=0;
+	for( unsigned int byte=0; byte<width; ++byte )
+		number|=Number( static_cast< unsigned char >( cursor[byte] ) )
+			<<8*byte;
+	cursor+=width;
+	
+	return true;
+}
+
+/** @brief Length-prefixed */
+bool Encoding::readRecord( const char*& cursor, const char* end, const
+	char*& record, const char*& recordEnd )
+{
+	const char* start=cursor;
+	uint64_t length;
+	
+	if( !readVarint( cursor, end, length ) || uint64_t( end-cursor )<
+		length )
+	{
+		cursor=start;
+		
+		return false;
+	}
+	
+	record=cursor;
+	cursor+=length;
+	recordEnd=cursor;
+	
+	return true;
+}
+
+/** @brief Stable hash */
+uint64_t Encoding::digest( const std::string& bytes )
+{
+	uint64_t hash=0xcbf29ce484222325ULL; //FNV-1a's offset basis
+	
+	for( std::string::const_iterator byte=bytes.begin(); byte!=bytes.end();
+		++byte )
+		hash=( hash^static_cast< unsigned char >( *byte ) )*
+			0x100000001b3ULL;
+	
+	hash=( hash^( hash>>30 ) )*0xbf58476d1ce4e5b9ULL; //splitmix64's finish
+	hash=( hash^( hash>>27 ) )*0x94d049bb133111ebULL;
+	
+	return hash^( hash>>31 );
+}
+
+#endif
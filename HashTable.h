@@ -17,51 +17,264 @@
 #ifndef HASHTABLE_H
 #define HASHTABLE_H
 
+#include "Arena.h"
+#include "TableStatistics.h"
+#include <stdint.h>
+#include <cstddef>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 /**
-A hash table implementation to store copies of objects providing a
-<tt>public</tt> copy constructor and supporting the <tt>public int hash(void)
-const</tt> and <tt>public operator==(const Content&) const</tt> methods.
+A hash table implementation to store copies of key-value pairs, where both
+types provide a <tt>public</tt> copy constructor and each key additionally
+supports the <tt>public int hash(void) const</tt> and <tt>public
+operator==(const Key&) const</tt> methods.
+Entries are stored inline in a single flat array addressed by linear probing,
+alongside a parallel array of the keys' hash codes, less their sign bits, that
+serve as fingerprints so that a probe only touches a stored key once its
+fingerprint matches.
+A key that also provides a <tt>public Key(const Key&, Arena&)</tt> constructor
+has its copies made that way, so that whatever it keeps on the heap instead
+lives in the table's own <tt>Arena</tt> and is freed all at once by
+<tt>purge()</tt> or destruction; such a key should also be cheaply movable.
+A table may instead be <tt>limit()</tt>ed to a fixed number of bytes, after
+which it never grows: once it's as full as it may get, each new entry evicts
+one of the first two entries at or after its home slot, which form a bucket
+holding one entry kept for its worth and one that is always replaced, and
+every key is copied in the ordinary way, so that evicting it frees whatever it
+kept on the heap.
+Big arrays are allocated from 2MB huge pages where the system allows, and once
+a table is big enough that growing it would stall, each of the cores rehashes
+its own share of the entries at once.
 
 @author Sol Boucher <slb1566@rit.edu>
 @author Kyle Savarese <kms7341@rit.edu>
 */
-template< class Content >
+template< class Key, class Value >
 class HashTable
 {
 	private:	
-		/** The table's initial size */
-		static const int INITIAL_SIZE=100;
+		/** The table's initial size; must be a power of two */
+		static const int INITIAL_SIZE=128;
 		
-		/** The table's growth factor */
+		/** The table's growth factor; must be a power of two */
 		static const int GROWTH_FACTOR=2;
 		
-		/** The array's current size */
+		/** The fingerprint marking a slot that holds nothing */
+		static const int VACANT=-1;
+		
+		/** The fewest slots a table must have to grow on several
+			threads at once */
+		static const int PARALLEL_GROWTH=1<<20;
+		
+		/** The fewest of the old slots each of those threads rehashes */
+		static const int GROWTH_SHARE=1<<18;
+		
+		/** The array's current size, which is always a power of two */
 		int _size;
 		
-		/** The array of member objects */
-		std::pair< Content, Content >** table;
+		/** One less than <tt>_size</tt>, for reducing hash codes */
+		int mask;
+		
+		/** The number of slots currently occupied */
+		int occupied;
+		
+		/** Counts changes that may have moved or evicted residents */
+		unsigned int epoch;
+		
+		/** The fraction of slots that may fill before we grow */
+		double maxLoad;
+		
+		/** How much each slot's entry is worth keeping, if our size is
+			fixed, or else <tt>NULL</tt> */
+		unsigned char* worths;
+		
+		/** The hash code of each slot's key, or <tt>VACANT</tt> */
+		int* fingerprints;
+		
+		/** The array of member objects, constructed only in the slots
+			whose fingerprints aren't <tt>VACANT</tt> */
+		std::pair< Key, Value >* table;
+		
+		/** Where the keys we've copied keep their payloads, if they
+			know how */
+		Arena payloads;
+		
+		/** What we've been through, which lookups update even though
+			they don't change the table */
+		mutable TableStatistics counts;
 		
 		/**
 		Finds the index occupied by the specified value.
 		@param object the value for which to search
-		@return the corresponding index, the additive inverse of one
-			more than the would-be index if the object isn't
-			present, or <tt>-size-1</tt> if the table is full
+		@return the corresponding index, or the additive inverse of
+			one more than the would-be index if the object isn't
+			present
 		*/
-		int index( const Content& object ) const;
-	
+		int index( const Key& object ) const;
+		
+		/**
+		Determines where a key's probe sequence begins.
+		@param hashCode the key's fingerprint
+		@return the preferred index for the key
+		*/
+		inline int home( int hashCode ) const;
+		
 		/**
-		Enlarges the table to hold more elements.
+		Computes a key's fingerprint, which is its hash code with the
+			sign bit cleared, so that no key's can be
+			<tt>VACANT</tt>.
+		@param key the key
+		@return its fingerprint, which is nonnegative
 		*/
-		void grow( void );
+		inline static int fingerprint( const Key& key );
+		
+		/**
+		Counts a search for a key.
+		@param length how many slots past the first it examined
+		*/
+		inline void noteProbe( int length ) const;
+		
+		/**
+		Copies an entry into a vacant slot.
+		@param slot where to put it
+		@param key the key to copy
+		@param value the value to copy
+		@throws std::bad_alloc if there's no room for the copies
+		*/
+		inline void place( int slot, const Key& key, const Value& value
+			);
+		
+		/**
+		Copies an entry into a vacant slot, with the key's payload in
+			our <tt>Arena</tt>.
+		@param entry where to put it
+		@param key the key to copy
+		@param value the value to copy
+		@throws std::bad_alloc if there's no room for the copies
+		*/
+		inline void place( std::pair< Key, Value >* entry, const Key&
+			key, const Value& value, std::true_type );
+		
+		/**
+		Copies an entry into a vacant slot in the ordinary way.
+		@param entry where to put it
+		@param key the key to copy
+		@param value the value to copy
+		@throws std::bad_alloc if there's no room for the copies
+		*/
+		inline void place( std::pair< Key, Value >* entry, const Key&
+			key, const Value& value, std::false_type );
+		
+		/**
+		Moves an entry from one slot to a vacant one, leaving its
+			payload wherever it was.
+		@param destination the vacant slot
+		@param source the occupied slot, which is left vacant
+		*/
+		inline void relocate( std::pair< Key, Value >* destination,
+			std::pair< Key, Value >* source );
+		
+		/**
+		Empties a slot, sliding back whatever was displaced past it.
+		@param hole the occupied slot
+		*/
+		void vacate( int hole );
+		
+		/**
+		Makes room in a full table of fixed size by evicting whichever
+			of the first two entries at or after a key's home slot
+			is worth less.
+		@param key the key that needs the room
+		*/
+		void evict( const Key& key );
+		
+		/**
+		Allocates an array, from huge pages if it's big enough.
+		@param slots how many elements
+		@param each the size of one
+		@return the uninitialized array
+		@throws std::bad_alloc if there's no room
+		*/
+		static void* obtain( int slots, std::size_t each );
+		
+		/**
+		Frees all our arrays, which must already have been emptied.
+		*/
+		void discard( void );
+		
+		/**
+		Enlarges the table to hold more elements, unless its size is
+			fixed.
+		@return whether the table was able to grow
+		*/
+		bool grow( void );
+		
+		/**
+		Moves one share of the entries from the arrays we outgrew into
+			our doubled ones, first clearing this share's two halves
+			of the new fingerprints so that they land in memory near
+			whichever thread will probe them.  An entry whose probe
+			sequence would run into another share's slots is left
+			behind for the caller to move once everyone's done.
+		@param oldTable the outgrown entries
+		@param oldFingerprints the outgrown fingerprints
+		@param oldSize the outgrown size
+		@param first the first home slot, among the old ones, in the
+			share
+		@param last one past the last home slot in the share
+		@param deferred where to list the old slots left behind
+		*/
+		void rehash( std::pair< Key, Value >* oldTable, const int*
+			oldFingerprints, int oldSize, int first, int last,
+			std::vector< int >& deferred );
+		
+		/**
+		Copying is unsupported.
+		*/
+		HashTable( const HashTable& );
+		
+		/**
+		Assignment is unsupported.
+		*/
+		HashTable& operator=( const HashTable& );
 	
 	public:
+		/**
+		Remembers where a lookup left off, so that storing the same
+			key afterward can pick up the probe sequence from there
+			instead of starting it over.
+		*/
+		class Locator
+		{
+			friend class HashTable;
+			
+			private:
+				/** Where the probe sequence stopped */
+				int slot;
+				
+				/** The table's <tt>epoch</tt> at the time */
+				unsigned int epoch;
+			
+			public:
+				/**
+				Creates a <tt>Locator</tt> that doesn't yet
+					point anywhere.
+				*/
+				Locator( void ): slot( -1 ), epoch( 0 ) {}
+		};
+		
+		/** The default for the fraction of slots that may be filled */
+		static const double DEFAULT_LOAD;
+		
 		/**
 		Create a <tt>HashTable</tt>.
+		@pre <tt>maximumLoad</tt> lies strictly between zero and one.
+		@param maximumLoad the fraction of slots allowed to fill
+			before the table enlarges itself
 		*/
-		HashTable( void );
+		explicit HashTable( double maximumLoad=DEFAULT_LOAD );
 		
 		/**
 		Destroys a <tt>HashTable</tt>.
@@ -77,14 +290,40 @@ class HashTable
 		@return whether the operation succeeded
 		@pre No identical <tt>key</tt> is already in the table.
 		*/
-		bool add( const Content& key, const Content& value );
+		bool add( const Key& key, const Value& value );
+		
+		/**
+		Looks up a key using a single probe sequence.
+		@param key the key for which to search
+		@param where records where the search ended, for use by a
+			later call to <tt>store()</tt>
+		@return the table's value for that key, or <tt>NULL</tt> if
+			it isn't present; this remains valid only until the
+			table is next modified
+		*/
+		Value* find( const Key& key, Locator& where );
+		
+		/**
+		Associates a value with a key, overwriting any value already
+			present.  If nothing has moved since the <tt>find()</tt>
+			that produced <tt>where</tt>, this resumes that call's
+			probe sequence rather than beginning a new one.
+		@param where the result of looking up this <tt>key</tt>
+		@param key the keying object
+		@param value the referred object
+		@param worth how much the entry is worth keeping, which only
+			matters once a <tt>limit()</tt>ed table is full
+		@return whether the operation succeeded
+		*/
+		bool store( Locator& where, const Key& key, const Value& value,
+			unsigned char worth=0 );
 		
 		/**
 		Checks whether a key is in the table.
 		@param object the key for which to search
 		@return whether the object was found
 		*/
-		inline bool contains( const Content& object ) const;
+		inline bool contains( const Key& object ) const;
 		
 		/**
 		Retrieves a copy of the table's value corresponding to the
@@ -93,26 +332,63 @@ class HashTable
 		@return result the match
 		@pre The table contains a copy of <tt>object</tt>.
 		*/
-		inline void matching( const Content& object, Content& result ) const;
+		inline void matching( const Key& object, Value& result ) const;
 		
 		/**
 		Determines the current number of objects stored in the table.
 		*/
-		int size( void ) const;
+		inline int size( void ) const;
+		
+		/**
+		Adds what the table has been through to a running total.
+		@param into the total
+		*/
+		void tally( TableStatistics& into ) const;
+		
+		/**
+		Calls <tt>visitor( key, value )</tt> on each entry in turn.
+		@param visitor the function object to call
+		*/
+		template< class Visitor > void visit( Visitor& visitor ) const;
 		
 		/**
 		Removes the specified key and the value corresponding to it.
+			Any payload it kept in our <tt>Arena</tt> stays there
+			until the next <tt>purge()</tt>.
 		@param object the key to remove
 		@return whether the object was found
 		*/
-		bool remove( const Content& object );
+		bool remove( const Key& object );
+		
+		/**
+		Removes every entry for which <tt>doomed( key, value )</tt>
+			is <tt>true</tt>, in a single pass over the table.  As
+			with <tt>remove()</tt>, their payloads stay in our
+			<tt>Arena</tt> until the next <tt>purge()</tt>.
+		@param doomed the function object to ask
+		@return how many entries were removed
+		*/
+		template< class Filter > uint64_t sweep( const Filter& doomed );
 		
 		/**
 		Empties the table of all its entries.
 		@post All the table's copies of the objects have been
-			destroyed.
+			destroyed, and its <tt>Arena</tt> released.
 		*/
 		void purge( void );
+		
+		/**
+		Empties the table and fixes its size at as many slots as fit in
+			a number of bytes (but at least its initial size), which
+			are allocated up front, or else lets it grow as it needs
+			again.
+		@param bytes the most memory the table's arrays may occupy,
+			not counting anything its keys keep on the heap, or
+			<tt>0</tt> for no limit
+		@return whether the table could get that memory; if not, it
+			is left to grow as it needs
+		*/
+		bool limit( uint64_t bytes );
 };
 
 #include "HashTable.t.h"
@@ -18,92 +18,309 @@
  *  @author Kyle Savarese <kms7341@rit.edu>
  */
 //included from "HashTable.h"
+#include "HugePages.h"
+#include <algorithm>
 #include <cassert>
+#include <climits>
 #include <cstddef>
+#include <functional>
 #include <new>
+#include <system_error>
+#include <thread>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+/** @brief Default occupancy bound */
+template< class Key, class Value >
+const double HashTable< Key, Value >::DEFAULT_LOAD=0.75;
 
 /** @brief Constructor */
-template< class Content >
-HashTable< Content >::HashTable():
-	_size( INITIAL_SIZE ), table( new std::pair< Content,
-	Content >*[INITIAL_SIZE] )
+template< class Key, class Value >
+HashTable< Key, Value >::HashTable( double maximumLoad ):
+	_size( INITIAL_SIZE ), mask( INITIAL_SIZE-1 ), occupied( 0 ),
+	epoch( 0 ), maxLoad( maximumLoad ), worths( NULL ),
+	fingerprints( static_cast< int* >( obtain( INITIAL_SIZE, sizeof( int )
+	) ) ), table( static_cast< std::pair< Key, Value >* >( obtain(
+	INITIAL_SIZE, sizeof( std::pair< Key, Value > ) ) ) ), payloads(),
+	counts()
 {
+	assert( maxLoad>0 && maxLoad<1 );
+	assert( ( _size&mask )==0 ); //power of two
+	
 	for( int index=0; index<_size; ++index )
-		table[index]=NULL;
+		fingerprints[index]=VACANT;
 }
 
 /** @brief Destructor */
-template< class Content >
-HashTable< Content >::~HashTable()
+template< class Key, class Value >
+HashTable< Key, Value >::~HashTable()
 {
 	purge();
-	delete[] table;
+	discard();
+}
+
+/** @brief Allocate an array */
+template< class Key, class Value >
+void* HashTable< Key, Value >::obtain( int slots, std::size_t each )
+{
+	return HugePages::allocate( std::size_t( slots )*each );
+}
+
+/** @brief Free the arrays */
+template< class Key, class Value >
+void HashTable< Key, Value >::discard()
+{
+	HugePages::release( fingerprints, std::size_t( _size )*sizeof( int ) );
+	fingerprints=NULL;
+	HugePages::release( table, std::size_t( _size )*sizeof( std::pair< Key,
+		Value > ) );
 	table=NULL;
+	HugePages::release( worths, std::size_t( _size )*sizeof( unsigned char
+		) );
+	worths=NULL;
+}
+
+/** @brief Scatters hash codes across the whole table */
+template< class Key, class Value >
+int HashTable< Key, Value >::home( int hashCode ) const
+{
+	//the keys' hash codes tend to vary only in their low bits, so mix
+	//them up before masking:
+	unsigned int scattered=hashCode;
+	scattered^=scattered>>16;
+	scattered*=0x85ebca6bU;
+	scattered^=scattered>>13;
+	scattered*=0xc2b2ae35U;
+	scattered^=scattered>>16;
+	
+	return scattered&mask;
+}
+
+/** @brief Never vacant */
+template< class Key, class Value >
+int HashTable< Key, Value >::fingerprint( const Key& key )
+{
+	return key.hash()&INT_MAX;
+}
+
+/** @brief Fill a slot */
+template< class Key, class Value >
+void HashTable< Key, Value >::place( int slot, const Key& key, const Value&
+	value )
+{
+	if( worths!=NULL ) //an evicted key must take its payload with it
+		place( &table[slot], key, value, std::false_type() );
+	else
+		place( &table[slot], key, value, std::integral_constant< bool,
+			std::is_constructible< Key, const Key&, Arena&
+			>::value >() );
+}
+
+/** @brief Fill a slot from the arena */
+template< class Key, class Value >
+void HashTable< Key, Value >::place( std::pair< Key, Value >* entry, const
+	Key& key, const Value& value, std::true_type )
+{
+	new( entry ) std::pair< Key, Value >( Key( key, payloads ), value );
+}
+
+/** @brief Fill a slot from the heap */
+template< class Key, class Value >
+void HashTable< Key, Value >::place( std::pair< Key, Value >* entry, const
+	Key& key, const Value& value, std::false_type )
+{
+	new( entry ) std::pair< Key, Value >( key, value );
+}
+
+/** @brief Move house */
+template< class Key, class Value >
+void HashTable< Key, Value >::relocate( std::pair< Key, Value >* destination,
+	std::pair< Key, Value >* source )
+{
+	new( destination ) std::pair< Key, Value >( std::move( *source ) );
+	source->~pair();
 }
 
 /** @brief Find the index or intended index */
-template< class Content >
-int HashTable< Content >::index( const Content& object ) const
+template< class Key, class Value >
+int HashTable< Key, Value >::index( const Key& object ) const
 {
-	int hashCode=object.hash(), targetIndex=hashCode%_size;
+	int hashCode=fingerprint( object );
+	int start=home( hashCode );
 	
-	if( table[targetIndex]==NULL ) //the requested index is free for the
-		//taking
-		return -targetIndex-1;
-	else //there's something at the requested location
+	//we never fill up completely, so this must hit a vacancy eventually:
+	for( int _index=start; ; _index=( _index+1 )&mask )
 	{
-		if( table[targetIndex]->first==object ) //the supplied object
-			//is, in fact, at that index
-			return targetIndex;
-		else //use open addressing to find it
+		if( fingerprints[_index]==VACANT ) //found a spot
 		{
-			for( int _index=(targetIndex+1)%_size;
-				_index!=targetIndex; _index=(_index+1)%_size )
-			{
-				if( table[_index]==NULL ) //found a spot
-					return -_index-1;
-				else if( table[_index]->first==object )
-					 //found what we're looking for
-					return _index;
-			}
+			noteProbe( ( _index-start )&mask );
+			
+			return -_index-1;
+		}
+		else if( fingerprints[_index]==hashCode &&
+			table[_index].first==object ) //found what we're
+			//looking for
+		{
+			noteProbe( ( _index-start )&mask );
 			
-			return -_size-1;
+			return _index;
 		}
 	}
 }
 
+/** @brief Keep score */
+template< class Key, class Value >
+void HashTable< Key, Value >::noteProbe( int length ) const
+{
+	++counts.lookups;
+	counts.probes+=length+1;
+	if( uint64_t( length+1 )>counts.longestProbe )
+		counts.longestProbe=length+1;
+}
+
 /** @brief Expands the table */
-template< class Content >
-void HashTable< Content >::grow()
+template< class Key, class Value >
+bool HashTable< Key, Value >::grow()
 {
-	int oldSize=_size;
-	std::pair< Content, Content >** oldTable=table;
+	static_assert( GROWTH_FACTOR==2, "each share rehashes into two halves" );
+	int newSize=_size*GROWTH_FACTOR;
+	int* newFingerprints;
+	std::pair< Key, Value >* newTable;
+	
+	if( worths!=NULL ) return false; //our size is fixed
 	
-	_size=oldSize*GROWTH_FACTOR;
 	try
 	{
-		table=new std::pair< Content, Content >*[_size];
+		newFingerprints=static_cast< int* >( obtain( newSize, sizeof( int
+			) ) );
 	}
 	catch( const std::bad_alloc& noExceptions )
 	{
-		_size=oldSize;
+		return false; //keep limping along at the old size
+	}
+	try
+	{
+		newTable=static_cast< std::pair< Key, Value >* >( obtain( newSize,
+			sizeof( std::pair< Key, Value > ) ) );
+	}
+	catch( const std::bad_alloc& noExceptions )
+	{
+		HugePages::release( newFingerprints, std::size_t( newSize
+			)*sizeof( int ) );
+		
+		return false; //likewise
 	}
 	
-	for( int _index=0; _index<_size; ++_index )
-		table[_index]=NULL;
+	int oldSize=_size;
+	int* oldFingerprints=fingerprints;
+	std::pair< Key, Value >* oldTable=table;
+	int shares=1;
+	
+	_size=newSize;
+	mask=newSize-1;
+	++epoch; //everyone's been relocated
+	++counts.grows;
+	fingerprints=newFingerprints;
+	table=newTable;
+	
+	if( oldSize>=PARALLEL_GROWTH )
+		shares=int( std::max( 1U, std::min( std::thread::
+			hardware_concurrency(), unsigned( oldSize/GROWTH_SHARE ) ) ) );
+	while( oldSize%shares!=0 ) --shares; //keep them all the same size
+	
+	std::vector< std::vector< int > > deferred( shares );
+	std::vector< std::thread > helpers;
+	int share=oldSize/shares;
+	
+	for( int helper=1; helper<shares; ++helper )
+		try
+		{
+			helpers.push_back( std::thread( &HashTable::rehash, this,
+				oldTable, oldFingerprints, oldSize, helper*share, (
+				helper+1 )*share, std::ref( deferred[helper] ) ) );
+		}
+		catch( const std::system_error& noThreads ) //do it ourselves
+		{
+			rehash( oldTable, oldFingerprints, oldSize, helper*share, (
+				helper+1 )*share, deferred[helper] );
+		}
+	rehash( oldTable, oldFingerprints, oldSize, 0, share, deferred[0] );
+	for( size_t helper=0; helper<helpers.size(); ++helper )
+		helpers[helper].join();
+	
+	//every key is distinct, so just find each straggler the nearest vacancy:
+	for( int helper=0; helper<shares; ++helper )
+		for( size_t straggler=0; straggler<deferred[helper].size();
+			++straggler )
+		{
+			int oldIndex=deferred[helper][straggler];
+			int _index=home( oldFingerprints[oldIndex] );
+			
+			while( fingerprints[_index]!=VACANT )
+				_index=( _index+1 )&mask;
+			
+			relocate( &table[_index], &oldTable[oldIndex] );
+			fingerprints[_index]=oldFingerprints[oldIndex];
+		}
+	
+	HugePages::release( oldFingerprints, std::size_t( oldSize )*sizeof( int
+		) );
+	HugePages::release( oldTable, std::size_t( oldSize )*sizeof( std::pair<
+		Key, Value > ) );
+	
+	return true;
+}
+
+/** @brief Rehash one share */
+template< class Key, class Value >
+void HashTable< Key, Value >::rehash( std::pair< Key, Value >* oldTable, const
+	int* oldFingerprints, int oldSize, int first, int last, std::vector< int
+	>& deferred )
+{
+	int oldMask=oldSize-1;
 	
-	for( int oldIndex=0; oldIndex<oldSize; ++oldIndex ) {
-		std::pair< Content, Content >* oldData = oldTable[oldIndex];
-		table[-index( oldData->first )-1] = oldData;
+	for( int _index=first; _index<last; ++_index )
+	{
+		fingerprints[_index]=VACANT;
+		fingerprints[_index+oldSize]=VACANT;
 	}
 	
-	delete[] oldTable;
+	//our entries live in the run of occupied slots starting at our first
+	//home one and continuing however far past our last one they spill:
+	for( int step=0; step<oldSize; ++step )
+	{
+		int oldIndex=( first+step )&oldMask;
+		
+		if( oldFingerprints[oldIndex]==VACANT )
+		{
+			if( step>=last-first ) break; //nobody's been displaced this far
+			continue;
+		}
+		
+		int _index=home( oldFingerprints[oldIndex] );
+		int oldHome=_index&oldMask;
+		
+		if( oldHome<first || oldHome>=last ) continue; //not ours
+		
+		//each share owns both slots its old ones split into, but not
+		//whatever comes after either of them:
+		int end=( _index<oldSize ? last : last+oldSize );
+		
+		while( _index<end && fingerprints[_index]!=VACANT ) ++_index;
+		
+		if( _index==end ) deferred.push_back( oldIndex );
+		else
+		{
+			relocate( &table[_index], &oldTable[oldIndex] );
+			fingerprints[_index]=oldFingerprints[oldIndex];
+		}
+	}
 }
 
 /** @brief Adds an element */
-template< class Content >
-bool HashTable< Content >::add( const Content& key, const Content& value )
+template< class Key, class Value >
+bool HashTable< Key, Value >::add( const Key& key, const Value& value )
 {
 	try
 	{
@@ -111,13 +328,95 @@ bool HashTable< Content >::add( const Content& key, const Content& value )
 		assert(_index<0 ); //not already present
 		if( _index>=0 ) return false;
 		
+		if( occupied+1>maxLoad*_size ) //too crowded
+		{
+			if( grow() )
+				_index=index( key );
+			else if( occupied+1>=_size ) //must leave a vacancy
+				return false;
+		}
 		_index=-_index-1;
-		if( _index==_size ) {//out of space
-			grow();
-			_index = -index( key )-1;
+		
+		place( _index, key, value );
+		fingerprints[_index]=fingerprint( key );
+		++occupied;
+		if( uint64_t( occupied )>counts.peakEntries )
+			counts.peakEntries=occupied;
+	}
+	catch( const std::bad_alloc& noExceptions )
+	{
+		return false;
+	}
+	
+	return true;
+}
+
+/** @brief Single-probe lookup */
+template< class Key, class Value >
+Value* HashTable< Key, Value >::find( const Key& key, Locator& where )
+{
+	int _index=index( key );
+	
+	where.epoch=epoch;
+	if( _index>=0 ) //found it
+	{
+		where.slot=_index;
+		
+		return &table[_index].second;
+	}
+	else //it would go here
+	{
+		where.slot=-_index-1;
+		
+		return NULL;
+	}
+}
+
+/** @brief Insert or overwrite where we left off */
+template< class Key, class Value >
+bool HashTable< Key, Value >::store( Locator& where, const Key& key, const
+	Value& value, unsigned char worth )
+{
+	int hashCode=fingerprint( key );
+	
+	if( where.slot<0 || where.epoch!=epoch ) //stale directions
+		find( key, where );
+	else //resume the old probe sequence, skipping anyone who has since
+		//moved into the slots we'd found vacant
+		while( fingerprints[where.slot]!=VACANT &&
+			( fingerprints[where.slot]!=hashCode ||
+			!( table[where.slot].first==key ) ) )
+			where.slot=( where.slot+1 )&mask;
+	
+	try
+	{
+		if( fingerprints[where.slot]!=VACANT ) //already present
+		{
+			table[where.slot].second=value;
+			if( worths!=NULL ) worths[where.slot]=worth;
+			
+			return true;
+		}
+		
+		if( occupied+1>maxLoad*_size ) //too crowded
+		{
+			if( grow() )
+				find( key, where );
+			else if( worths!=NULL ) //we may not grow, so evict
+			{
+				evict( key );
+				find( key, where );
+			}
+			else if( occupied+1>=_size ) //must leave a vacancy
+				return false;
 		}
-		table[_index]=new std::pair< Content, Content >(
-			 Content( key ), Content( value ) );
+		
+		place( where.slot, key, value );
+		fingerprints[where.slot]=hashCode;
+		if( worths!=NULL ) worths[where.slot]=worth;
+		++occupied;
+		if( uint64_t( occupied )>counts.peakEntries )
+			counts.peakEntries=occupied;
 	}
 	catch( const std::bad_alloc& noExceptions )
 	{
@@ -128,71 +427,187 @@ bool HashTable< Content >::add( const Content& key, const Content& value )
 }
 
 /** @brief Contains an element? */
-template< class Content >
-bool HashTable< Content >::contains( const Content& object ) const
+template< class Key, class Value >
+bool HashTable< Key, Value >::contains( const Key& object ) const
 {
 	return index( object )>=0;
 }
 
 /** @brief Retrieves a copy of our own copy */
-template< class Content >
-void HashTable< Content >::matching( const Content& object, Content& result ) const
+template< class Key, class Value >
+void HashTable< Key, Value >::matching( const Key& object, Value& result ) const
 {
 	int _index=index( object );
 	
 	assert( _index>=0 ); //present in table
 	
-	result=table[_index]->second;
+	result=table[_index].second;
 }
 
 /** @brief Current *utilized* size */
-template< class Content >
-int HashTable< Content >::size( void ) const
+template< class Key, class Value >
+int HashTable< Key, Value >::size( void ) const
+{
+	return occupied;
+}
+
+/** @brief Nuke our copy */
+template< class Key, class Value >
+bool HashTable< Key, Value >::remove( const Key& object )
 {
-	int found=0;
+	int hole=index( object );
 	
-	for( int _index=0; _index<_size; ++_index )
-		if( table[_index]!=NULL )
-			++found;
+	if( hole<0 ) return false; //didn't find it
+	vacate( hole );
 	
-	return found;
+	return true;
 }
 
-/** @brief Nuke our copy */
-template< class Content >
-bool HashTable< Content >::remove( const Content& object )
+/** @brief Weed out */
+template< class Key, class Value >
+template< class Filter >
+uint64_t HashTable< Key, Value >::sweep( const Filter& doomed )
 {
-	int _index=index( object );
+	uint64_t removed=0;
 	
-	if( _index<0 ) return false; //didn't find it
+	for( int _index=0; _index<_size; ++_index )
+		//vacate() may slide a later entry back into this slot, so keep
+		//checking it until it holds someone we're keeping:
+		while( fingerprints[_index]!=VACANT && doomed( table[_index].first,
+			table[_index].second ) )
+		{
+			vacate( _index );
+			++removed;
+		}
+	counts.swept+=removed;
 	
-	delete table[_index];
-	table[_index]=NULL;
+	return removed;
+}
+
+/** @brief Clear a slot */
+template< class Key, class Value >
+void HashTable< Key, Value >::vacate( int hole )
+{
+	table[hole].~pair();
+	fingerprints[hole]=VACANT;
+	--occupied;
+	++epoch; //others may be about to slide
 	
-	//slide everything displaced by this element down:
-	for( int checkIndex=( _index+1 )%_size; table[checkIndex]!=NULL &&
-		checkIndex!=_index; checkIndex=( checkIndex+1 )%_size )
+	//slide back everything displaced past the new hole, so that no
+	//probe sequence is ever interrupted by it:
+	for( int checkIndex=( hole+1 )&mask; fingerprints[checkIndex]!=VACANT;
+		checkIndex=( checkIndex+1 )&mask )
 	{
-		int idealLocation=index( table[checkIndex]->first );
+		int idealLocation=home( fingerprints[checkIndex] );
 		
-		if( idealLocation<0 ) //can move to a better place
+		if( ( ( checkIndex-idealLocation )&mask )>=( ( checkIndex-hole
+			)&mask ) ) //can move to a better place
 		{
-			table[-idealLocation-1]=table[checkIndex];
-			table[checkIndex]=NULL;
+			relocate( &table[hole], &table[checkIndex] );
+			fingerprints[hole]=fingerprints[checkIndex];
+			fingerprints[checkIndex]=VACANT;
+			if( worths!=NULL ) worths[hole]=worths[checkIndex];
+			hole=checkIndex;
 		}
 	}
+}
+
+/** @brief Make room */
+template< class Key, class Value >
+void HashTable< Key, Value >::evict( const Key& key )
+{
+	int kept=home( fingerprint( key ) ); //the bucket's entry kept for its worth
+	int replaced; //and the one that's always replaced
 	
-	return true;
+	//we're full enough that neither search goes far:
+	while( fingerprints[kept]==VACANT ) kept=( kept+1 )&mask;
+	replaced=( kept+1 )&mask;
+	while( fingerprints[replaced]==VACANT ) replaced=( replaced+1 )&mask;
+	
+	vacate( worths[replaced]<=worths[kept] ? replaced : kept );
+	++counts.evictions;
+}
+
+/** @brief Report */
+template< class Key, class Value >
+void HashTable< Key, Value >::tally( TableStatistics& into ) const
+{
+	TableStatistics mine=counts;
+	
+	mine.entries=occupied;
+	mine.capacity=_size;
+	into.add( mine );
+}
+
+/** @brief Tour */
+template< class Key, class Value >
+template< class Visitor >
+void HashTable< Key, Value >::visit( Visitor& visitor ) const
+{
+	for( int _index=0; _index<_size; ++_index )
+		if( fingerprints[_index]!=VACANT )
+			visitor( table[_index].first, table[_index].second );
 }
 
 /** @brief Hose it all */
-template< class Content >
-void HashTable< Content >::purge()
+template< class Key, class Value >
+void HashTable< Key, Value >::purge()
 {
 	for( int _index=0; _index<_size; ++_index )
-		if( table[_index]!=NULL )
+		if( fingerprints[_index]!=VACANT )
 		{
-			delete table[_index];
-			table[_index]=NULL;
+			table[_index].~pair();
+			fingerprints[_index]=VACANT;
 		}
+	occupied=0;
+	++epoch;
+	payloads.release(); //now that nobody's using any of it
+}
+
+/** @brief Budget */
+template< class Key, class Value >
+bool HashTable< Key, Value >::limit( uint64_t bytes )
+{
+	const uint64_t SLOT_BYTES=sizeof( int )+sizeof( std::pair< Key, Value >
+		)+sizeof( unsigned char );
+	int slots=INITIAL_SIZE;
+	
+	if( bytes!=0 ) //take as many as fit
+		while( slots<=INT_MAX/GROWTH_FACTOR && uint64_t( slots
+			)*GROWTH_FACTOR*SLOT_BYTES<=bytes )
+			slots*=GROWTH_FACTOR;
+	
+	purge();
+	if( slots==_size && ( worths!=NULL )==( bytes!=0 ) ) return true; //we
+		//already have just the arrays we want
+	
+	discard();
+	_size=slots; //so that discard() frees whatever we manage to get
+	
+	try
+	{
+		fingerprints=static_cast< int* >( obtain( slots, sizeof( int ) ) );
+		table=static_cast< std::pair< Key, Value >* >( obtain( slots,
+			sizeof( std::pair< Key, Value > ) ) );
+		if( bytes!=0 )
+			worths=static_cast< unsigned char* >( obtain( slots, sizeof(
+				unsigned char ) ) );
+	}
+	catch( const std::bad_alloc& noExceptions )
+	{
+		discard();
+		_size=0; //so that we do allocate again
+		if( bytes==0 ) throw; //we can't even get our initial size
+		
+		limit( 0 );
+		
+		return false;
+	}
+	
+	_size=slots;
+	mask=slots-1;
+	for( int index=0; index<_size; ++index )
+		fingerprints[index]=VACANT;
+	
+	return true;
 }
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+#include "HugePages.h"
+#include <new>
+#include <stdint.h>
+#include <sys/mman.h>
+using namespace std;
+
+/** @brief Map it */
+void* HugePages::allocate( size_t bytes )
+{
+	if( bytes<PAGE_SIZE ) return ::operator new( bytes );
+	
+	size_t length=rounded( bytes );
+	void* block;
+	
+#ifdef MAP_HUGETLB
+	block=mmap( NULL, length, PROT_READ|PROT_WRITE, MAP_PRIVATE|
+		MAP_ANONYMOUS|MAP_HUGETLB, -1, 0 );
+	if( block!=MAP_FAILED ) return block; //from the reserved pool
+#endif
+	
+	//otherwise, map a page extra so that we can trim it to a boundary:
+	block=mmap( NULL, length+PAGE_SIZE, PROT_READ|PROT_WRITE, MAP_PRIVATE|
+		MAP_ANONYMOUS, -1, 0 );
+	if( block==MAP_FAILED ) throw bad_alloc();
+	
+	char* start=static_cast< char* >( block );
+	char* aligned=reinterpret_cast< char* >( rounded( reinterpret_cast<
+		uintptr_t >( start ) ) );
+	
+	if( aligned>start ) munmap( start, aligned-start );
+	munmap( aligned+length, start+PAGE_SIZE-aligned );
+#ifdef MADV_HUGEPAGE
+	madvise( aligned, length, MADV_HUGEPAGE );
+#endif
+	
+	return aligned;
+}
+
+/** @brief Unmap it */
+void HugePages::release( void* block, size_t bytes )
+{
+	if( block==NULL ) return;
+	
+	if( bytes<PAGE_SIZE )
+		::operator delete( block );
+	else
+		munmap( block, rounded( bytes ) );
+}
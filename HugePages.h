@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HUGEPAGES_H
+#define HUGEPAGES_H
+
+#include <cstddef>
+
+/**
+Allocates the large arrays behind a memo in 2 MB pages, so that probing one at
+random misses the TLB far less often.  An allocation of at least a huge page
+is mapped from the reserved pool of explicit huge pages if the system has one,
+and otherwise mapped in the ordinary way, aligned to a huge page and marked as
+a candidate for transparent huge pages; anything smaller comes from the heap.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+class HugePages
+{
+	private:
+		/**
+		Nobody needs an instance.
+		*/
+		HugePages( void );
+		
+		/**
+		Rounds a size up to a whole number of huge pages.
+		@param bytes the size
+		@return the rounded size
+		*/
+		static inline std::size_t rounded( std::size_t bytes );
+	
+	public:
+		/** How many bytes a huge page holds */
+		static const std::size_t PAGE_SIZE=std::size_t( 1 )<<21;
+		
+		/**
+		Allocates some memory, whose contents are unspecified.
+		@param bytes how much
+		@return the memory, aligned at least as well as
+			<tt>::operator new</tt> would
+		@throws std::bad_alloc if the system has no more to give
+		*/
+		static void* allocate( std::size_t bytes );
+		
+		/**
+		Frees memory from <tt>allocate()</tt>.
+		@param block the memory, or <tt>NULL</tt> to do nothing
+		@param bytes how much was asked for
+		*/
+		static void release( void* block, std::size_t bytes );
+};
+
+/** @brief Round up */
+std::size_t HugePages::rounded( std::size_t bytes )
+{
+	return ( bytes+PAGE_SIZE-1 )&~( PAGE_SIZE-1 );
+}
+
+#endif
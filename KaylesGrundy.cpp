@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+#include "KaylesGrundy.h"
+#include <cassert>
+using namespace std;
+
+vector< unsigned int > KaylesGrundy::nimbers( 1, 0 ); //the empty line
+
+/** @brief Tabulate */
+void KaylesGrundy::extend( int pins )
+{
+	for( int length=nimbers.size(); length<=pins; ++length )
+	{
+		vector< bool > reachable( length+1, false ); //no nimber can
+			//exceed the number of moves
+		unsigned int least=0;
+		
+		for( int taken=KaylesState::MIN_TAKEN; taken<=KaylesState::
+			MAX_TAKEN && taken<=length; ++taken )
+			for( int left=0; left<=length-taken; ++left )
+			{
+				unsigned int result=nimbers[left]^
+					nimbers[length-taken-left];
+				
+				if( result<reachable.size() )
+					reachable[result]=true;
+			}
+		while( reachable[least] ) ++least; //minimum excludant
+		
+		nimbers.push_back( least );
+	}
+}
+
+/** @brief One line */
+unsigned int KaylesGrundy::nimber( int pins )
+{
+	assert( pins>=0 );
+	
+	if( pins>=PERIODIC_FROM+PERIOD ) //the same as a shorter one
+		pins=PERIODIC_FROM+( pins-PERIODIC_FROM )%PERIOD;
+	if( unsigned( pins )>=nimbers.size() ) extend( pins );
+	
+	return nimbers[pins];
+}
+
+/** @brief Whole position */
+unsigned int KaylesGrundy::nimber( const KaylesState& position )
+{
+	unsigned int sum=0;
+	
+	for( int group=0; group<position.groupsOfPins(); ++group )
+		sum^=nimber( position.pinsInGroup( group ) );
+	
+	return sum;
+}
+
+/** @brief Best move */
+KaylesState KaylesGrundy::nextBestState( const KaylesState& position )
+{
+	unsigned int sum=nimber( position );
+	vector< unsigned int > order;
+	
+	assert( !position.gameOver() );
+	
+	//visit the moves in the order that successors() lists them:
+	position.canonicalOrder( order );
+	if( sum!=0 ) //there's a winning move to be found
+		for( vector< unsigned int >::const_iterator group=
+			order.begin(); group!=order.end(); ++group )
+		{
+			int pins=position.pinsInGroup( *group );
+			unsigned int others=sum^nimber( pins ); //the rest
+			
+			for( int target=0; target<pins; ++target )
+				for( int taken=KaylesState::MIN_TAKEN; taken<=
+					KaylesState::MAX_TAKEN &&
+					target+taken<=pins; ++taken )
+					if( ( nimber( target )^nimber( pins-
+						target-taken ) )==others )
+						//leaves a zero
+						return KaylesState( position,
+							*group, taken,
+							target );
+		}
+	
+	assert( !order.empty() );
+	return KaylesState( position, order.front(), KaylesState::MIN_TAKEN,
+		0 ); //stall
+}
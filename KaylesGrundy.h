@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KAYLESGRUNDY_H
+#define KAYLESGRUNDY_H
+
+#include "KaylesState.h"
+#include <vector>
+
+/**
+Plays Kayles by the Sprague-Grundy theorem rather than by searching.  Kayles
+is impartial, so each line of pins is equivalent to a Nim heap whose size,
+its nimber, depends only on its length, and a position is lost for the player
+to move exactly when its lines' nimbers XOR to zero.  The nimbers of single
+lines are computed once and cached; beyond 82 pins they repeat with a period
+of 12, so even very long lines cost nothing to evaluate.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+class KaylesGrundy
+{
+	private:
+		/** The shortest line after which nimbers are periodic */
+		static const int PERIODIC_FROM=71;
+		
+		/** The period of the nimbers of long lines */
+		static const int PERIOD=12;
+		
+		/** The nimbers of the lines we've seen so far, by length */
+		static std::vector< unsigned int > nimbers;
+		
+		/**
+		Computes the nimbers of all lines up to a given length.
+		@param pins the longest line of interest
+		*/
+		static void extend( int pins );
+		
+		/**
+		Nobody needs an instance.
+		*/
+		KaylesGrundy( void );
+	
+	public:
+		/**
+		Finds the nimber of a single line.
+		@param pins how many pins are in the line
+		@return its nimber
+		*/
+		static unsigned int nimber( int pins );
+		
+		/**
+		Finds the nimber of a whole position.
+		@param position the position in question
+		@return the XOR of its lines' nimbers, which is zero exactly
+			when the player to move will lose
+		*/
+		static unsigned int nimber( const KaylesState& position );
+		
+		/**
+		Picks the move a <tt>Solver</tt> would: the first of the
+			position's <tt>successors()</tt> with a nimber of zero,
+			or just its first successor if there is no such move.
+		@pre The game isn't over.
+		@param position the position in question
+		@return the position after the move
+		*/
+		static KaylesState nextBestState( const KaylesState& position );
+};
+
+#endif
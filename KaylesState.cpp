@@ -2,6 +2,7 @@
  *  @author Kyle Savarese <kms7341@rit.edu>
  */
 #include "KaylesState.h"
+#include "Encoding.h"
 #include <cassert>
 #include <algorithm>
 #include <iostream>
@@ -12,63 +13,58 @@ using namespace std;
 /** @brief Advancing constructor */
 KaylesState::KaylesState( const KaylesState& baseState, unsigned int position,
 	int taken, int target ):
-	ourTurn( !baseState.ourTurn ), hashCode( 0 )
+	pins(), sorted(), ourTurn( !baseState.ourTurn ), hashCode( 0 )
 {
-	assert( position<baseState.pins.size() );
-	for ( int pos = 0; pos < baseState.groupsOfPins(); pos++) {
-		if ( unsigned( pos ) == position ) {
-			if( target != 0 )
-				pins.push_back( target );
-			if( baseState.pinsInGroup( pos ) - target - taken ) {
-				pins.push_back( baseState.
-					pinsInGroup( pos ) - target - taken );
-			}
-		}
-		else {
-			if ( baseState.pinsInGroup( pos ) ) 
-				pins.push_back( baseState.pinsInGroup( pos )
-					);
-		}
-	}
-
-	#ifdef DEBUG
-		cout<<"Advancing state w/ pos "<<position<<" , taking "<<taken
-			<<endl;
-	#endif
-	
-	assert( position<baseState.pins.size() );
-	cacheHash();
+	advance( baseState, position, taken, target );
 }
 
 /** @brief Are we out of objects? */
 bool KaylesState::gameOver() const
 {
-	for( vector< int >::const_iterator group=pins.begin();
-		group!=pins.end(); ++group )
-		if( *group!=0 ) return false;
+	return sorted.empty(); //it only holds the groups with pins left
+}
+
+/** @brief Least to greatest */
+void KaylesState::canonicalOrder( vector< unsigned int >& groups ) const
+{
+	vector< pair< int, unsigned int > > bySize; //sorts stably
+	
+	for( unsigned int group=0; group<pins.size(); ++group )
+		if( pins[group]>0 )
+			bySize.push_back( make_pair( pins[group], group ) );
+	sort( bySize.begin(), bySize.end() );
 	
-	return true;
+	groups.clear();
+	for( vector< pair< int, unsigned int > >::const_iterator entry=
+		bySize.begin(); entry!=bySize.end(); ++entry )
+		groups.push_back( entry->second );
 }
 
 /** @brief What might happen next? */
-void KaylesState::successors( vector< KaylesState >& possibilities ) const
+void KaylesState::successors( MoveBuffer< KaylesState >& possibilities ) const
 {
 	#ifdef DEBUG
 		cout<<"Success calculating successors for "<<str()<<'\n';
 	#endif
 	
-	for( unsigned int group=0; group<pins.size(); ++group ) {
-		for( int pos = 0; pos < pins[group]; pos++ ) {
-			for ( int taken = 1; pos + taken <= pins[group] &&
-				taken <=2; taken++ ) {
-				possibilities.push_back( KaylesState
-					( KaylesState( pins, ourTurn ), group,
-					taken, pos ) );
-
-				#ifdef DEBUG
-					cout<<'\t'<<possibilities.back().str()
-						<<'\n';
-				#endif
+	//visit the groups in canonicalOrder() without having to build it:
+	for( Counts::const_iterator size=sorted.begin();
+		size!=sorted.end(); ++size ) {
+		if( size!=sorted.begin() && *size==*( size-1 ) )
+			continue; //we've already visited all groups this size
+		for( unsigned int group=0; group<pins.size(); ++group ) {
+			if( pins[group]!=*size ) continue;
+			for( int pos = 0; pos < pins[group]; pos++ ) {
+				for ( int taken = 1; pos + taken <= pins[group]
+					&& taken <=2; taken++ ) {
+					possibilities.reuse( *this ).advance(
+						*this, group, taken, pos );
+					
+					#ifdef DEBUG
+						cout<<'\t'<<possibilities.
+							back().str()<<'\n';
+					#endif
+				}
 			}
 		}
 	}
@@ -77,6 +73,18 @@ void KaylesState::successors( vector< KaylesState >& possibilities ) const
 	#endif
 }
 
+/** @brief How many standing? */
+unsigned int KaylesState::remaining() const
+{
+	unsigned int standing=0;
+	
+	for( Counts::const_iterator group=sorted.begin();
+		group!=sorted.end(); ++group )
+		standing+=*group;
+	
+	return standing;
+}
+
 /** @brief Textualizes */
 string KaylesState::str() const
 {
@@ -84,7 +92,7 @@ string KaylesState::str() const
 	
 	assembler<<"It is the "<<( ourTurn ? "computer" : "human" )<<
 		"'s turn and the pins are: ";
-	for( vector< int >::const_iterator group=pins.begin();
+	for( Counts::const_iterator group=pins.begin();
 		group<pins.end(); ++group )
 		assembler<<*group<<' ';
 	assembler.flush();
@@ -92,6 +100,26 @@ string KaylesState::str() const
 	return assembler.str();
 }
 
+/** @brief Which rules? */
+string KaylesState::variant() const
+{
+	stringstream assembler;
+	
+	assembler<<"kayles "<<MIN_TAKEN<<'-'<<MAX_TAKEN;
+	
+	return assembler.str();
+}
+
+/** @brief Serializes */
+void KaylesState::encode( string& bytes ) const
+{
+	bytes.push_back( ourTurn ? 1 : 0 );
+	Encoding::appendVarint( bytes, sorted.size() );
+	for( Counts::const_iterator count=sorted.begin();
+		count!=sorted.end(); ++count )
+		Encoding::appendVarint( bytes, *count );
+}
+
 /** @brief Are these subsequent? */
 bool KaylesState::areSubsequent( const KaylesState& first, const KaylesState&
 	next )
@@ -261,13 +289,52 @@ vector< int > KaylesState::diff( const KaylesState& first, const
 		return vector< int >();
 }
 
+/** @brief Knock some down */
+void KaylesState::advance( const KaylesState& baseState, unsigned int position,
+	int taken, int target )
+{
+	assert( this!=&baseState );
+	assert( position<baseState.pins.size() );
+	
+	pins.clear(); //but hang onto its storage
+	ourTurn=!baseState.ourTurn;
+	for ( int pos = 0; pos < baseState.groupsOfPins(); pos++) {
+		if ( unsigned( pos ) == position ) {
+			if( target != 0 )
+				pins.push_back( target );
+			if( baseState.pinsInGroup( pos ) - target - taken ) {
+				pins.push_back( baseState.
+					pinsInGroup( pos ) - target - taken );
+			}
+		}
+		else {
+			if ( baseState.pinsInGroup( pos ) ) 
+				pins.push_back( baseState.pinsInGroup( pos )
+					);
+		}
+	}
+	
+	#ifdef DEBUG
+		cout<<"Advancing state w/ pos "<<position<<" , taking "<<taken
+			<<endl;
+	#endif
+	
+	cacheHash();
+}
+
 /** Sorting */
 void KaylesState::cacheHash()
 {
-	hashCode=( ourTurn ? 1 : 0 )<<pins.size();
-	for( vector< int >::iterator count=pins.begin(); count!=pins.end();
-		++count )
-		hashCode+=*count<<( count-pins.begin() );
+	sorted.clear();
+	for( Counts::const_iterator count=pins.begin();
+		count!=pins.end(); ++count )
+		if( *count!=0 ) sorted.push_back( *count );
+	sort( sorted.begin(), sorted.end() );
+	
+	hashCode=( ourTurn ? 1 : 0 )<<sorted.size();
+	for( Counts::iterator count=sorted.begin();
+		count!=sorted.end(); ++count )
+		hashCode+=*count<<( count-sorted.begin() );
 	hashCode=abs( hashCode );
 	assert( hashCode>=0 );
 }
@@ -17,6 +17,8 @@
 #ifndef KAYLESSTATE_H
 #define KAYLESSTATE_H
 
+#include "Arena.h"
+#include "MoveBuffer.h"
 #include <string>
 #include <utility>
 #include <vector>
@@ -46,9 +48,17 @@ class KaylesState
 			VICTORY=1
 		};
 	
+	private: //representation
+		/** A list of pin counts, which may live in an <tt>Arena</tt> */
+		typedef std::vector< int, ArenaAllocator< int > > Counts;
+	
 	private: //state
 		/** Stores one pin count per group of pins */
-		std::vector< int > pins;
+		Counts pins;
+		
+		/** The nonempty groups' pin counts in ascending order, which
+			are all that matter to the outcome */
+		Counts sorted;
 		
 		/** Whether the computer player is up */
 		bool ourTurn;
@@ -81,6 +91,25 @@ class KaylesState
 		KaylesState( const KaylesState& baseState, unsigned int
 			position, int taken, int target );
 		
+		/**
+		Copy constructor, which puts the copy on the heap.
+		@param original the state to copy
+		*/
+		inline KaylesState( const KaylesState& original );
+		
+		/**
+		Copy constructor, which puts the copy in an <tt>Arena</tt>.
+		@param original the state to copy
+		@param arena where to keep the pin counts
+		*/
+		inline KaylesState( const KaylesState& original, Arena& arena );
+		
+		/**
+		Move constructor, which leaves the pin counts where they were.
+		@param original the state to gut
+		*/
+		inline KaylesState( KaylesState&& original );
+		
 		/**
 		Destroys the game state.
 		*/
@@ -121,11 +150,35 @@ class KaylesState
 		*/
 		inline int pinsInGroup( unsigned int group ) const;
 		
+		/**
+		Counts the pins still standing, at least one of which every
+			move knocks down.
+		@return how many there are
+		*/
+		unsigned int remaining( void ) const;
+		
+		/**
+		Looks for a move that topples the last of the pins, which
+			takes there being no more than two, side by side.
+		@return the index of that move among our
+			<tt>successors</tt>, or <tt>-1</tt> if there isn't one
+		*/
+		inline int winningSuccessor( void ) const;
+		
+		/**
+		Lists the nonempty groups from smallest to largest, breaking
+			ties by position.  This is the order in which
+			<tt>successors()</tt> visits them, so equal positions
+			list equivalent successors in the same order.
+		@param groups where to put the groups' indices
+		*/
+		void canonicalOrder( std::vector< unsigned int >& groups ) const;
+		
 		/**
 		Returns all possible successor states.
 		@return whatever might happen next
 		*/
-		void successors( std::vector< KaylesState >& result ) const;
+		void successors( MoveBuffer< KaylesState >& result ) const;
 		
 		/**
 		Produces a synopsis of this <tt>State</tt>'s particulars.
@@ -133,6 +186,21 @@ class KaylesState
 		*/
 		std::string str( void ) const;
 		
+		/**
+		Names the variant of the game this <tt>State</tt> belongs
+			to, which decides which others it can be compared with.
+		@return the name, including any parameters of the rules
+		*/
+		std::string variant( void ) const;
+		
+		/**
+		Identifies this <tt>State</tt> among the others of its
+			<tt>variant()</tt>.
+		@param bytes where to append a byte string that equal
+			<tt>State</tt>s, and they alone, share
+		*/
+		void encode( std::string& bytes ) const;
+		
 		/**
 		Hashes the <tt>State</tt>.
 		@pre <tt>hashCode</tt> is up to date
@@ -145,10 +213,18 @@ class KaylesState
 		Checks identity
 		@pre <tt>sorted</tt> is up to date
 		@param another comparable <tt>State</tt>
-		@return whether the turns and pin groups are the same
+		@return whether the turns are the same and the pin groups are
+			the same, regardless of their order
 		*/
 		inline bool operator==( const KaylesState& another ) const;
 		
+		/**
+		Performs assignment, which reuses our own storage.
+		@param another a source <tt>State</tt>
+		@return the destination object
+		*/
+		inline KaylesState& operator=( const KaylesState& another );
+		
 		/**
 		Determines whether two game states are subsequent.
 		@param first the original state
@@ -174,22 +250,62 @@ class KaylesState
 	
 	private: //helpers
 		/**
-		Recomputes hash code; must be called every time <tt>pins</tt>
-			is mutated.
+		Overwrites this state in place with the one resulting from
+			taking away pins from another, reusing our storage;
+			it's what the advancing constructor does.
+		@pre <tt>baseState</tt> is some other object.
+		@param baseState the state on which to base this one
+		@param position the group of pins affected
+		@param taken the number of from that group that were knocked d
+			own
+		@param target the first pin knocked down
+		*/
+		void advance( const KaylesState& baseState, unsigned int
+			position, int taken, int target );
+		
+		/**
+		Recomputes <tt>sorted</tt> and the hash code; must be called
+			every time <tt>pins</tt> is mutated.
 		*/
 		void cacheHash( void );
 };
 
 /** @brief Constructor */
 KaylesState::KaylesState( const std::vector< int >& startingPins, bool weAreUp ):
-	pins( startingPins ), ourTurn( weAreUp ), hashCode( 0 )
+	pins( startingPins.begin(), startingPins.end() ), sorted(),
+	ourTurn( weAreUp ), hashCode( 0 )
 {
 	cacheHash();
 }
 
+/** @brief Copy constructor */
+KaylesState::KaylesState( const KaylesState& original ):
+	pins( original.pins ), sorted( original.sorted ),
+	ourTurn( original.ourTurn ), hashCode( original.hashCode ) {}
+
+/** @brief Arena copy constructor */
+KaylesState::KaylesState( const KaylesState& original, Arena& arena ):
+	pins( original.pins, ArenaAllocator< int >( &arena ) ),
+	sorted( original.sorted, ArenaAllocator< int >( &arena ) ),
+	ourTurn( original.ourTurn ), hashCode( original.hashCode ) {}
+
+/** @brief Move constructor */
+KaylesState::KaylesState( KaylesState&& original ):
+	pins( std::move( original.pins ) ),
+	sorted( std::move( original.sorted ) ), ourTurn( original.ourTurn ),
+	hashCode( original.hashCode ) {}
+
 /** @brief Destructor */
 KaylesState::~KaylesState() {}
 
+/** @brief Winning moves */
+int KaylesState::winningSuccessor() const
+{
+	if( sorted.size()!=1 || sorted.front()>2 ) return -1;
+	
+	return sorted.front()-1; //the first move takes one pin, the second two
+}
+
 /** @brief Who won? */
 KaylesState::Score KaylesState::scoreGame() const
 {
@@ -228,9 +344,23 @@ int KaylesState::hash() const
 bool KaylesState::operator==( const KaylesState& another ) const
 {
 	return this->ourTurn==another.ourTurn &&
-		this->pins.size()==another.pins.size() &&
-		equal( this->pins.begin(), this->pins.end(),
-		another.pins.begin() );
+		this->sorted.size()==another.sorted.size() &&
+		equal( this->sorted.begin(), this->sorted.end(),
+		another.sorted.begin() );
+}
+
+/** @brief Assignment */
+KaylesState& KaylesState::operator=( const KaylesState& another )
+{
+	if( this!=&another ) //no funny business
+	{
+		this->pins=another.pins;
+		this->sorted=another.sorted;
+		this->ourTurn=another.ourTurn;
+		this->hashCode=another.hashCode;
+	}
+	
+	return *this;
 }
 
 #endif
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+#include "MappedFile.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+const char* const MappedFile::STDIN="-";
+
+/** @brief Constructor */
+MappedFile::MappedFile():
+	mapping( NULL ), length( 0 ), first( NULL ), last( NULL ) {}
+
+/** @brief Destructor */
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+/** @brief Map it */
+bool MappedFile::open( const char* path )
+{
+	close();
+	
+	if( strcmp( path, STDIN )==0 ) return load( STDIN_FILENO );
+	
+	int file=::open( path, O_RDONLY );
+	if( file<0 ) return false;
+	
+	bool loaded=load( file );
+	::close( file ); //the mapping keeps its own reference
+	
+	return loaded;
+}
+
+/** @brief Unmap it */
+void MappedFile::close()
+{
+	if( mapping!=NULL ) munmap( mapping, length );
+	
+	mapping=NULL;
+	length=0;
+	copy.clear();
+	first=last=NULL;
+}
+
+/** @brief Map or read it */
+bool MappedFile::load( int file )
+{
+	struct stat status;
+	
+	if( fstat( file, &status )==0 && S_ISREG( status.st_mode ) )
+	{
+		if( status.st_size==0 ) return true; //nothing to map
+		
+		void* image=mmap( NULL, status.st_size, PROT_READ, MAP_PRIVATE,
+			file, 0 );
+		
+		if( image!=MAP_FAILED )
+		{
+			madvise( image, status.st_size, MADV_SEQUENTIAL );
+			mapping=image;
+			length=status.st_size;
+			first=static_cast< const char* >( image );
+			last=first+length;
+			
+			return true;
+		}
+	}
+	
+	char buffer[1<<16];
+	ssize_t got;
+	
+	while( ( got=read( file, buffer, sizeof buffer ) )>0 )
+		copy.append( buffer, got );
+	if( got<0 ) return false;
+	
+	first=copy.data();
+	last=first+copy.size();
+	
+	return true;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+The whole of an input file, mapped into memory rather than read, so that the
+queries in it can be parsed where they lie.  Input that can't be mapped, such
+as a pipe, is instead read into memory in one go.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+class MappedFile
+{
+	private:
+		/** The mapping, if the input could be mapped */
+		void* mapping;
+		
+		/** How long the mapping is */
+		size_t length;
+		
+		/** The input, if it had to be read instead */
+		std::string copy;
+		
+		/** Where the input starts */
+		const char* first;
+		
+		/** Where the input ends */
+		const char* last;
+		
+		/**
+		Maps an open file, or else reads it.
+		@param file its descriptor, which the caller closes
+		@return whether it could do either
+		*/
+		bool load( int file );
+		
+		/**
+		Copying is unsupported.
+		*/
+		MappedFile( const MappedFile& );
+		
+		/**
+		Assignment is unsupported.
+		*/
+		MappedFile& operator=( const MappedFile& );
+	
+	public:
+		/** The path that names standard input */
+		static const char* const STDIN;
+		
+		/**
+		Makes an empty file.
+		*/
+		MappedFile( void );
+		
+		/**
+		Unmaps the file.
+		*/
+		~MappedFile( void );
+		
+		/**
+		Maps a file, forgetting any that was open.
+		@param path where it lives, or <tt>STDIN</tt>
+		@return whether it could be opened
+		*/
+		bool open( const char* path );
+		
+		/**
+		Unmaps the file, leaving us empty.
+		*/
+		void close( void );
+		
+		/**
+		Finds the start of the input.
+		@return where it starts
+		*/
+		inline const char* begin( void ) const;
+		
+		/**
+		Finds the end of the input.
+		@return just past where it ends
+		*/
+		inline const char* end( void ) const;
+};
+
+/** @brief Start */
+const char* MappedFile::begin() const
+{
+	return first;
+}
+
+/** @brief End */
+const char* MappedFile::end() const
+{
+	return last;
+}
+
+#endif
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOVEBUFFER_H
+#define MOVEBUFFER_H
+
+#include <cassert>
+#include <vector>
+
+/**
+A list of the positions that follow from one another, whose storage is kept
+around from one use to the next.  Clearing it only retires its residents, so
+that refilling it can overwrite them in place and a <tt>State</tt> that owns
+heap storage can reuse what its predecessor in the slot already allocated.
+The <tt>State</tt> must provide a <tt>public</tt> copy constructor and
+assignment operator.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+template< class State >
+class MoveBuffer
+{
+	private:
+		/** Every slot we've ever filled, retired or not */
+		std::vector< State > slots;
+		
+		/** How many of the <tt>slots</tt> are currently in use */
+		unsigned int used;
+	
+	public:
+		/**
+		Constructor.
+		*/
+		MoveBuffer( void );
+		
+		/**
+		Empties the buffer without destroying any of its residents.
+		*/
+		inline void clear( void );
+		
+		/**
+		Counts the residents.
+		@return how many there are
+		*/
+		inline unsigned int size( void ) const;
+		
+		/**
+		Retrieves a resident.
+		@pre <tt>index</tt> is in range
+		@param index which one
+		@return the resident
+		*/
+		inline const State& operator[]( unsigned int index ) const;
+		
+		/**
+		Retrieves the newest resident.
+		@pre There is at least one.
+		@return the resident
+		*/
+		inline const State& back( void ) const;
+		
+		/**
+		Adds a copy of a position, assigning it over a retired
+			resident if there is one.
+		@param state the position
+		*/
+		void push_back( const State& state );
+		
+		/**
+		Adds a resident for the caller to overwrite in place, which is
+			a retired one if there is one and a copy of
+			<tt>parent</tt> otherwise.
+		@param parent the position whose successor is to be stored
+		@return the new resident, whose contents are meaningless
+		*/
+		State& reuse( const State& parent );
+};
+
+/** @brief Retire everyone */
+template< class State >
+void MoveBuffer< State >::clear()
+{
+	used=0;
+}
+
+/** @brief How many? */
+template< class State >
+unsigned int MoveBuffer< State >::size() const
+{
+	return used;
+}
+
+/** @brief Lookup */
+template< class State >
+const State& MoveBuffer< State >::operator[]( unsigned int index ) const
+{
+	assert( index<used );
+	
+	return slots[index];
+}
+
+/** @brief Latest */
+template< class State >
+const State& MoveBuffer< State >::back() const
+{
+	assert( used>0 );
+	
+	return slots[used-1];
+}
+
+#include "MoveBuffer.t.h"
+
+#endif
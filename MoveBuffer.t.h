@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+//included from "MoveBuffer.h"
+#include <cassert>
+#include <vector>
+
+/** @brief Constructor */
+template< class State >
+MoveBuffer< State >::MoveBuffer():
+	slots(), used( 0 ) {}
+
+/** @brief Add one */
+template< class State >
+void MoveBuffer< State >::push_back( const State& state )
+{
+	if( used<slots.size() ) slots[used]=state; //reclaim a retiree
+	else slots.push_back( state );
+	++used;
+}
+
+/** @brief Make room for one */
+template< class State >
+State& MoveBuffer< State >::reuse( const State& parent )
+{
+	if( used==slots.size() ) slots.push_back( parent ); //nobody to
+		//reclaim, so start out the same size as our parent
+	
+	return slots[used++];
+}
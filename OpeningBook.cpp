@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+#include "OpeningBook.h"
+using namespace std;
+
+const char* const OpeningBook::TITLE="opening book";
+
+/** @brief Open */
+bool OpeningBook::open( const char* path )
+{
+	return pages.open( path, TITLE );
+}
+
+/** @brief Write */
+bool OpeningBook::write( const char* path, const vector< Entry >& entries )
+{
+	return SolutionDatabase< Page >::save( path, TITLE, entries );
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENINGBOOK_H
+#define OPENINGBOOK_H
+
+#include "MoveBuffer.h"
+#include "SolutionDatabase.h"
+#include "StateTraits.h"
+#include <string>
+#include <vector>
+
+/**
+The best move from each of the positions near the start of some games, worked
+out ahead of time by the <tt>openings</tt> tool, so that a program asked about
+one of them can answer without building a <tt>Solver</tt> at all.  It's a
+<tt>SolutionDatabase</tt> whose keys name the game's variant as well as the
+position, which lets one file serve several games, and whose values are the
+index of the move among the position's <tt>successors()</tt>.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+class OpeningBook
+{
+	public:
+		/** The index of a position's best move */
+		typedef unsigned short Page;
+		
+		/** A position's key and its best move, as handed to
+			<tt>write()</tt> */
+		typedef SolutionDatabase< Page >::Entry Entry;
+		
+		/** What an opening book calls its variant, since it spans
+			them */
+		static const char* const TITLE;
+		
+		/**
+		Opens an opening book.
+		@param path where it lives
+		@return whether it exists and is one
+		*/
+		bool open( const char* path );
+		
+		/**
+		Checks whether we have an opening book open.
+		@return whether we do
+		*/
+		inline bool isOpen( void ) const;
+		
+		/**
+		Looks up a position's best move.
+		@param position the position
+		@param outcome where to put the position after the move,
+			which is untouched if the book doesn't know it
+		@return whether the book knew it
+		*/
+		template< typename State, class Traits=StateTraits< State > > bool
+			move( const State& position, State& outcome ) const;
+		
+		/**
+		Keys a position for an opening book.
+		@param position the position
+		@param bytes where to put its key
+		*/
+		template< typename State, class Traits=StateTraits< State > >
+			static void key( const State& position, std::string&
+			bytes );
+		
+		/**
+		Writes an opening book, replacing any file already there.
+		@param path where to put it
+		@param entries its positions' keys and best moves
+		@return whether it could
+		*/
+		static bool write( const char* path, const std::vector< Entry >&
+			entries );
+	
+	private:
+		/** Where the moves are */
+		SolutionDatabase< Page > pages;
+};
+
+/** @brief Check */
+bool OpeningBook::isOpen() const
+{
+	return pages.isOpen();
+}
+
+#include "OpeningBook.t.h"
+
+#endif
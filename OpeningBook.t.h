@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+//included from "OpeningBook.h"
+
+/** @brief Look it up */
+template< typename State, class Traits >
+bool OpeningBook::move( const State& position, State& outcome ) const
+{
+	if( !pages.isOpen() ) return false;
+	
+	std::string bytes;
+	
+	key< State, Traits >( position, bytes );
+	
+	const Page* page=pages.find( bytes );
+	
+	if( page==NULL ) return false;
+	
+	MoveBuffer< State > successors;
+	
+	Traits::successors( position, successors );
+	if( *page>=successors.size() ) return false; //not this build's book
+	
+	outcome=successors[*page];
+	
+	return true;
+}
+
+/** @brief Name it */
+template< typename State, class Traits >
+void OpeningBook::key( const State& position, std::string& bytes )
+{
+	bytes=position.variant();
+	bytes+='\0'; //no variant's name has one
+	Traits::identify( position, bytes );
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHAREDHASHTABLE_H
+#define SHAREDHASHTABLE_H
+
+#include "HashTable.h"
+#include <algorithm>
+#include <mutex>
+#include <stdint.h>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+/**
+A <tt>HashTable</tt> that may be used from many threads at once.  It is split
+into independently locked (and independently growing) shards, each of which
+owns the keys whose hash codes select it, so threads working on different
+parts of the table seldom contend.  Because another thread may change a shard
+at any time, lookups hand back a copy of the value rather than a reference to
+it.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+template< class Key, class Value >
+class SharedHashTable
+{
+	private:
+		/** How many bits of the hash code pick the shard */
+		static const int SHARD_BITS=6;
+		
+		/** The number of shards */
+		static const int SHARDS=1<<SHARD_BITS;
+		
+		/** The fewest bytes a limit must be before the shards split up
+			the work of allocating and clearing their arrays */
+		static const uint64_t PARALLEL_LIMIT=uint64_t( 1 )<<28;
+		
+		/**
+		One independently locked part of the table.
+		*/
+		struct Shard
+		{
+			/** Protects <tt>table</tt> */
+			std::mutex lock;
+			
+			/** The shard's entries */
+			HashTable< Key, Value > table;
+		};
+		
+		/** The shards */
+		Shard shards[SHARDS];
+		
+		/**
+		Decides which shard owns a key.
+		@param key the key in question
+		@return the owning shard's index
+		*/
+		inline static int shardOf( const Key& key );
+		
+		/**
+		Limits every so many shards, so that several threads can share
+			the work and each shard's arrays are first touched, and
+			so placed in memory, by whichever one allocated them.
+		@param bytes each shard's share of the limit
+		@param first the first shard to limit
+		@param stride how many shards to skip to the next one
+		@param fitted where to record whether each shard got its share
+		*/
+		void limitShards( uint64_t bytes, int first, int stride, bool*
+			fitted );
+		
+		/**
+		Copying is unsupported.
+		*/
+		SharedHashTable( const SharedHashTable& );
+		
+		/**
+		Assignment is unsupported.
+		*/
+		SharedHashTable& operator=( const SharedHashTable& );
+	
+	public:
+		/**
+		Remembers where a lookup left off, along with a copy of what
+			it found.
+		*/
+		class Locator
+		{
+			friend class SharedHashTable;
+			
+			private:
+				/** The shard's own directions */
+				typename HashTable< Key, Value >::Locator inner;
+				
+				/** The value found, if any */
+				Value found;
+		};
+		
+		/**
+		Create a <tt>SharedHashTable</tt>.
+		*/
+		SharedHashTable( void );
+		
+		/**
+		Looks up a key using a single probe sequence.
+		@param key the key for which to search
+		@param where records where the search ended, for use by a
+			later call to <tt>store()</tt>
+		@return a copy of the table's value for that key, belonging to
+			<tt>where</tt>, or <tt>NULL</tt> if it isn't present
+		*/
+		Value* find( const Key& key, Locator& where );
+		
+		/**
+		Associates a value with a key, overwriting any value already
+			present.
+		@param where the result of looking up this <tt>key</tt>
+		@param key the keying object
+		@param value the referred object
+		@param worth how much the entry is worth keeping, which only
+			matters once a <tt>limit()</tt>ed table is full
+		@return whether the operation succeeded
+		*/
+		bool store( Locator& where, const Key& key, const Value& value,
+			unsigned char worth=0 );
+		
+		/**
+		Determines the current number of objects stored in the table.
+		*/
+		int size( void );
+		
+		/**
+		Calls <tt>visitor( key, value )</tt> on each entry in turn,
+			holding each shard's lock while visiting it.
+		@param visitor the function object to call
+		*/
+		template< class Visitor > void visit( Visitor& visitor );
+		
+		/**
+		Removes every entry for which <tt>doomed( key, value )</tt>
+			is <tt>true</tt>, as <tt>HashTable::sweep()</tt> does,
+			holding each shard's lock while sweeping it.
+		@param doomed the function object to ask
+		@return how many entries were removed
+		*/
+		template< class Filter > uint64_t sweep( const Filter& doomed );
+		
+		/**
+		Empties the table of all its entries.
+		*/
+		void purge( void );
+		
+		/**
+		Empties the table and divides a fixed number of bytes among
+			its shards, as <tt>HashTable::limit()</tt> does, on as
+			many threads as there are cores if the shards are big,
+			so that they're scattered across those cores' memory.
+		@param bytes the most memory the shards' arrays may occupy
+			between them, or <tt>0</tt> for no limit
+		@return whether every shard could get its share
+		*/
+		bool limit( uint64_t bytes );
+		
+		/**
+		Adds what the shards have been through to a running total,
+			as <tt>HashTable::tally()</tt> does, holding each
+			shard's lock while counting it.
+		@param into the total
+		*/
+		void tally( TableStatistics& into );
+};
+
+#include "SharedHashTable.t.h"
+
+#endif
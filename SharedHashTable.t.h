@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+//included from "SharedHashTable.h"
+
+/** @brief Constructor */
+template< class Key, class Value >
+SharedHashTable< Key, Value >::SharedHashTable() {}
+
+/** @brief Whose is it? */
+template< class Key, class Value >
+int SharedHashTable< Key, Value >::shardOf( const Key& key )
+{
+	//each shard's HashTable indexes by the low bits of its own mixing of
+	//the hash code, so use the high bits of a different one here:
+	unsigned int scattered=key.hash();
+	scattered*=0x9e3779b1U;
+	
+	return scattered>>( 32-SHARD_BITS );
+}
+
+/** @brief Lookup */
+template< class Key, class Value >
+Value* SharedHashTable< Key, Value >::find( const Key& key, Locator& where )
+{
+	Shard& shard=shards[shardOf( key )];
+	std::lock_guard< std::mutex > guard( shard.lock );
+	Value* inside=shard.table.find( key, where.inner );
+	
+	if( inside==NULL ) return NULL;
+	
+	where.found=*inside; //it could change once we let go of the lock
+	
+	return &where.found;
+}
+
+/** @brief Insert or overwrite */
+template< class Key, class Value >
+bool SharedHashTable< Key, Value >::store( Locator& where, const Key& key,
+	const Value& value, unsigned char worth )
+{
+	Shard& shard=shards[shardOf( key )];
+	std::lock_guard< std::mutex > guard( shard.lock );
+	
+	return shard.table.store( where.inner, key, value, worth );
+}
+
+/** @brief Current *utilized* size */
+template< class Key, class Value >
+int SharedHashTable< Key, Value >::size()
+{
+	int total=0;
+	
+	for( int shard=0; shard<SHARDS; ++shard )
+	{
+		std::lock_guard< std::mutex > guard( shards[shard].lock );
+		
+		total+=shards[shard].table.size();
+	}
+	
+	return total;
+}
+
+/** @brief Report */
+template< class Key, class Value >
+void SharedHashTable< Key, Value >::tally( TableStatistics& into )
+{
+	for( int shard=0; shard<SHARDS; ++shard )
+	{
+		std::lock_guard< std::mutex > guard( shards[shard].lock );
+		
+		shards[shard].table.tally( into );
+	}
+}
+
+/** @brief Tour */
+template< class Key, class Value >
+template< class Visitor >
+void SharedHashTable< Key, Value >::visit( Visitor& visitor )
+{
+	for( int shard=0; shard<SHARDS; ++shard )
+	{
+		std::lock_guard< std::mutex > guard( shards[shard].lock );
+		
+		shards[shard].table.visit( visitor );
+	}
+}
+
+/** @brief Weed out */
+template< class Key, class Value >
+template< class Filter >
+uint64_t SharedHashTable< Key, Value >::sweep( const Filter& doomed )
+{
+	uint64_t removed=0;
+	
+	for( int shard=0; shard<SHARDS; ++shard )
+	{
+		std::lock_guard< std::mutex > guard( shards[shard].lock );
+		
+		removed+=shards[shard].table.sweep( doomed );
+	}
+	
+	return removed;
+}
+
+/** @brief Hose it all */
+template< class Key, class Value >
+void SharedHashTable< Key, Value >::purge()
+{
+	for( int shard=0; shard<SHARDS; ++shard )
+	{
+		std::lock_guard< std::mutex > guard( shards[shard].lock );
+		
+		shards[shard].table.purge();
+	}
+}
+
+/** @brief Budget */
+template< class Key, class Value >
+bool SharedHashTable< Key, Value >::limit( uint64_t bytes )
+{
+	bool fitted[SHARDS];
+	std::vector< std::thread > helpers;
+	int threads=1;
+	
+	if( bytes>=PARALLEL_LIMIT )
+		threads=int( std::max( 1U, std::min( std::thread::
+			hardware_concurrency(), unsigned( SHARDS ) ) ) );
+	
+	for( int helper=1; helper<threads; ++helper )
+		try
+		{
+			helpers.push_back( std::thread( &SharedHashTable::limitShards,
+				this, bytes/SHARDS, helper, threads, fitted ) );
+		}
+		catch( const std::system_error& noThreads ) //do it ourselves
+		{
+			limitShards( bytes/SHARDS, helper, threads, fitted );
+		}
+	limitShards( bytes/SHARDS, 0, threads, fitted );
+	for( size_t helper=0; helper<helpers.size(); ++helper )
+		helpers[helper].join();
+	
+	bool fits=true;
+	
+	for( int shard=0; shard<SHARDS; ++shard )
+		if( !fitted[shard] ) fits=false;
+	
+	return fits;
+}
+
+/** @brief Budget some of the shards */
+template< class Key, class Value >
+void SharedHashTable< Key, Value >::limitShards( uint64_t bytes, int first,
+	int stride, bool* fitted )
+{
+	for( int shard=first; shard<SHARDS; shard+=stride )
+	{
+		std::lock_guard< std::mutex > guard( shards[shard].lock );
+		
+		fitted[shard]=shards[shard].table.limit( bytes );
+	}
+}
@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOLUTIONDATABASE_H
+#define SOLUTIONDATABASE_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+A read-only table of values keyed by byte strings, which lives in a file and
+is mapped into memory rather than read, so opening even a large one costs
+next to nothing and the pages that are never probed are never loaded.  The
+values must be trivially copyable, since they are stored as they lie in
+memory.
+
+A file starts with a versioned header, which records how large an entry is
+and which variant of the game (say, the board's dimensions) the keys
+describe, so that a file is only ever opened for positions it can answer.
+After the header comes an array of fixed-size entries, each holding the
+value, a 64-bit fingerprint of its key, and where its key ends in the blob of
+keys that follows; the entries are sorted by fingerprint, so a lookup is a
+binary search.  Everything is in the byte order of the machine that wrote it,
+and a file from a machine of the other order fails the version check.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+template< class Value >
+class SolutionDatabase
+{
+	public:
+		/** The format we read and write */
+		static const uint32_t VERSION=1;
+		
+		/** A key and its value, as handed to <tt>save()</tt> */
+		typedef std::pair< std::string, Value > Entry;
+	
+	private:
+		/** What starts every file, NUL included */
+		static const char MAGIC[8];
+		
+		/** The start of every file */
+		struct Header
+		{
+			/** Identifies the format */
+			char magic[8];
+			
+			/** Which revision of the format */
+			uint32_t version;
+			
+			/** How large a <tt>Slot</tt> is */
+			uint32_t slotSize;
+			
+			/** How many entries there are */
+			uint64_t entries;
+			
+			/** How long the variant's name is, which follows,
+				padded to a multiple of eight bytes */
+			uint64_t variantLength;
+			
+			/** How long the blob of keys is, which comes last */
+			uint64_t keysLength;
+		};
+		
+		/** One entry */
+		struct Slot
+		{
+			/** The key's <tt>fingerprint()</tt> */
+			uint64_t fingerprint;
+			
+			/** Where the key ends in the blob of keys, which is
+				where the next one starts */
+			uint32_t keyEnd;
+			
+			/** What the key maps to */
+			Value value;
+		};
+		
+		/** The whole file, if it's open */
+		void* mapping;
+		
+		/** How long the file is */
+		size_t length;
+		
+		/** The file's entries */
+		const Slot* slots;
+		
+		/** How many entries there are */
+		uint64_t count;
+		
+		/** The file's blob of keys */
+		const char* keys;
+		
+		/**
+		Rounds a length up to a boundary that keeps the entries
+			aligned.
+		@param bytes the length
+		@return the padded length
+		*/
+		static inline uint64_t padded( uint64_t bytes );
+		
+		/**
+		Orders entries by their keys' fingerprints, and then by the
+			keys themselves.
+		*/
+		class ByFingerprint
+		{
+			private:
+				/** The entries being sorted */
+				const std::vector< Entry >& entries;
+				
+				/** Their keys' fingerprints */
+				const std::vector< uint64_t >& prints;
+			
+			public:
+				/**
+				Compares within a particular list.
+				@param list the entries
+				@param fingerprints their keys' fingerprints
+				*/
+				ByFingerprint( const std::vector< Entry >& list,
+					const std::vector< uint64_t >&
+					fingerprints );
+				
+				/**
+				Compares two entries.
+				@param first the index of one entry
+				@param second the index of another
+				@return whether <tt>first</tt> goes before
+					<tt>second</tt>
+				*/
+				bool operator()( size_t first, size_t second )
+					const;
+		};
+		
+		/**
+		Copying is unsupported.
+		*/
+		SolutionDatabase( const SolutionDatabase& );
+		
+		/**
+		Assignment is unsupported.
+		*/
+		SolutionDatabase& operator=( const SolutionDatabase& );
+	
+	public:
+		/**
+		Creates a database with nothing open.
+		*/
+		SolutionDatabase( void );
+		
+		/**
+		Closes the database.
+		*/
+		~SolutionDatabase( void );
+		
+		/**
+		Maps a file written by <tt>save()</tt>, closing whatever was
+			open before.
+		@param path where the file is
+		@param variant which variant of the game we're playing
+		@return whether the file was readable, in our format, and for
+			the same variant, without all of which nothing is open
+		*/
+		bool open( const char* path, const std::string& variant );
+		
+		/**
+		Maps a file written by <tt>save()</tt>, as the other
+			<tt>open()</tt> does, provided that
+			<tt>sound( value )</tt> is <tt>true</tt> of every
+			value in it.
+		@param path where the file is
+		@param variant which variant of the game we're playing
+		@param sound the function object to ask
+		@return whether the file was readable, in our format, for
+			the same variant, and sound throughout, without all of
+			which nothing is open
+		*/
+		template< class Filter > bool open( const char* path, const
+			std::string& variant, const Filter& sound );
+		
+		/**
+		Unmaps the file, if there is one.
+		*/
+		void close( void );
+		
+		/**
+		Reports whether there's a file open.
+		@return whether there is
+		*/
+		inline bool isOpen( void ) const;
+		
+		/**
+		Counts the entries.
+		@return how many there are, or <tt>0</tt> if nothing's open
+		*/
+		inline uint64_t size( void ) const;
+		
+		/**
+		Looks up a key.
+		@param key the key's bytes
+		@return its value, which remains valid until the database is
+			closed, or <tt>NULL</tt> if the key is absent
+		*/
+		const Value* find( const std::string& key ) const;
+		
+		/**
+		Calls <tt>visitor( key, value )</tt> on each entry in turn,
+			where <tt>key</tt> is a <tt>std::string</tt>.
+		@param visitor the function object to call
+		*/
+		template< class Visitor > void visit( Visitor& visitor ) const;
+		
+		/**
+		Hashes a key, the same way on every machine.
+		@param key the key's bytes
+		@return its 64-bit FNV-1a hash
+		*/
+		static uint64_t fingerprint( const std::string& key );
+		
+		/**
+		Writes a file that <tt>open()</tt> can map, replacing any
+			existing one only once the new one is complete.
+		@param path where to put the file
+		@param variant which variant of the game the keys describe
+		@param entries what to store, where later entries with the
+			same key as an earlier one are dropped
+		@return whether the file was written
+		*/
+		static bool save( const char* path, const std::string& variant,
+			const std::vector< Entry >& entries );
+};
+
+/** @brief Is there a file? */
+template< class Value >
+bool SolutionDatabase< Value >::isOpen() const
+{
+	return mapping!=NULL;
+}
+
+/** @brief How many? */
+template< class Value >
+uint64_t SolutionDatabase< Value >::size() const
+{
+	return count;
+}
+
+/** @brief Align */
+template< class Value >
+uint64_t SolutionDatabase< Value >::padded( uint64_t bytes )
+{
+	return ( bytes+7 )&~uint64_t( 7 );
+}
+
+#include "SolutionDatabase.t.h"
+
+#endif
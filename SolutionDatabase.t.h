@@ -0,0 +1,299 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+//included from "SolutionDatabase.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+
+template< class Value >
+const char SolutionDatabase< Value >::MAGIC[8]={ 'C', 'S', '4', 'S', 'O', 'L',
+	'N', '\0' };
+
+/** @brief Constructor */
+template< class Value >
+SolutionDatabase< Value >::SolutionDatabase():
+	mapping( NULL ), length( 0 ), slots( NULL ), count( 0 ), keys( NULL )
+{
+	static_assert( std::is_trivially_copyable< Value >::value,
+		"values are stored as they lie in memory" );
+}
+
+/** @brief Destructor */
+template< class Value >
+SolutionDatabase< Value >::~SolutionDatabase()
+{
+	close();
+}
+
+/** @brief Constructor */
+template< class Value >
+SolutionDatabase< Value >::ByFingerprint::ByFingerprint( const std::vector<
+	Entry >& list, const std::vector< uint64_t >& fingerprints ):
+	entries( list ), prints( fingerprints ) {}
+
+/** @brief Which first? */
+template< class Value >
+bool SolutionDatabase< Value >::ByFingerprint::operator()( size_t first,
+	size_t second ) const
+{
+	if( prints[first]!=prints[second] )
+		return prints[first]<prints[second];
+	else //almost never
+		return entries[first].first<entries[second].first;
+}
+
+/** @brief Map it in */
+template< class Value >
+bool SolutionDatabase< Value >::open( const char* path, const std::string&
+	variant )
+{
+	close();
+	
+	int file=::open( path, O_RDONLY );
+	struct stat status;
+	if( file<0 ) return false;
+	if( fstat( file, &status )!=0 || status.st_size<off_t( sizeof( Header
+		) ) )
+	{
+		::close( file );
+		return false;
+	}
+	
+	void* image=mmap( NULL, status.st_size, PROT_READ, MAP_PRIVATE, file,
+		0 );
+	::close( file ); //the mapping keeps its own reference
+	if( image==MAP_FAILED ) return false;
+	
+	//make sure it's what we expect, and all there:
+	const Header& header=*static_cast< const Header* >( image );
+	const char* base=static_cast< const char* >( image );
+	uint64_t size=status.st_size;
+	if( memcmp( header.magic, MAGIC, sizeof MAGIC )!=0 ||
+		header.version!=VERSION || header.slotSize!=sizeof( Slot ) ||
+		header.variantLength!=variant.size() || header.entries>size/
+		sizeof( Slot ) || size!=sizeof( Header )+padded(
+		header.variantLength )+header.entries*sizeof( Slot )+
+		header.keysLength || header.keysLength>size ||
+		variant.compare( 0, variant.size(),
+		base+sizeof( Header ), header.variantLength )!=0 )
+	{
+		munmap( image, status.st_size );
+		return false;
+	}
+	
+	mapping=image;
+	length=status.st_size;
+	count=header.entries;
+	slots=reinterpret_cast< const Slot* >( base+sizeof( Header )+padded(
+		header.variantLength ) );
+	keys=reinterpret_cast< const char* >( slots+count );
+	
+	//every key must lie within the blob, after the one before it, and the
+	//fingerprints must be sorted for find() to search them:
+	for( uint64_t entry=0; entry<count; ++entry )
+		if( slots[entry].keyEnd>header.keysLength || ( entry>0 && (
+			slots[entry].keyEnd<slots[entry-1].keyEnd ||
+			slots[entry].fingerprint<slots[entry-1].fingerprint ) ) )
+		{
+			close();
+			return false;
+		}
+	if( count>0 && slots[count-1].keyEnd!=header.keysLength ) //corrupt
+	{
+		close();
+		return false;
+	}
+	
+	return true;
+}
+
+/** @brief Map it in, carefully */
+template< class Value >
+template< class Filter >
+bool SolutionDatabase< Value >::open( const char* path, const std::string&
+	variant, const Filter& sound )
+{
+	if( !open( path, variant ) ) return false;
+	
+	for( uint64_t entry=0; entry<count; ++entry )
+		if( !sound( slots[entry].value ) )
+		{
+			close();
+			return false;
+		}
+	
+	return true;
+}
+
+/** @brief Unmap it */
+template< class Value >
+void SolutionDatabase< Value >::close()
+{
+	if( mapping!=NULL ) munmap( mapping, length );
+	
+	mapping=NULL;
+	length=0;
+	slots=NULL;
+	count=0;
+	keys=NULL;
+}
+
+/** @brief Look it up */
+template< class Value >
+const Value* SolutionDatabase< Value >::find( const std::string& key ) const
+{
+	uint64_t print=fingerprint( key );
+	uint64_t low=0, high=count;
+	
+	while( low<high ) //find the first entry with this fingerprint
+	{
+		uint64_t middle=low+( high-low )/2;
+		
+		if( slots[middle].fingerprint<print )
+			low=middle+1;
+		else
+			high=middle;
+	}
+	
+	for( ; low<count && slots[low].fingerprint==print; ++low )
+	{
+		uint32_t start=low==0 ? 0 : slots[low-1].keyEnd;
+		
+		if( slots[low].keyEnd-start==key.size() && memcmp( keys+start,
+			key.data(), key.size() )==0 )
+			return &slots[low].value;
+	}
+	
+	return NULL;
+}
+
+/** @brief Tour */
+template< class Value >
+template< class Visitor >
+void SolutionDatabase< Value >::visit( Visitor& visitor ) const
+{
+	std::string key;
+	
+	for( uint64_t entry=0; entry<count; ++entry )
+	{
+		uint32_t start=entry==0 ? 0 : slots[entry-1].keyEnd;
+		
+		key.assign( keys+start, slots[entry].keyEnd-start );
+		visitor( key, slots[entry].value );
+	}
+}
+
+/** @brief FNV-1a */
+template< class Value >
+uint64_t SolutionDatabase< Value >::fingerprint( const std::string& key )
+{
+	uint64_t hash=0xcbf29ce484222325ULL; //the offset basis
+	
+	for( std::string::const_iterator byte=key.begin(); byte!=key.end();
+		++byte )
+	{
+		hash^=static_cast< unsigned char >( *byte );
+		hash*=0x100000001b3ULL; //the prime
+	}
+	
+	return hash;
+}
+
+/** @brief Write it out */
+template< class Value >
+bool SolutionDatabase< Value >::save( const char* path, const std::string&
+	variant, const std::vector< Entry >& entries )
+{
+	//line the entries up by fingerprint, keeping only the first of each
+	//key:
+	std::vector< uint64_t > prints;
+	std::vector< size_t > order;
+	prints.reserve( entries.size() );
+	order.reserve( entries.size() );
+	for( size_t entry=0; entry<entries.size(); ++entry )
+	{
+		prints.push_back( fingerprint( entries[entry].first ) );
+		order.push_back( entry );
+	}
+	std::stable_sort( order.begin(), order.end(), ByFingerprint( entries,
+		prints ) );
+	
+	std::vector< size_t > kept;
+	uint64_t keysLength=0;
+	kept.reserve( order.size() );
+	for( std::vector< size_t >::const_iterator entry=order.begin();
+		entry!=order.end(); ++entry )
+		if( kept.empty() || prints[kept.back()]!=prints[*entry] ||
+			entries[kept.back()].first!=entries[*entry].first )
+		{
+			kept.push_back( *entry );
+			keysLength+=entries[*entry].first.size();
+		}
+	if( keysLength>uint32_t( -1 ) ) return false; //too big for our offsets
+	
+	//write to the side, so that nobody maps a half-written file:
+	std::string temporary=std::string( path )+".partial";
+	std::ofstream out( temporary.c_str(), std::ios_base::binary |
+		std::ios_base::trunc );
+	Header header;
+	memcpy( header.magic, MAGIC, sizeof MAGIC );
+	header.version=VERSION;
+	header.slotSize=sizeof( Slot );
+	header.entries=kept.size();
+	header.variantLength=variant.size();
+	header.keysLength=keysLength;
+	out.write( reinterpret_cast< const char* >( &header ), sizeof header
+		);
+	out.write( variant.data(), variant.size() );
+	out.write( "\0\0\0\0\0\0\0", padded( variant.size() )-variant.size()
+		);
+	
+	uint32_t keyEnd=0;
+	for( std::vector< size_t >::const_iterator entry=kept.begin(); entry!=
+		kept.end(); ++entry )
+	{
+		Slot slot;
+		memset( static_cast< void* >( &slot ), 0, sizeof slot ); //no
+			//stray bytes in the padding
+		slot.fingerprint=prints[*entry];
+		keyEnd+=entries[*entry].first.size();
+		slot.keyEnd=keyEnd;
+		slot.value=entries[*entry].second;
+		out.write( reinterpret_cast< const char* >( &slot ), sizeof slot
+			);
+	}
+	for( std::vector< size_t >::const_iterator entry=kept.begin(); entry!=
+		kept.end(); ++entry )
+		out.write( entries[*entry].first.data(), entries[*entry].first.
+			size() );
+	
+	out.close();
+	if( !out || std::rename( temporary.c_str(), path )!=0 )
+	{
+		std::remove( temporary.c_str() );
+		return false;
+	}
+	
+	return true;
+}
@@ -17,76 +17,1377 @@
 #ifndef SOLVER_H
 #define SOLVER_H
 
+#include "Cluster.h"
+#include "DirectTable.h"
+#include "Encoding.h"
 #include "HashTable.h"
+#include "MoveBuffer.h"
+#include "SharedHashTable.h"
+#include "SolutionDatabase.h"
+#include "SolverStatistics.h"
+#include "StateTraits.h"
+#include "WorkerPool.h"
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 /**
-A game tree traverser for two-player, perfect knowledge contests.
+A game tree traverser for two-player, perfect knowledge contests.  The
+<tt>State::Score</tt> type must provide <tt>LOSS</tt> and <tt>VICTORY</tt> as
+its least and greatest values.
+
+What a <tt>Solver</tt> learns may be kept from one run to the next in a
+<tt>SolutionDatabase</tt>, provided the <tt>State</tt> names the variant of the
+game it belongs to with <tt>std::string variant(void) const</tt> and, unless
+it provides an <tt>index()</tt>, identifies itself within that variant by
+appending a byte string to its argument with <tt>void encode(std::string&)
+const</tt>, such that equal positions (and only they) encode the same way.
+
+Everything about the <tt>State</tt> that can be settled at compile time comes
+from the <tt>Traits</tt>, which are the <tt>State</tt>'s own
+<tt>StateTraits</tt> unless a program asks for different ones: what it
+provides, and the policies that follow from that, among them whether to prune,
+whether to keep a stack of our own, and how to remember and generate moves.
+Each game thus gets a <tt>Solver</tt> of its own, whose search never asks at
+run time which of those policies it follows.
+
+A search may also be spread across processes on several machines, which
+<tt>distribute()</tt> sets up: one leads, searching near the root and handing
+the subtrees below out to the others, who share one memo partitioned between
+them.  Positions travel by their <tt>encode()</tt>, so only a <tt>State</tt>
+that can <tt>decode()</tt> them can be searched this way.
 
 @author Sol Boucher <slb1566@rit.edu>
 */
-template< typename State > class Solver
+template< typename State, class Traits=StateTraits< State > > class Solver
 {
-	private:
-		/** The current game state */
-		State current;
+	public: //configuration
+		/** How many plies below the root a parallel search splits
+			by default */
+		static const unsigned int DEFAULT_SPLIT_DEPTH=2;
+		
+		/** The heuristics we know for ordering moves, which may be
+			combined; they refine whatever order the <tt>State</tt>'s
+			<tt>orderedSuccessors</tt> hook suggests, but never
+			displace that order's first move except with the
+			<tt>STORED_MOVE</tt> */
+		enum Ordering
+		{
+			STORED_MOVE=1, //what the memo chose last time, first
+			KILLER_MOVES=2, //what refuted a cousin, next, if the
+				//State has a hook to rank its own moves
+			HISTORY_SCORES=4 //what has refuted the most, if the
+				//State has no hook to rank its own moves
+		};
+		
+		/** All of the move ordering heuristics at once */
+		static const unsigned int ALL_ORDERINGS=STORED_MOVE|KILLER_MOVES|
+			HISTORY_SCORES;
+	
+	private: //types
+		/** What a <tt>Record</tt>'s score says about the true score */
+		enum Bound
+		{
+			EXACT, //the true score
+			LOWER, //the true score is at least this good
+			UPPER //the true score is at most this good
+		};
 		
 		/**
-		Combines a state and its score.
+		Summarizes what we've determined about a position, without
+			storing any of the positions that follow from it.
 		*/
-		struct StatePlusScore
+		struct Record
 		{
-			/** The state */
-			State config;
+			/** The position's score, a <tt>State::Score</tt> */
+			signed char value;
+			
+			/** How far to trust <tt>value</tt>, a <tt>Bound</tt> */
+			unsigned char bound;
 			
-			/** The score */
-			typename State::Score value;
+			/** Which of the position's <tt>successors()</tt>
+				the player to move should choose, or
+				<tt>NO_MOVE</tt> if the record came out of a
+				<tt>DirectTable</tt>'s array, which doesn't keep
+				it */
+			unsigned short choice;
+			
+			/** How many distinct packed records there are,
+				counting the code <tt>0</tt> that none uses */
+			static const unsigned int CODES=3*( State::VICTORY-
+				State::LOSS+1 )+1;
+			
+			/** How many bits <tt>pack()</tt> needs */
+			static const unsigned int PACKED_BITS=CODES<=4 ? 2 :
+				CODES<=16 ? 4 : CODES<=256 ? 8 : 16;
 			
 			/**
 			Constructor; assumes that the <tt>State::Score</tt>'s
 				default (zero) value indicates a balanced (or
 				at least undetermined-as-yet) match.
-			@param initial the starting <tt>State</tt>
 			*/
-			StatePlusScore( State initial );
+			Record( void );
 			
 			/**
-			Checks whether the player whose turn this is would
-				prefer to have the <tt>alternative</tt> score.
-				Assumes that higher scores are better for the
-				computer player, regardless of who's up.
-			@param alternative the other score we're offering the
-				player
-			@return whether our <tt>State<tt>'s player prefers
-				the score it's been offered
+			Unpacking constructor, which leaves the choice at
+				<tt>NO_MOVE</tt>.
+			@param packed what <tt>pack()</tt> returned
 			*/
-			bool prefersScore( typename State::Score alternative
-				) const;
+			explicit Record( unsigned int packed );
+			
+			/**
+			Packs the score and bound (but not the choice) into
+				a few bits for a <tt>DirectTable</tt>.
+			@return a code from <tt>1</tt> to <tt>CODES</tt>-1
+			*/
+			unsigned int pack( void ) const;
+		};
+		
+		/** The most successors a position may have */
+		static const unsigned int MAX_SUCCESSORS=65535;
+		
+		/** Marks the lack of a move, even in a <tt>Record</tt> */
+		static const unsigned int NO_MOVE=MAX_SUCCESSORS;
+		
+		/** Picks an overload at compile time */
+		template< bool Which > struct Choice {};
+		
+		/** Previously-determined states, for a single thread, which are
+			indexed directly if the <tt>Traits</tt> say to */
+		typedef typename std::conditional< Traits::direct,
+			DirectTable< State, Record >, HashTable< State, Record >
+			>::type Memo;
+		
+		/** Previously-determined states, for many threads at once */
+		typedef SharedHashTable< State, Record > SharedMemo;
+		
+		/** States determined by earlier runs */
+		typedef SolutionDatabase< Record > Library;
+		
+		/**
+		Gathers the memos' entries for a <tt>Library</tt>, keying
+			each position as <tt>Traits::identify()</tt> does.
+		*/
+		class Collector
+		{
+			private:
+				/** Where to put them */
+				std::vector< typename Library::Entry >& entries;
+			
+			public:
+				/**
+				Gathers into a particular list.
+				@param list where to put the entries
+				*/
+				explicit Collector( std::vector< typename
+					Library::Entry >& list );
+				
+				/**
+				Gathers an entry from a memo that stores
+					positions.
+				@param key the position
+				@param value what we know about it
+				*/
+				void operator()( const State& key, const Record&
+					value );
+				
+				/**
+				Gathers an entry from a memo that stores indices.
+				@param index the position's <tt>index()</tt>
+				@param value what we know about it
+				*/
+				void operator()( uint64_t index, const Record& value
+					);
+				
+				/**
+				Gathers an entry from another <tt>Library</tt>.
+				@param key the position's bytes
+				@param value what we know about it
+				*/
+				void operator()( const std::string& key, const
+					Record& value );
+		};
+		
+		/**
+		Picks out the memos' entries for positions that have more of
+			the game left than the current one, which no move from
+			here can lead back to.
+		*/
+		class Unreachable
+		{
+			private:
+				/** How much of the game the current position
+					has left */
+				unsigned int left;
+			
+			public:
+				/**
+				Picks out what's unreachable from a position.
+				@param current the position
+				*/
+				explicit Unreachable( const State& current );
+				
+				/**
+				Decides whether an entry is unreachable.
+				@param key the position
+				@return whether it has more left than ours
+				*/
+				bool operator()( const State& key, const Record& )
+					const;
+		};
+		
+		/**
+		Tells which of a <tt>Library</tt>'s records could have come
+			from a <tt>Solver</tt>.
+		*/
+		class Credible
+		{
+			public:
+				/**
+				Checks a record.
+				@param record what the <tt>Library</tt> says
+				@return whether its score and bound are ones we
+					might have stored
+				*/
+				bool operator()( const Record& record ) const;
+		};
+		
+		/**
+		Tells a search to give up.  Cancelling a search also cancels
+			everything it started.
+		*/
+		class Cancellation
+		{
+			private:
+				/** Whether we've been told to give up */
+				std::atomic< bool > flag;
+				
+				/** Whoever started us */
+				const Cancellation* parent;
+			
+			public:
+				/**
+				Creates a flag that hasn't been raised.
+				@param origin the flag of whoever started us
+				*/
+				explicit Cancellation( const Cancellation*
+					origin=NULL );
+				
+				/**
+				Tells the search (and everything it started) to
+					give up.
+				*/
+				void raise( void );
+				
+				/**
+				Checks whether we, or anyone who started us,
+					have been told to give up.
+				@return whether to give up
+				*/
+				bool raised( void ) const;
+		};
+		
+		/**
+		What a search with a horizon has guessed about a position, on
+			a finer scale than a <tt>Record</tt>'s.
+		*/
+		struct Guess
+		{
+			/** The position's estimated score, where
+				<tt>CERTAINTY</tt> is a proven win */
+			int value;
+			
+			/** How far to trust <tt>value</tt>, a <tt>Bound</tt> */
+			unsigned char bound;
+			
+			/** How many plies the guess looked beyond the
+				position */
+			unsigned char draft;
+			
+			/** Which of the position's <tt>successors()</tt>
+				looked best */
+			unsigned short choice;
 			
 			/**
-			Retrieves hash code.
-			@return our <tt>State</tt>'s hash code
+			Constructor, for an even guess that looked no further
+				than the position itself.
 			*/
-			int hash( void ) const;
+			Guess( void );
+		};
+		
+		/** What a proven win is worth in a <tt>Guess</tt>, which no
+			estimate reaches */
+		static const int CERTAINTY=1<<20;
+		
+		/** The farthest beyond its position that a <tt>Guess</tt>
+			may look */
+		static const unsigned int MAX_DRAFT=UCHAR_MAX;
+		
+		/**
+		What a proof-number search knows about whether a position is
+			a forced win for the player it's trying to prove one for:
+			roughly how many more positions would have to be proven
+			wins to establish it, and how many would have to be
+			proven otherwise to refute it.
+		*/
+		struct Proof
+		{
+			/** How many positions stand between it and proof,
+				where <tt>0</tt> means it's proven */
+			unsigned int proof;
+			
+			/** How many positions stand between it and
+				disproof, where <tt>0</tt> means it's disproven */
+			unsigned int disproof;
 			
 			/**
-			Verifies equivalent identities.
-			@param another <tt>StatePlusScore</tt> instance
-			@return whether our <tt>State</tt>s identify
+			Constructor, for a position we know nothing about.
 			*/
-			bool operator==( const StatePlusScore& another )
-				const;
+			Proof( void );
+		};
+		
+		/** The proof or disproof number that means it can't be had,
+			which no sum reaches otherwise */
+		static const unsigned int HOPELESS=UINT_MAX/2;
+		
+		/**
+		What a search with a horizon may spend before it has to give
+			up.
+		*/
+		class Allowance
+		{
+			public:
+				/** When to give up, if we're timed */
+				std::chrono::steady_clock::time_point deadline;
+				
+				/** Whether there's a <tt>deadline</tt> */
+				bool timed;
+				
+				/** How many positions to visit at most, or
+					<tt>0</tt> for no limit */
+				uint64_t positions;
+				
+				/** How many positions we've visited */
+				uint64_t visited;
+				
+				/** Whether the limits apply yet */
+				bool binding;
+				
+				/** Whether we've run out */
+				bool spent;
+				
+				/**
+				Starts an allowance, which doesn't bind until
+					told to.
+				@param seconds how long to take at most, or
+					<tt>0</tt> for no limit
+				@param limit how many positions to visit at
+					most, or <tt>0</tt> for no limit
+				*/
+				Allowance( double seconds, uint64_t limit );
+				
+				/**
+				Counts a position and checks whether we've run
+					out, consulting the clock only every so
+					often.
+				@return whether to give up
+				*/
+				inline bool exhausted( void );
 		};
 		
+		/**
+		Our part in a search spread across processes.
+		*/
+		class Node;
+		
+		/**
+		Searches positions, keeping what it learns in a memo of type
+			<tt>Table</tt>, which may be shared with other
+			<tt>Engine</tt>s.
+		*/
+		template< class Table > class Engine
+		{
+			public:
+				/** Where to find or put a position in the memo */
+				typedef typename Table::Locator Locator;
+			
+			private:
+				/**
+				One position being expanded by an iterative
+					search.
+				*/
+				struct Frame
+				{
+					/** The position's successors, whose
+						storage outlives the search */
+					MoveBuffer< State > successors;
+					
+					/** The order in which to examine them, as
+						indices into <tt>successors</tt> */
+					std::vector< unsigned int > order;
+					
+					/** How far along <tt>order</tt> we are */
+					unsigned int next;
+					
+					/** The window's current lower end */
+					typename State::Score alpha;
+					
+					/** The window's current upper end */
+					typename State::Score beta;
+					
+					/** The window's lower end on entry */
+					typename State::Score originalAlpha;
+					
+					/** The window's upper end on entry */
+					typename State::Score originalBeta;
+					
+					/** What we've decided so far */
+					Record decision;
+					
+					/** Where the position belongs in the
+						memo */
+					Locator where;
+				};
+				
+				/** How many frames to set aside before the
+					first search */
+				static const unsigned int RESERVED_FRAMES=1024;
+				
+				/** Previously-determined states for
+					memoization */
+				Table& remembered;
+				
+				/** The search's stack, whose frames
+					(and their successor buffers) are reused
+					from search to search */
+				std::vector< Frame > frames;
+				
+				/** The most frames that have ever been in use
+					at once */
+				unsigned int peak;
+				
+				/** What we've visited, and how the memo and
+					<tt>library</tt> served us; the
+					<tt>memo</tt> itself is counted by whoever
+					owns it */
+				SolverStatistics counts;
+				
+				/**
+				Ranks successor indices by their history scores.
+				*/
+				class ByHistory
+				{
+					private:
+						/** The scores, by index */
+						const std::vector< unsigned int >&
+							scores;
+					
+					public:
+						/**
+						Ranks by a particular table.
+						@param table the scores, by index
+						*/
+						explicit ByHistory( const std::vector<
+							unsigned int >& table );
+						
+						/**
+						Compares two indices.
+						@param first one index
+						@param second another index
+						@return whether <tt>first</tt> has
+							the higher score
+						*/
+						bool operator()( unsigned int first,
+							unsigned int second ) const;
+				};
+				
+				/** Which <tt>Ordering</tt>s we use */
+				unsigned int heuristics;
+				
+				/** The last two successor indices to refute a
+					position at each ply */
+				std::vector< unsigned int > killers;
+				
+				/** How many times each successor index has
+					refuted a position */
+				std::vector< unsigned int > history;
+				
+				/** What earlier runs determined, if anything */
+				const Library* library;
+				
+				/** Holds positions' bytes while we look them up
+					in the <tt>library</tt> */
+				std::string scratch;
+				
+				/** Holds positions' successors while we check
+					the <tt>library</tt>'s moves for them */
+				MoveBuffer< State > checking;
+				
+				/** The cluster node whose memo ours is part of,
+					if any */
+				Node* partition;
+				
+				/**
+				Looks a position up in the <tt>library</tt>,
+					disbelieving any entry whose move isn't one
+					of the position's.
+				@pre The game isn't over.
+				@param state the position in question
+				@return what the library knows about it, or
+					<tt>NULL</tt> if nothing
+				*/
+				const Record* lookUp( const State& state );
+				
+				/**
+				Notes that a successor refuted its parent.
+				@param ply how far the parent is from the root
+				@param index which of its successors did it
+				*/
+				void reward( unsigned int ply, unsigned int index );
+				
+				/**
+				Determines the ideal end-of-turn state given the
+					state at the beginning of the turn.  When
+					the <tt>Traits</tt> say to prune, the search
+					may stop as soon as it learns that the score
+					falls outside the window of interest, in which
+					case it reports a bound in that direction.
+				@param state the <tt>State</tt> being evaluated
+				@param alpha the score the computer is already
+					assured of
+				@param beta the score the human is already
+					assured of
+				@param result the preferred successor's index and
+					score
+				@param cancel tells us to give up, if not
+					<tt>NULL</tt>
+				@param ply how far <tt>state</tt> is from the root
+				@param depth how far <tt>state</tt> is from where
+					this search began, which is whose frame's
+					buffers it may use
+				@return whether we finished, rather than giving up
+				*/
+				bool nextBestState( const State& state, typename
+					State::Score alpha, typename State::Score
+					beta, Record& result, const Cancellation*
+					cancel, unsigned int ply, unsigned int
+					depth );
+				
+				/**
+				Sets up a frame of the iterative search's stack.
+				@param depth the frame to set up
+				@param state the position to be expanded
+				@param alpha the score the computer is already
+					assured of
+				@param beta the score the human is already
+					assured of
+				@param where the position's place in the memo
+				@param hint the successor the memo suggests, or
+					<tt>NO_MOVE</tt>
+				@param ply how far <tt>state</tt> is from the root
+				*/
+				void prepare( unsigned int depth, const State& state,
+					typename State::Score alpha, typename
+					State::Score beta, const Locator& where,
+					unsigned int hint, unsigned int ply );
+				
+				/**
+				Finds the position a frame of the iterative search's
+					stack is expanding.
+				@param depth the frame in question
+				@param root the position at the bottom of the stack
+				@return that frame's position
+				*/
+				inline const State& expanding( unsigned int depth,
+					const State& root ) const;
+				
+				/**
+				Has the same effect as <tt>nextBestState()</tt>, but
+					keeps its own stack rather than recursing.
+				@param state the <tt>State</tt> being evaluated
+				@param alpha the score the computer is already
+					assured of
+				@param beta the score the human is already
+					assured of
+				@param result the preferred successor's index and
+					score
+				@param cancel tells us to give up, if not
+					<tt>NULL</tt>
+				@param ply how far <tt>state</tt> is from the root
+				@return whether we finished, rather than giving up
+				*/
+				bool iterateBestState( const State& state, typename
+					State::Score alpha, typename State::Score
+					beta, Record& result, const Cancellation*
+					cancel, unsigned int ply );
+			
+			public:
+				/**
+				Makes an <tt>Engine</tt>.
+				@param memo where to remember what we learn
+				*/
+				explicit Engine( Table& memo );
+				
+				/**
+				Chooses how to order moves.
+				@param which the <tt>Ordering</tt>s to use
+				*/
+				void orderMoves( unsigned int which );
+				
+				/**
+				Chooses what to consult for positions missing
+					from the memo.
+				@param database what earlier runs determined, or
+					<tt>NULL</tt> for nothing
+				*/
+				void consult( const Library* database );
+				
+				/**
+				Makes our memo part of a cluster's, telling the
+					other nodes what we learn near the top of
+					each search and asking them what they know
+					before we expand a position there.
+				@param node our cluster node, or <tt>NULL</tt> to
+					keep to ourselves
+				*/
+				void partake( Node* node );
+				
+				/**
+				Decides in which order to examine a position's
+					successors.
+				@param state the position in question
+				@param count how many successors it has
+				@param hint the successor the memo suggests, or
+					<tt>NO_MOVE</tt>
+				@param ply how far <tt>state</tt> is from the root
+				@param allowed which of our <tt>Ordering</tt>s may
+					be used
+				@param order where to put the successors' indices
+				*/
+				void arrange( const State& state, unsigned int count,
+					unsigned int hint, unsigned int ply,
+					unsigned int allowed, std::vector< unsigned
+					int >& order ) const;
+				
+				/**
+				Settles a position without expanding it, if
+					possible: either the game is over, we (or
+					the <tt>library</tt>) remember enough about
+					it, or we're pruning and one of its moves
+					is spotted winning on the spot.
+				@param state the position in question
+				@param alpha the score the computer is already
+					assured of
+				@param beta the score the human is already
+					assured of
+				@param decision where to put the result, if there
+					is one
+				@param where set to the position's place in the
+					memo
+				@param hint set to the successor the memo (or the
+					<tt>library</tt>) suggests trying first, or
+					<tt>NO_MOVE</tt>
+				@return whether <tt>decision</tt> was filled in
+				*/
+				bool recall( const State& state, typename
+					State::Score alpha, typename State::Score
+					beta, Record& decision, Locator& where,
+					unsigned int& hint );
+				
+				/**
+				Folds one successor's result into its parent's
+					decision and window.
+				@param state the parent position
+				@param index which of its successors we're looking
+					at
+				@param eldest whether it's the first one we've
+					looked at
+				@param candidate that successor's result
+				@param decision the parent's decision so far
+				@param alpha the lower end of the parent's window
+				@param beta the upper end of the parent's window
+				@return whether the remaining successors may be
+					skipped
+				*/
+				bool consider( const State& state, unsigned int index,
+					bool eldest, const Record& candidate, Record&
+					decision, typename State::Score& alpha,
+					typename State::Score& beta ) const;
+				
+				/**
+				Classifies a finished decision against the window in
+					which it was made and memoizes it.
+				@param state the position that was decided
+				@param alpha the lower end of the window on entry
+				@param beta the upper end of the window on entry
+				@param decision the decision, whose bound is filled
+					in
+				@param where the position's place in the memo
+				@param ply how far the position is from the root,
+					where positions took more work to decide and
+					so are more worth keeping in a full memo
+				*/
+				void conclude( const State& state, typename
+					State::Score alpha, typename State::Score
+					beta, Record& decision, Locator& where,
+					unsigned int ply );
+				
+				/**
+				Decides a position.
+				@param state the <tt>State</tt> being evaluated
+				@param alpha the score the computer is already
+					assured of
+				@param beta the score the human is already
+					assured of
+				@param result the preferred successor's index and
+					score
+				@param cancel tells us to give up, if not
+					<tt>NULL</tt>
+				@param ply how far <tt>state</tt> is from the root
+				@return whether we finished, rather than giving up
+				*/
+				bool search( const State& state, typename
+					State::Score alpha, typename State::Score
+					beta, Record& result, const Cancellation*
+					cancel=NULL, unsigned int ply=0 );
+				
+				/**
+				Reports how deep the search has ever had to go.
+				@return the most stack frames ever in use at once
+				*/
+				unsigned int peakDepth( void ) const;
+				
+				/**
+				Adds what we've visited to a running total.
+				@param into the total
+				*/
+				void tally( SolverStatistics& into ) const;
+		};
+		
+		/**
+		A search of one of a position's younger successors, which
+			runs in parallel with its siblings.
+		*/
+		class Split : public Task
+		{
+			public:
+				/** What the search decided */
+				Record result;
+				
+				/** Whether the search ran to completion */
+				bool completed;
+				
+				/** Tells the search to give up */
+				Cancellation cancel;
+			
+			private:
+				/** Who's searching */
+				Solver& solver;
+				
+				/** The position to search */
+				const State& state;
+				
+				/** The lower end of the window */
+				typename State::Score alpha;
+				
+				/** The upper end of the window */
+				typename State::Score beta;
+				
+				/** How far the position is from the root */
+				unsigned int ply;
+				
+				/** The parent's other younger successors'
+					searches */
+				const std::vector< Split* >& siblings;
+				
+				/** Our own index among them */
+				unsigned int index;
+				
+				/** Whether the parent is the computer's turn */
+				bool maximizing;
+			
+			public:
+				/**
+				Describes a search.
+				@param searcher who's searching
+				@param position the position to search
+				@param low the lower end of the window
+				@param high the upper end of the window
+				@param distance how far the position is from the
+					root
+				@param origin the parent's <tt>Cancellation</tt>
+				@param brothers the parent's younger successors'
+					searches
+				@param order our own index among them
+				@param max whether the parent is the computer's
+					turn
+				*/
+				Split( Solver& searcher, const State& position,
+					typename State::Score low, typename
+					State::Score high, unsigned int distance,
+					const Cancellation& origin, const
+					std::vector< Split* >& brothers, unsigned
+					int order, bool max );
+				
+				/**
+				Runs the search, then calls off any younger
+					siblings if the result refutes the parent.
+				@param worker the index of the thread doing it
+				*/
+				virtual void run( unsigned int worker );
+		};
+		
+		/**
+		A process taking part in a search spread across a
+			<tt>Cluster</tt>.  Node 0 leads, searching near the
+			root as a parallel search would, except that each of
+			its threads hands the positions it reaches
+			<tt>splitDepth</tt> plies down to a node of its own and
+			waits to hear back.  The others search what they're
+			handed, sharing a memo partitioned between them by
+			<tt>Traits::digest()</tt>: whatever one of them learns
+			near the top of its search, it tells the position's
+			owner without waiting, and before it expands a position
+			there, it asks each owner about all of the successors
+			it doesn't know at once.
+		*/
+		class Node : public Cluster::Handler
+		{
+			private:
+				/**
+				A search the leader has handed another node.
+				*/
+				struct Errand
+				{
+					/** Whether it's been answered */
+					bool answered;
+					
+					/** Whether it ran to completion */
+					bool completed;
+					
+					/** What it decided */
+					Record result;
+				};
+				
+				/** Whose search we're part of */
+				Solver& solver;
+				
+				/** Protects what follows */
+				std::mutex lock;
+				
+				/** Tells whoever's waiting that something has
+					arrived */
+				std::condition_variable heard;
+				
+				/** Which nodes have left */
+				std::vector< bool > gone;
+				
+				/** The search each node is doing for us, if
+					we're leading */
+				std::vector< Errand > errands;
+				
+				/** How many positions the others have visited
+					for us */
+				uint64_t delegated;
+				
+				/** The search we've been handed, but haven't
+					started */
+				std::string job;
+				
+				/** Whether there's a <tt>job</tt> */
+				bool hired;
+				
+				/** Whether the leader called off the
+					<tt>job</tt> before it started */
+				bool recalled;
+				
+				/** Tells the search we're doing to give up, if
+					any */
+				Cancellation* underway;
+				
+				/** Whether the leader has left */
+				bool dismissed;
+				
+				/** Whether the leader plays another
+					<tt>variant()</tt> */
+				bool mismatched;
+				
+				/** How far from the root our search began */
+				unsigned int shallowest;
+				
+				/** Numbers our questions, so that late
+					answers to old ones are ignored */
+				uint64_t serial;
+				
+				/** How many nodes have yet to answer our
+					latest questions */
+				unsigned int awaited;
+				
+				/** What we've asked each node about */
+				std::vector< std::vector< const State* > > asked;
+				
+				/** How far from the root the positions we've
+					asked about are */
+				unsigned int askedPly;
+				
+				/**
+				Finds which node holds a position in the
+					partitioned memo.
+				@pre There are at least two nodes besides the
+					leader.
+				@param state the position
+				@return the node
+				*/
+				unsigned int owner( const State& state ) const;
+				
+				/**
+				Writes a position for another node.
+				@param state the position
+				@param bytes where to append its
+					<tt>encode()</tt>ing
+				*/
+				static void wrap( const State& state, std::string&
+					bytes, Choice< true > );
+				
+				/**
+				Writes nothing, since a position that can't be
+					<tt>decode()</tt>d is never sent.
+				*/
+				static void wrap( const State&, std::string&,
+					Choice< false > );
+				
+				/**
+				Writes a <tt>Record</tt> for another node.
+				@param record the <tt>Record</tt>
+				@param bytes where to append it
+				*/
+				static void pack( const Record& record, std::string&
+					bytes );
+				
+				/**
+				Reads a <tt>Record</tt> written by
+					<tt>pack()</tt>.
+				@param cursor where it starts, which is
+					advanced past it
+				@param end where the input ends
+				@param record where to put it
+				@return whether it was all there and made sense
+				*/
+				static bool unpack( const char*& cursor, const
+					char* end, Record& record );
+				
+				/**
+				Memoizes what another node has told us about a
+					position we hold.
+				@param payload where the message starts
+				@param end where it ends
+				*/
+				void absorb( const char* payload, const char* end
+					);
+				
+				/**
+				Answers another node's questions about
+					positions we hold.
+				@param peer who asked
+				@param payload where the questions start
+				@param end where they end
+				*/
+				void reply( unsigned int peer, const char* payload,
+					const char* end );
+				
+				/**
+				Memoizes another node's answers to our
+					questions.
+				@pre We hold the <tt>lock</tt>.
+				@param peer who answered
+				@param payload where the answers start
+				@param end where they end
+				*/
+				void learn( unsigned int peer, const char* payload,
+					const char* end );
+				
+				/**
+				Copying is unsupported.
+				*/
+				Node( const Node& );
+				
+				/**
+				Assignment is unsupported.
+				*/
+				Node& operator=( const Node& );
+			
+			public:
+				/** How many plies of a node's search, from
+					where it began, go in the partitioned
+					memo */
+				static const unsigned int SHARED_PLIES=6;
+				
+				/** How often the leader checks whether to call
+					off a search it's handed out, in
+					milliseconds */
+				static const unsigned int POLL_MILLISECONDS=10;
+				
+				/** How long to wait for answers to our
+					questions, in milliseconds */
+				static const unsigned int PATIENCE_MILLISECONDS=
+					1000;
+				
+				/** The processes we search with */
+				Cluster cluster;
+				
+				/**
+				Readies a node, which hasn't joined the others.
+				@param owner whose search we're part of
+				*/
+				explicit Node( Solver& owner );
+				
+				/**
+				Joins the other nodes.
+				@param hosts the hosts file
+				@param self our own number in it
+				@return whether all of them could be reached
+				*/
+				bool enlist( const char* hosts, unsigned int self );
+				
+				/**
+				Counts the threads our search should have.
+				@return one per other node if we're leading, or
+					else one
+				*/
+				unsigned int hands( void ) const;
+				
+				/**
+				Hears a message from another node.
+				@param peer who sent it
+				@param kind what sort of message it is
+				@param payload where it starts
+				@param end where it ends
+				*/
+				virtual void receive( unsigned int peer, char kind,
+					const char* payload, const char* end );
+				
+				/**
+				Learns that another node has left.
+				@param peer the node
+				*/
+				virtual void depart( unsigned int peer );
+				
+				/**
+				Has the node standing behind one of the leader's
+					threads decide a position, or decides it on
+					that thread if the node has gone.
+				@param worker the index of the thread
+				@param state the position
+				@param alpha the score the computer is already
+					assured of
+				@param beta the score the human is already
+					assured of
+				@param ply how far <tt>state</tt> is from the root
+				@param decision the preferred successor's index
+					and score
+				@param cancel tells us to give up, which we pass
+					along
+				@return whether the search finished, rather than
+					giving up
+				*/
+				bool delegate( unsigned int worker, const State&
+					state, typename State::Score alpha, typename
+					State::Score beta, unsigned int ply, Record&
+					decision, const Cancellation& cancel );
+				
+				/**
+				Tells a position's owner what we've decided
+					about it, if it's near enough the top of our
+					search, sending it along with others later.
+				@param state the position
+				@param decision what we decided
+				@param ply how far the position is from the root
+				*/
+				void share( const State& state, const Record&
+					decision, unsigned int ply );
+				
+				/**
+				Asks the owners of a position's successors what
+					they know about those we don't, if they're
+					near enough the top of our search, and waits
+					a while to memoize their answers.
+				@param successors the successors
+				@param ply how far they are from the root
+				*/
+				void anticipate( const MoveBuffer< State >&
+					successors, unsigned int ply );
+				
+				/**
+				Decides whatever positions the leader hands us,
+					until it leaves.
+				@return whether we could, rather than the leader
+					playing another <tt>variant()</tt>
+				*/
+				bool serve( void );
+				
+				/**
+				Reports how many positions other nodes have
+					visited for us.
+				@return how many
+				*/
+				uint64_t visited( void );
+		};
+	
+	private: //state
+		/** The current game state */
+		State current;
+		
 		/** Previously-determined states for memoization */
-		mutable HashTable< StatePlusScore > remembered;
+		Memo remembered;
+		
+		/** Our single-threaded searcher */
+		Engine< Memo > engine;
+		
+		/** How many plies below the root parallel searches split */
+		unsigned int splitDepth;
+		
+		/** Which <tt>Ordering</tt>s we use */
+		unsigned int heuristics;
+		
+		/** Previously-determined states for parallel searches, or
+			<tt>NULL</tt> if we're single-threaded */
+		SharedMemo* shared;
+		
+		/** The threads for parallel searches, if any */
+		WorkerPool* pool;
+		
+		/** One searcher per thread of <tt>pool</tt> */
+		std::vector< Engine< SharedMemo >* > workers;
+		
+		/** What earlier runs determined, if we've opened it */
+		Library library;
+		
+		/** The most memory the memo may occupy, or <tt>0</tt> for no
+			limit */
+		uint64_t memoBudget;
+		
+		/** How long our searches have taken, along with what the
+			threads <tt>parallelize()</tt> has since retired went
+			through */
+		SolverStatistics ledger;
+		
+		/** What searches with a horizon have guessed since the last
+			<tt>nextGoodState()</tt> began */
+		HashTable< State, Guess > guesses;
+		
+		/** Each ply's successors, for searches with a horizon */
+		std::vector< MoveBuffer< State > > lookahead;
+		
+		/** The order in which to try them */
+		std::vector< std::vector< unsigned int > > orders;
+		
+		/** How far the last <tt>nextGoodState()</tt> could see */
+		unsigned int reach;
+		
+		/** Whether to <tt>sweep()</tt> after every move */
+		bool sweeping;
+		
+		/** What the last <tt>forcesWin()</tt> has yet to prove */
+		HashTable< State, Proof > proofs;
+		
+		/** Each ply's successors, for proof-number searches, which
+			may go deeper without moving shallower plies' */
+		std::deque< MoveBuffer< State > > frontier;
+		
+		/** Our part in a search spread across processes, if we've
+			<tt>distribute()</tt>d */
+		Node* network;
+	
+	private: //helpers
+		/**
+		Lists a position's successors in the order its
+			<tt>orderedSuccessors()</tt> hook recommends.
+		@param state the position in question
+		@param count how many successors it has
+		@param order where to put their indices
+		*/
+		static void suggest( const State& state, unsigned int count,
+			std::vector< unsigned int >& order, Choice< true > );
 		
 		/**
-		Determines the ideal end-of-turn state given the state at the
-			beginning of the turn.
+		Lists a position's successors in the order they're
+			generated, for lack of a hook.
+		@param state the position in question
+		@param count how many successors it has
+		@param order where to put their indices
+		*/
+		static void suggest( const State& state, unsigned int count,
+			std::vector< unsigned int >& order, Choice< false > );
+		
+		/**
+		Removes the memos' entries for positions unreachable from the
+			current one, by their <tt>remaining()</tt>.
+		@return how many were removed
+		*/
+		uint64_t sweep( Choice< true > );
+		
+		/**
+		Keeps everything, for lack of a way to tell what's reachable.
+		@return none
+		*/
+		uint64_t sweep( Choice< false > );
+		
+		/**
+		Keys an index for the <tt>Library</tt>.
+		@param index a position's <tt>index()</tt>
+		@param bytes where to append its key
+		*/
+		static inline void identify( uint64_t index, std::string& bytes
+			);
+		
+		/**
+		Checks whether the player whose turn it is in <tt>state</tt>
+			would prefer to have the <tt>alternative</tt> score.
+			Assumes that higher scores are better for the
+			computer player, regardless of who's up.
+		@param state the position in question
+		@param incumbent the score the player already has
+		@param alternative the other score we're offering the
+			player
+		@return whether the player to move prefers the score
+			it's been offered
+		*/
+		static bool prefersScore( const State& state, typename
+			State::Score incumbent, typename State::Score
+			alternative );
+		
+		/**
+		Decides a position on many threads.  Near the root, the eldest
+			successor is searched first, and the remainder are then
+			searched in parallel; once we're <tt>splitDepth</tt>
+			plies down, each thread proceeds on its own.
+		@param worker the index of the calling thread
 		@param state the <tt>State</tt> being evaluated
-		@param result the preferred position and score
+		@param alpha the score the computer is already assured of
+		@param beta the score the human is already assured of
+		@param ply how far <tt>state</tt> is from the root
+		@param decision the preferred successor's index and score
+		@param cancel tells us to give up
+		@return whether we finished, rather than giving up
 		*/
-		void nextBestState( const State& state, StatePlusScore& result ) const;
+		bool splitBestState( unsigned int worker, const State& state,
+			typename State::Score alpha, typename State::Score beta,
+			unsigned int ply, Record& decision, const Cancellation&
+			cancel );
+		
+		/**
+		Settles a position from what's already known about it, if
+			that's enough, without searching it.
+		@param engine the searcher whose memo to consult
+		@param state the position
+		@param alpha the score the computer is already assured of
+		@param beta the score the human is already assured of
+		@param decision set to what's known, if it's enough
+		@return whether it was enough
+		*/
+		template< class Table > static bool glance( Engine< Table >&
+			engine, const State& state, typename State::Score alpha,
+			typename State::Score beta, Record& decision );
+		
+		/**
+		Finds a move that earns the current position the score its
+			search gave it, for a record that didn't keep one.
+			Each successor is asked only whether it does that
+			well: first of whatever's already known, which is
+			usually enough, and then by searching them.
+		@param value the position's true score
+		@return the index of the successor that earns it
+		*/
+		unsigned int rediscover( typename State::Score value );
+		
+		/**
+		Estimates a position by searching only so far beyond it, and
+			judging the positions there by the <tt>Traits</tt>'
+			<tt>estimate()</tt>.  Whatever it proves along the way
+			goes in the memo, while the rest goes in the
+			<tt>guesses</tt> for deeper searches to start from.
+		@param memo the memo, which it consults and adds to
+		@param state the position
+		@param alpha the score the computer is already assured of
+		@param beta the score the human is already assured of
+		@param draft how many plies beyond the position to look
+		@param ply how far the position is from the root
+		@param allowance what the search may spend, which is drawn
+			down
+		@param proven set to whether the score is the game's true
+			one (or a true bound)
+		@param choice set to the successor that looked best
+		@return the score, in the units of a <tt>Guess</tt>, or
+			nothing meaningful if the <tt>allowance</tt> ran out
+		*/
+		template< class Table > int foresee( Table& memo, const State&
+			state, int alpha, int beta, unsigned int draft, unsigned
+			int ply, Allowance& allowance, bool& proven, unsigned
+			int& choice );
+		
+		/**
+		Adds two proof or disproof numbers, short of
+			<tt>HOPELESS</tt> unless one of them was.
+		@param total one of them
+		@param more the other
+		@return the sum
+		*/
+		static unsigned int accumulate( unsigned int total, unsigned
+			int more );
+		
+		/**
+		Sizes up a position before a proof-number search expands it,
+			from how the game ended, what the memo has proven, or
+			what we've learned so far, or else just as one
+			position.
+		@param memo the memo
+		@param state the position
+		@param computerAttacks whether we're proving a win for the
+			computer, rather than for the human
+		@param estimate where to put what we know
+		*/
+		template< class Table > void appraise( Table& memo, const State&
+			state, bool computerAttacks, Proof& estimate );
+		
+		/**
+		Works toward proving or disproving a forced win from a
+			position (df-pn), going no further than it takes for
+			its proof or disproof number to reach a limit.  The
+			positions where the attacker is up need one successor
+			proven and all of them refuted, and the others the
+			reverse; within those limits, we keep searching the
+			successor closest to settling the matter.  Whatever is
+			settled goes in the memo.
+		@param memo the memo, which it consults and adds to
+		@param state the position
+		@param computerAttacks whether we're proving a win for the
+			computer, rather than for the human
+		@param proofLimit the proof number to stop at
+		@param disproofLimit the disproof number to stop at
+		@param ply how far the position is from the root
+		@param result set to what we know when we stop
+		*/
+		template< class Table > void prove( Table& memo, const State&
+			state, bool computerAttacks, unsigned int proofLimit,
+			unsigned int disproofLimit, unsigned int ply, Proof&
+			result );
+		
+		/**
+		Copying is unsupported.
+		*/
+		Solver( const Solver& );
+		
+		/**
+		Assignment is unsupported.
+		*/
+		Solver& operator=( const Solver& );
 	
 	public:
 		/**
@@ -94,25 +1395,205 @@ template< typename State > class Solver
 			<tt>State</tt>.
 		@param initial the initial game <tt>State</tt>
 		*/
-		Solver( const State& initial );
+		explicit Solver( const State& initial );
 		
 		/**
 		Destroys the <tt>Solver</tt>.
 		*/
 		~Solver( void );
 		
+		/**
+		Chooses how many threads to search with.  Switching between
+			one thread and several forgets everything the
+			<tt>Solver</tt> has learned so far.
+		@param threads the number of threads, where <tt>0</tt> means
+			one per hardware thread; once we've
+			<tt>distribute()</tt>d, the cluster decides instead
+		@param depth how many plies below the root to keep splitting
+			work among threads
+		*/
+		void parallelize( unsigned int threads, unsigned int
+			depth=DEFAULT_SPLIT_DEPTH );
+		
+		/**
+		Searches together with other processes, as listed in a hosts
+			file with a <tt>host port</tt> line for each, which are
+			numbered from 0 in order and must all be doing the same.
+			Node 0 leads, searching as though it had a thread for
+			each of the others, with which it hands off every
+			position it reaches <tt>depth</tt> plies below the root
+			to that node; the others <tt>serve()</tt>, each holding
+			its share of one memo partitioned between them.  This
+			forgets everything learned so far, lasts as long as the
+			<tt>Solver</tt> does, and needs a <tt>State</tt> that
+			the <tt>Traits</tt> find <tt>decodable</tt>.
+		@param hosts the hosts file
+		@param node our own number in it
+		@param depth how many plies below the root to hand work out
+		@return whether we could reach every other node
+		*/
+		bool distribute( const char* hosts, unsigned int node, unsigned
+			int depth=DEFAULT_SPLIT_DEPTH );
+		
+		/**
+		Decides the positions the leader of our cluster hands us, until
+			it leaves.
+		@pre We've <tt>distribute()</tt>d as a node other than 0,
+			with the same <tt>variant()</tt> as the leader's.
+		@return whether we served, rather than the leader playing
+			another <tt>variant()</tt>
+		*/
+		bool serve( void );
+		
+		/**
+		Chooses how to order moves, which affects how much pruning
+			searches prune, but not their results' scores.
+		@param which the <tt>Ordering</tt>s to use, all of them by
+			default
+		*/
+		void orderMoves( unsigned int which );
+		
+		/**
+		Fixes the memory the memo may occupy, emptying it; once full,
+			it replaces entries rather than growing, preferring to
+			keep those nearer the root of the search.  This lasts
+			until the next call, even after parallelizing.
+		@param bytes the most memory the memo may occupy, or
+			<tt>0</tt> to let it grow as it needs
+		@return whether the memo could be given that much memory
+		*/
+		bool budget( uint64_t bytes );
+		
+		/**
+		Opens a solution database written by <tt>record()</tt>, which
+			every later search consults for positions its memo
+			doesn't know before searching them itself.
+		@param path where the database is
+		@return whether it was readable and for the same variant of
+			the game as the current state, without which it is
+			ignored
+		*/
+		bool consult( const char* path );
+		
+		/**
+		Writes a solution database holding everything the memo has
+			learned, plus anything in the database we consulted.
+		@pre No search is under way.
+		@param path where to put the database
+		@return whether it was written
+		*/
+		bool record( const char* path ) const;
+		
+		/**
+		Decides every position reachable from the current one without
+			searching, which makes a tablebase of the memo for
+			<tt>record()</tt> to write out.  The positions are first
+			enumerated a layer at a time, where the <tt>State</tt>'s
+			<tt>unsigned int remaining(void) const</tt> must shrink
+			with every move, and then decided from the last layer
+			back to the first, so that each position's successors
+			have always been decided before it is.  Anything
+			learned before is forgotten, any <tt>budget()</tt> is
+			lifted, and only a single thread is used afterward.
+		@return how many positions were decided, or <tt>0</tt> if
+			the memo ran out of room for them
+		*/
+		uint64_t tabulate( void );
+		
 		/**
 		Queries for the current state.
 		@return the current <tt>State</tt>
 		*/
 		const State& getCurrentState( void ) const;
 		
+		/**
+		Reports how deep the search has ever had to go.
+		@return the most stack frames ever in use at once by any thread
+		*/
+		unsigned int peakDepth( void ) const;
+		
+		/**
+		Reports what our searches have been through since we were
+			created, summed over every thread that took part.
+		@return the statistics
+		*/
+		SolverStatistics statistics( void ) const;
+		
+		/**
+		Forgets what the memo knows about positions that can no longer
+			be reached from the current one, so that a long game
+			doesn't fill memory with its past.  Only states whose
+			<tt>unsigned int remaining(void) const</tt> shrinks with
+			every move can tell which those are: any with more left
+			than the current state.  For others, nothing is
+			forgotten.  What was learned about the current state and
+			the positions after it is kept, so a move the search
+			foresaw is still answered straight from the memo.  Only
+			the memo's hashed entries are removed, since positions
+			stored by <tt>index()</tt> use no more memory as they
+			accumulate.
+		@pre No search is under way.
+		@return how many entries were removed
+		*/
+		uint64_t sweep( void );
+		
+		/**
+		Chooses whether to <tt>sweep()</tt> after each move, whether
+			it was made by <tt>nextBestState()</tt>,
+			<tt>nextGoodState()</tt>, or
+			<tt>supplyNextState()</tt>.  This is off by default,
+			since a <tt>record()</tt>ed database then holds only
+			what was learned about the rest of the game.
+		@param enabled whether to
+		*/
+		void tidy( bool enabled );
+		
 		/**
 		Advances the game to the most favorable state.
 		@return the new <tt>State</tt>
 		*/
 		const State& nextBestState( void );
 		
+		/**
+		Advances the game to the most favorable state that can be
+			found within a budget.  We search one ply ahead, then
+			two, and so on, each search trying first what the last
+			thought best, and keep the move from the deepest search
+			that finished; positions beyond the horizon are judged
+			by the <tt>Traits</tt>' <tt>estimate()</tt>.  The first
+			search always finishes, and we stop early once one
+			proves its move best.  Only one thread is used.
+		@param seconds how long to take at most, or <tt>0</tt> for no
+			limit
+		@param positions how many positions to visit at most, or
+			<tt>0</tt> for no limit
+		@return the new <tt>State</tt>
+		*/
+		const State& nextGoodState( double seconds, uint64_t positions );
+		
+		/**
+		Decides whether the player whose turn it is can force a
+			victory from the current state, by proof-number search:
+			rather than working out the position's score, it only
+			follows the lines that look closest to proving or
+			refuting the win, which can settle the question
+			having visited far fewer positions.  What it settles
+			goes in the memo, so a following
+			<tt>nextBestState()</tt> finds the winning move at
+			once.  Only one thread is used, and its own table is
+			held to any <tt>budget()</tt> as well.
+		@return whether there's a forced win, or <tt>false</tt> if the
+			game is over
+		*/
+		bool forcesWin( void );
+		
+		/**
+		Reports how far the last <tt>nextGoodState()</tt> could see.
+		@return the horizon, in plies, of its deepest finished
+			search, or <tt>0</tt> if it proved its move best
+		*/
+		unsigned int horizon( void ) const;
+		
 		/**
 		Manually make <i>one</i> move and advances the game to the
 			specified outcome state.
@@ -121,6 +1602,17 @@ template< typename State > class Solver
 			<tt>false</tt> otherwise
 		*/
 		bool supplyNextState( const State& future );
+		
+		/**
+		Moves to an arbitrary position, as for a fresh query, keeping
+			everything learned so far.  This is only possible
+			within the same variant of the game, as named by the
+			<tt>State</tt>'s <tt>variant()</tt>.
+		@param position the new current state
+		@return whether we moved, rather than it belonging to another
+			variant
+		*/
+		bool reposition( const State& position );
 };
 
 #include "Solver.t.h"
@@ -16,142 +16,2067 @@
 
 /** @author Sol Boucher <slb1566@rit.edu> */
 //included from "Solver.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <climits>
 #include <iostream>
+#include <type_traits>
 #include <vector>
 
 /** @brief Constructor */
-template< typename State >
-Solver< State >::Solver( const State& initial ):
-	current( initial ), remembered() {}
+template< typename State, class Traits >
+Solver< State, Traits >::Solver( const State& initial ):
+	current( initial ), remembered(), engine( remembered ),
+	splitDepth( DEFAULT_SPLIT_DEPTH ), heuristics( ALL_ORDERINGS ),
+	shared( NULL ), pool( NULL ), workers(), library(), memoBudget( 0 ),
+	ledger(), guesses(), lookahead(), orders(), reach( 0 ),
+	sweeping( false ), proofs(), frontier(), network( NULL ) {}
 
 /** @brief Destructor */
-template< typename State >
-Solver< State >::~Solver() {}
+template< typename State, class Traits >
+Solver< State, Traits >::~Solver()
+{
+	delete network; //before the memo the other nodes are still asking
+	network=NULL;
+	parallelize( 1 );
+}
+
+/** @brief ConSTRUCTor */
+template< typename State, class Traits >
+Solver< State, Traits >::Record::Record():
+	value( typename State::Score() ), bound( EXACT ), choice( 0 )
+{
+	#ifdef DEBUG
+		std::cout<<"New record w/ score of "<<int( value )<<std::endl;
+	#endif
+}
+
+/** @brief Unpacking constructor */
+template< typename State, class Traits >
+Solver< State, Traits >::Record::Record( unsigned int packed ):
+	value( static_cast< signed char >( ( packed-1 )/3+State::LOSS ) ),
+	bound( static_cast< unsigned char >( ( packed-1 )%3 ) ), choice(
+	static_cast< unsigned short >( NO_MOVE ) ) {}
+
+/** @brief Squeeze */
+template< typename State, class Traits >
+unsigned int Solver< State, Traits >::Record::pack() const
+{
+	return ( value-State::LOSS )*3+bound+1;
+}
+
+/** @brief Constructor */
+template< typename State, class Traits >
+Solver< State, Traits >::Guess::Guess():
+	value( 0 ), bound( EXACT ), draft( 0 ), choice( 0 ) {}
+
+/** @brief Constructor */
+template< typename State, class Traits >
+Solver< State, Traits >::Proof::Proof():
+	proof( 1 ), disproof( 1 ) {}
+
+/** @brief Constructor */
+template< typename State, class Traits >
+Solver< State, Traits >::Cancellation::Cancellation( const Cancellation*
+	origin ):
+	flag( false ), parent( origin ) {}
+
+/** @brief Give up! */
+template< typename State, class Traits >
+void Solver< State, Traits >::Cancellation::raise()
+{
+	flag.store( true, std::memory_order_relaxed );
+}
+
+/** @brief Should we give up? */
+template< typename State, class Traits >
+bool Solver< State, Traits >::Cancellation::raised() const
+{
+	for( const Cancellation* level=this; level!=NULL;
+		level=level->parent )
+		if( level->flag.load( std::memory_order_relaxed ) )
+			return true;
+	
+	return false;
+}
+
+/** @brief Constructor */
+template< typename State, class Traits >
+Solver< State, Traits >::Allowance::Allowance( double seconds, uint64_t limit
+	):
+	deadline( std::chrono::steady_clock::now()+std::chrono::duration_cast<
+	std::chrono::steady_clock::duration >( std::chrono::duration< double
+	>( seconds ) ) ), timed( seconds>0 ), positions( limit ), visited( 0 ),
+	binding( false ), spent( false ) {}
+
+/** @brief Time's up? */
+template< typename State, class Traits >
+bool Solver< State, Traits >::Allowance::exhausted()
+{
+	const uint64_t CLOCK_INTERVAL=256; //reading the clock isn't free
+	
+	++visited;
+	if( binding && ( ( positions!=0 && visited>positions ) || ( timed &&
+		visited%CLOCK_INTERVAL==0 && std::chrono::steady_clock::now()>=
+		deadline ) ) )
+		spent=true;
+	
+	return spent;
+}
+
+/** @brief Ask the state */
+template< typename State, class Traits >
+void Solver< State, Traits >::suggest( const State& state, unsigned int count,
+	std::vector< unsigned int >& order, Choice< true > )
+{
+	state.orderedSuccessors( order );
+	assert( order.size()==count );
+}
+
+/** @brief Take them as they come */
+template< typename State, class Traits >
+void Solver< State, Traits >::suggest( const State&, unsigned int count,
+	std::vector< unsigned int >& order, Choice< false > )
+{
+	for( unsigned int index=0; index<count; ++index )
+		order.push_back( index );
+}
+
+/** @brief Key an index */
+template< typename State, class Traits >
+void Solver< State, Traits >::identify( uint64_t index, std::string& bytes )
+{
+	Encoding::appendVarint( bytes, index );
+}
+
+/** @brief Constructor */
+template< typename State, class Traits >
+Solver< State, Traits >::Collector::Collector( std::vector< typename
+	Library::Entry >& list ):
+	entries( list ) {}
+
+/** @brief Gather a position */
+template< typename State, class Traits >
+void Solver< State, Traits >::Collector::operator()( const State& key, const
+	Record& value )
+{
+	entries.push_back( typename Library::Entry( std::string(), value ) );
+	Traits::identify( key, entries.back().first );
+}
+
+/** @brief Gather an index */
+template< typename State, class Traits >
+void Solver< State, Traits >::Collector::operator()( uint64_t index, const
+	Record& value )
+{
+	entries.push_back( typename Library::Entry( std::string(), value ) );
+	identify( index, entries.back().first );
+}
+
+/** @brief Gather bytes */
+template< typename State, class Traits >
+void Solver< State, Traits >::Collector::operator()( const std::string& key,
+	const Record& value )
+{
+	entries.push_back( typename Library::Entry( key, value ) );
+}
+
+/** @brief Constructor */
+template< typename State, class Traits >
+Solver< State, Traits >::Unreachable::Unreachable( const State& current ):
+	left( current.remaining() ) {}
+
+/** @brief Check */
+template< typename State, class Traits >
+bool Solver< State, Traits >::Unreachable::operator()( const State& key, const
+	Record& ) const
+{
+	return key.remaining()>left;
+}
+
+/** @brief Check */
+template< typename State, class Traits >
+bool Solver< State, Traits >::Credible::operator()( const Record& record )
+	const
+{
+	return record.value>=State::LOSS && record.value<=State::VICTORY &&
+		record.bound<=UPPER;
+}
+
+/** @brief Weed out the past */
+template< typename State, class Traits >
+uint64_t Solver< State, Traits >::sweep( Choice< true > )
+{
+	Unreachable past( current );
+	uint64_t removed=remembered.sweep( past );
+	
+	if( shared!=NULL ) removed+=shared->sweep( past );
+	
+	return removed;
+}
+
+/** @brief Keep the past */
+template< typename State, class Traits >
+uint64_t Solver< State, Traits >::sweep( Choice< false > )
+{
+	return 0;
+}
+
+/** @brief What would the current player say? */
+template< typename State, class Traits >
+bool Solver< State, Traits >::prefersScore( const State& state, typename
+	State::Score incumbent, typename State::Score alternative )
+{
+	if( state.computersTurn() )
+		return alternative>incumbent; //the machine accepts a machine
+			//win
+	else //human's turn
+		return alternative<incumbent; //the human rejects a machine win
+}
+
+/** @brief Current state */
+template< typename State, class Traits >
+const State& Solver< State, Traits >::getCurrentState() const
+{
+	return current;
+}
+
+/** @brief How deep have we been? */
+template< typename State, class Traits >
+unsigned int Solver< State, Traits >::peakDepth() const
+{
+	unsigned int peak=engine.peakDepth();
+	
+	for( typename std::vector< Engine< SharedMemo >* >::const_iterator
+		worker=workers.begin(); worker!=workers.end(); ++worker )
+		if( ( *worker )->peakDepth()>peak )
+			peak=( *worker )->peakDepth();
+	
+	return peak;
+}
+
+/** @brief What have we been through? */
+template< typename State, class Traits >
+SolverStatistics Solver< State, Traits >::statistics() const
+{
+	SolverStatistics total=ledger;
+	
+	engine.tally( total );
+	for( typename std::vector< Engine< SharedMemo >* >::const_iterator
+		worker=workers.begin(); worker!=workers.end(); ++worker )
+		( *worker )->tally( total );
+	if( shared!=NULL )
+		shared->tally( total.memo );
+	remembered.tally( total.memo );
+	if( network!=NULL ) total.positions+=network->visited();
+	if( peakDepth()>total.peakDepth ) total.peakDepth=peakDepth();
+	
+	return total;
+}
+
+/** @brief Forget the past */
+template< typename State, class Traits >
+uint64_t Solver< State, Traits >::sweep()
+{
+	return sweep( Choice< Traits::measured >() );
+}
+
+/** @brief Keep forgetting */
+template< typename State, class Traits >
+void Solver< State, Traits >::tidy( bool enabled )
+{
+	sweeping=enabled;
+}
+
+/** @brief How many hands? */
+template< typename State, class Traits >
+void Solver< State, Traits >::parallelize( unsigned int threads, unsigned int
+	depth )
+{
+	if( threads==0 ) threads=WorkerPool::available();
+	if( network!=NULL ) threads=network->hands();
+	splitDepth=depth;
+	
+	bool sharing=threads>1 || network!=NULL; //even one thread shares its
+		//memo with the other nodes
+	
+	if( ( pool!=NULL )==sharing && threads==( pool==NULL ? 1 : pool->size()
+		) )
+		return; //no change
+	
+	//forget the old arrangement, but not what it went through:
+	for( typename std::vector< Engine< SharedMemo >* >::iterator
+		worker=workers.begin(); worker!=workers.end(); ++worker )
+	{
+		if( ( *worker )->peakDepth()>ledger.peakDepth )
+			ledger.peakDepth=( *worker )->peakDepth();
+		( *worker )->tally( ledger );
+		delete *worker;
+	}
+	workers.clear();
+	delete pool;
+	pool=NULL;
+	if( shared!=NULL )
+	{
+		TableStatistics retired;
+		
+		shared->tally( retired );
+		retired.entries=0; //it won't hold them any longer
+		retired.capacity=0;
+		ledger.memo.add( retired );
+	}
+	delete shared;
+	shared=NULL;
+	remembered.limit( sharing ? 0 : memoBudget ); //purging it, and only
+		//holding onto the memory if we'll use it
+	
+	if( sharing ) //set up the new one
+	{
+		shared=new SharedMemo();
+		shared->limit( memoBudget );
+		pool=new WorkerPool( threads );
+		for( unsigned int worker=0; worker<threads; ++worker )
+		{
+			workers.push_back( new Engine< SharedMemo >( *shared ) );
+			workers.back()->orderMoves( heuristics );
+			workers.back()->consult( library.isOpen() ? &library :
+				NULL );
+		}
+	}
+}
+
+/** @brief Join forces */
+template< typename State, class Traits >
+bool Solver< State, Traits >::distribute( const char* hosts, unsigned int node,
+	unsigned int depth )
+{
+	if( !Traits::decodable ) return false; //we couldn't send positions
+	
+	delete network;
+	network=new Node( *this );
+	if( node>0 ) parallelize( 1, depth ); //ready for the others'
+		//questions before they can ask any
+	if( !network->enlist( hosts, node ) )
+	{
+		delete network;
+		network=NULL;
+		parallelize( 1, depth );
+		
+		return false;
+	}
+	parallelize( 1, depth ); //with a thread for each other node
+	
+	if( node>0 )
+		workers[0]->partake( network );
+	else //make sure everyone's playing the same game
+		for( unsigned int peer=1; peer<network->cluster.size(); ++peer )
+			network->cluster.send( peer, 'V', current.variant() );
+	
+	return true;
+}
+
+/** @brief Take orders */
+template< typename State, class Traits >
+bool Solver< State, Traits >::serve()
+{
+	assert( network!=NULL && network->cluster.self()>0 );
+	
+	return network->serve();
+}
+
+/** @brief Reorder */
+template< typename State, class Traits >
+void Solver< State, Traits >::orderMoves( unsigned int which )
+{
+	heuristics=which;
+	engine.orderMoves( which );
+	for( typename std::vector< Engine< SharedMemo >* >::iterator
+		worker=workers.begin(); worker!=workers.end(); ++worker )
+		( *worker )->orderMoves( which );
+}
+
+/** @brief Tighten the belt */
+template< typename State, class Traits >
+bool Solver< State, Traits >::budget( uint64_t bytes )
+{
+	memoBudget=bytes;
+	
+	return shared!=NULL ? shared->limit( bytes ) : remembered.limit( bytes
+		);
+}
+
+/** @brief Open the books */
+template< typename State, class Traits >
+bool Solver< State, Traits >::consult( const char* path )
+{
+	bool opened=library.open( path, current.variant(), Credible() );
+	const Library* database=opened ? &library : NULL;
+	
+	engine.consult( database );
+	for( typename std::vector< Engine< SharedMemo >* >::iterator
+		worker=workers.begin(); worker!=workers.end(); ++worker )
+		( *worker )->consult( database );
+	
+	return opened;
+}
+
+/** @brief Write the books */
+template< typename State, class Traits >
+bool Solver< State, Traits >::record( const char* path ) const
+{
+	std::vector< typename Library::Entry > entries;
+	Collector collector( entries );
+	
+	if( shared!=NULL )
+		shared->visit( collector );
+	else //just us
+		remembered.visit( collector );
+	library.visit( collector ); //after ours, so that ours take precedence
+	
+	return Library::save( path, current.variant(), entries );
+}
+
+/** @brief Bottom-up solver */
+template< typename State, class Traits >
+uint64_t Solver< State, Traits >::tabulate()
+{
+	std::vector< std::vector< State > > layers( current.remaining()+1 );
+	MoveBuffer< State > successors;
+	typename Memo::Locator where;
+	uint64_t positions=0;
+	
+	parallelize( 1, splitDepth ); //just us
+	budget( 0 ); //so that all it holds, and keeps, is what we enumerate
+	
+	//find everything reachable, marking it in the memo as we go:
+	remembered.find( current, where );
+	if( !remembered.store( where, current, Record() ) ) return 0;
+	layers.back().push_back( current );
+	for( unsigned int layer=layers.size(); layer-->0; )
+		for( unsigned int position=0; position<layers[layer].size();
+			++position )
+		{
+			const State& state=layers[layer][position]; //only lower
+				//layers grow while we're here
+			
+			if( state.gameOver() ) continue;
+			successors.clear(); //but hang onto its storage
+			Traits::successors( state, successors );
+			for( unsigned int index=0; index<successors.size();
+				++index )
+				if( remembered.find( successors[index], where )==
+					NULL ) //new to us
+				{
+					assert( successors[index].remaining()<
+						layer );
+					if( !remembered.store( where,
+						successors[index], Record() ) )
+					{
+						remembered.purge();
+						return 0;
+					}
+					layers[successors[index].remaining()].
+						push_back( successors[index] );
+				}
+		}
+	
+	//decide it, from the end of the game back:
+	for( unsigned int layer=0; layer<layers.size(); ++layer )
+	{
+		for( unsigned int position=0; position<layers[layer].size();
+			++position )
+		{
+			const State& state=layers[layer][position];
+			Record decision;
+			
+			if( state.gameOver() )
+				decision.value=state.scoreGame();
+			else //its successors are all in earlier layers
+			{
+				successors.clear(); //but hang onto its storage
+				Traits::successors( state, successors );
+				for( unsigned int index=0; index<successors.size();
+					++index )
+				{
+					const Record* known=remembered.find(
+						successors[index], where );
+					
+					assert( known!=NULL );
+					if( index==0 || prefersScore( state,
+						typename State::Score(
+						decision.value ), typename
+						State::Score( known->value ) ) )
+					{
+						decision.value=known->value;
+						decision.choice=index;
+					}
+				}
+			}
+			
+			decision.bound=EXACT;
+			remembered.find( state, where );
+			remembered.store( where, state, decision );
+			++positions;
+		}
+		
+		std::vector< State >().swap( layers[layer] ); //no longer needed
+	}
+	
+	return positions;
+}
+
+/** @brief Constructor */
+template< typename State, class Traits >
+template< class Table >
+Solver< State, Traits >::Engine< Table >::Engine( Table& memo ):
+	remembered( memo ), frames(), peak( 0 ),
+	counts(), heuristics( ALL_ORDERINGS ), killers(), history(), library(
+	NULL ), scratch(), checking(), partition( NULL )
+{
+	frames.reserve( RESERVED_FRAMES );
+}
+
+/** @brief Constructor */
+template< typename State, class Traits >
+template< class Table >
+Solver< State, Traits >::Engine< Table >::ByHistory::ByHistory( const
+	std::vector< unsigned int >& table ):
+	scores( table ) {}
+
+/** @brief Better record? */
+template< typename State, class Traits >
+template< class Table >
+bool Solver< State, Traits >::Engine< Table >::ByHistory::operator()( unsigned
+	int first, unsigned int second ) const
+{
+	return ( first<scores.size() ? scores[first] : 0 )>( second<
+		scores.size() ? scores[second] : 0 );
+}
+
+/** @brief Reorder */
+template< typename State, class Traits >
+template< class Table >
+void Solver< State, Traits >::Engine< Table >::orderMoves( unsigned int which )
+{
+	heuristics=which;
+	killers.clear();
+	history.clear();
+}
+
+/** @brief Pick a database */
+template< typename State, class Traits >
+template< class Table >
+void Solver< State, Traits >::Engine< Table >::consult( const Library* database
+	)
+{
+	library=database;
+}
+
+/** @brief Check the database */
+template< typename State, class Traits >
+template< class Table >
+const typename Solver< State, Traits >::Record* Solver< State, Traits >::Engine<
+	Table >::lookUp( const State& state )
+{
+	if( library==NULL ) return NULL;
+	
+	scratch.clear(); //but hang onto its storage
+	Traits::identify( state, scratch );
+	
+	const Record* known=library->find( scratch );
+	
+	if( known!=NULL && known->choice>0 && known->choice!=NO_MOVE ) //the
+		//first is always there, and NO_MOVE only says it wasn't kept
+	{
+		checking.clear(); //but hang onto its storage
+		Traits::successors( state, checking );
+		if( known->choice>=checking.size() ) return NULL; //that's
+			//not one of ours, so we can't trust the rest either
+	}
+	
+	return known;
+}
+
+/** @brief Line them up */
+template< typename State, class Traits >
+template< class Table >
+void Solver< State, Traits >::Engine< Table >::arrange( const State& state,
+	unsigned int count, unsigned int hint, unsigned int ply, unsigned int
+	allowed, std::vector< unsigned int >& order ) const
+{
+	unsigned int enabled=heuristics&allowed;
+	
+	order.clear(); //but hang onto its storage
+	suggest( state, count, order, Choice< Traits::ordered >() );
+	
+	//a state that ranks its own moves knows best which one to try first,
+	//whereas history only stands in for such judgement where there is none:
+	std::vector< unsigned int >::iterator rest=order.begin();
+	if( Traits::ordered )
+	{
+		if( rest!=order.end() ) ++rest;
+	}
+	else if( enabled&HISTORY_SCORES && !history.empty() )
+		std::stable_sort( order.begin(), order.end(), ByHistory(
+			history ) );
+	
+	//the later we promote a move, the further forward it ends up (and
+	//a successor's index only names a comparable move from one position
+	//to the next where the state has taken the trouble to rank them):
+	if( Traits::ordered && enabled&KILLER_MOVES &&
+		2*ply+1<killers.size() )
+		for( unsigned int killer=2*ply+2; killer-->2*ply; )
+		{
+			std::vector< unsigned int >::iterator found=std::find(
+				rest, order.end(), killers[killer] );
+			
+			if( found!=order.end() )
+				std::rotate( rest, found, found+1 );
+		}
+	if( enabled&STORED_MOVE && hint<count )
+	{
+		std::vector< unsigned int >::iterator found=std::find(
+			order.begin(), order.end(), hint );
+		
+		assert( found!=order.end() );
+		std::rotate( order.begin(), found, found+1 );
+	}
+}
+
+/** @brief Remember the refutation */
+template< typename State, class Traits >
+template< class Table >
+void Solver< State, Traits >::Engine< Table >::reward( unsigned int ply,
+	unsigned int index )
+{
+	if( heuristics&KILLER_MOVES && Traits::ordered ) //likewise
+	{
+		if( 2*ply+1>=killers.size() )
+			killers.resize( 2*ply+2, static_cast< unsigned int >(
+				NO_MOVE ) );
+		if( killers[2*ply]!=index ) //make it the newest killer
+		{
+			killers[2*ply+1]=killers[2*ply];
+			killers[2*ply]=index;
+		}
+	}
+	
+	if( heuristics&HISTORY_SCORES && !Traits::ordered ) //else
+		//arrange() won't look
+	{
+		if( index>=history.size() ) history.resize( index+1, 0 );
+		++history[index];
+	}
+}
+
+/** @brief How deep have we been? */
+template< typename State, class Traits >
+template< class Table >
+unsigned int Solver< State, Traits >::Engine< Table >::peakDepth() const
+{
+	return peak;
+}
+
+/** @brief Join the cluster's memo */
+template< typename State, class Traits >
+template< class Table >
+void Solver< State, Traits >::Engine< Table >::partake( Node* node )
+{
+	partition=node;
+}
+
+/** @brief What have we visited? */
+template< typename State, class Traits >
+template< class Table >
+void Solver< State, Traits >::Engine< Table >::tally( SolverStatistics& into )
+	const
+{
+	into.add( counts );
+}
+
+/** @brief Settle it without looking further? */
+template< typename State, class Traits >
+template< class Table >
+bool Solver< State, Traits >::Engine< Table >::recall( const State& state,
+	typename State::Score alpha, typename State::Score beta, Record& decision,
+	Locator& where, unsigned int& hint )
+{
+	const Record* known;
+	int winning;
+	
+	hint=NO_MOVE;
+	++counts.positions;
+	if( state.gameOver() )
+	{
+		++counts.terminals;
+		decision.value=state.scoreGame();
+		decision.bound=EXACT;
+		decision.choice=0;
+		
+		return true;
+	}
+	
+	if( ( known=remembered.find( state, where ) )!=NULL )
+		++counts.memoHits;
+	else //not in this run, but maybe in an earlier one
+	{
+		++counts.memoMisses;
+		if( ( known=lookUp( state ) )!=NULL ) ++counts.libraryHits;
+	}
+	if( known!=NULL ) //we've evaluated this case before
+	{
+		if( known->bound==EXACT || ( known->bound==LOWER &&
+			known->value>=beta ) || ( known->bound==UPPER &&
+			known->value<=alpha ) ) //and learned enough
+		{
+			#ifdef DEBUG
+				std::cout<<"Memoization saved us work for "
+					<<state.str()<<std::endl;
+			#endif
+			decision=*known;
+			
+			return true;
+		}
+		//else it was outside the window we were interested in then,
+		//but its choice is still a good place to start
+		hint=known->choice;
+	}
+	
+	if( Traits::pruning && ( winning=Traits::winner( state ) )>=0 )
+		//nothing beats winning on the spot, so don't bother with the rest
+	{
+		decision.value=state.computersTurn() ? State::VICTORY :
+			State::LOSS;
+		decision.bound=EXACT;
+		decision.choice=winning;
+		
+		return true;
+	}
+	
+	return false;
+}
+
+/** @brief Weigh one successor */
+template< typename State, class Traits >
+template< class Table >
+bool Solver< State, Traits >::Engine< Table >::consider( const State& state,
+	unsigned int index, bool eldest, const Record& candidate, Record& decision,
+	typename State::Score& alpha, typename State::Score& beta ) const
+{
+	if( eldest || prefersScore( state, typename State::Score(
+		decision.value ), typename State::Score( candidate.value ) ) )
+	{
+		decision.choice=index;
+		decision.value=candidate.value;
+	}
+	
+	if( Traits::pruning ) //narrow the window
+	{
+		if( state.computersTurn() && decision.value>alpha )
+			alpha=typename State::Score( decision.value );
+		else if( !state.computersTurn() && decision.value<beta )
+			beta=typename State::Score( decision.value );
+		
+		return alpha>=beta; //the other player won't allow this
+	}
+	
+	return false;
+}
+
+/** @brief Decide and remember */
+template< typename State, class Traits >
+template< class Table >
+void Solver< State, Traits >::Engine< Table >::conclude( const State& state,
+	typename State::Score alpha, typename State::Score beta, Record& decision,
+	Locator& where, unsigned int ply )
+{
+	if( decision.value<=alpha && decision.value>State::LOSS )
+		decision.bound=UPPER; //everything failed low
+	else if( decision.value>=beta && decision.value<State::VICTORY )
+		decision.bound=LOWER; //something failed high
+	else //nothing can be better or worse than the extremes
+		decision.bound=EXACT;
+	
+	remembered.store( where, state, decision, ply<UCHAR_MAX ? UCHAR_MAX-ply :
+		0 ); //cherish this moment, picking up right where our lookup
+		//left off
+	if( partition!=NULL ) partition->share( state, decision, ply );
+	
+	#ifdef DEBUG
+		std::cout<<"Given "<<state.str()<<" chose successor "
+			<<decision.choice<<" for victory rating "
+			<<int( decision.value )<<std::endl;
+	#endif
+}
+
+/** @brief Either solver */
+template< typename State, class Traits >
+template< class Table >
+bool Solver< State, Traits >::Engine< Table >::search( const State& state,
+	typename State::Score alpha, typename State::Score beta, Record& result,
+	const Cancellation* cancel, unsigned int ply )
+{
+	if( Traits::iterative )
+		return iterateBestState( state, alpha, beta, result, cancel,
+			ply );
+	else //on the thread's own stack
+		return nextBestState( state, alpha, beta, result, cancel, ply,
+			0 );
+}
+
+/** @brief Solver/bruteforcer */
+template< typename State, class Traits >
+template< class Table >
+bool Solver< State, Traits >::Engine< Table >::nextBestState( const State&
+	state, typename State::Score alpha, typename State::Score beta, Record&
+	decision, const Cancellation* cancel, unsigned int ply, unsigned int depth )
+{
+	static_assert( std::is_nothrow_move_constructible< Frame >::value,
+		"growing the frames mustn't move the positions in them" );
+	Locator where;
+	unsigned int hint;
+	
+	if( recall( state, alpha, beta, decision, where, hint ) ) return true;
+	if( cancel!=NULL && cancel->raised() ) return false; //never mind
+	
+	//this situation is new to us, at least as far as this window goes
+	typename State::Score originalAlpha=alpha, originalBeta=beta;
+	if( depth==frames.size() ) frames.push_back( Frame() ); //invalidates
+		//references to the frames, but not to the positions in them
+	frames[depth].successors.clear(); //but hang onto its storage
+	Traits::successors( state, frames[depth].successors );
+	assert( frames[depth].successors.size()<=MAX_SUCCESSORS );
+	if( partition!=NULL )
+		partition->anticipate( frames[depth].successors, ply+1 );
+	arrange( state, frames[depth].successors.size(), hint, ply,
+		ALL_ORDERINGS, frames[depth].order );
+	if( depth+1>peak ) peak=depth+1;
+	
+	for( unsigned int rank=0; rank<frames[depth].order.size(); ++rank )
+	{
+		unsigned int follower=frames[depth].order[rank];
+		Record ofTheMoment;
+		if( !nextBestState( frames[depth].successors[follower], alpha,
+			beta, ofTheMoment, cancel, ply+1, depth+1 ) )
+			return false; //without memoizing a half-baked result
+		
+		if( consider( state, follower, rank==0, ofTheMoment, decision,
+			alpha, beta ) )
+		{
+			reward( ply, follower );
+			break;
+		}
+	}
+	
+	conclude( state, originalAlpha, originalBeta, decision, where, ply );
+	
+	return true;
+}
+
+/** @brief Ready a stack frame */
+template< typename State, class Traits >
+template< class Table >
+void Solver< State, Traits >::Engine< Table >::prepare( unsigned int depth,
+	const State& state, typename State::Score alpha, typename State::Score beta,
+	const Locator& where, unsigned int hint, unsigned int ply )
+{
+	assert( depth<frames.size() );
+	
+	Frame& frame=frames[depth];
+	
+	frame.successors.clear(); //but hang onto its storage
+	Traits::successors( state, frame.successors );
+	assert( frame.successors.size()<=MAX_SUCCESSORS );
+	if( partition!=NULL ) partition->anticipate( frame.successors, ply+1 );
+	arrange( state, frame.successors.size(), hint, ply, ALL_ORDERINGS,
+		frame.order );
+	frame.next=0;
+	frame.alpha=frame.originalAlpha=alpha;
+	frame.beta=frame.originalBeta=beta;
+	frame.decision=Record();
+	frame.where=where;
+	
+	if( depth+1>peak ) peak=depth+1;
+}
+
+/** @brief Who's in this frame? */
+template< typename State, class Traits >
+template< class Table >
+const State& Solver< State, Traits >::Engine< Table >::expanding( unsigned int
+	depth, const State& root ) const
+{
+	if( depth==0 )
+		return root;
+	else //it's whichever successor our parent is looking at
+		return frames[depth-1].successors[frames[depth-1].order[
+			frames[depth-1].next]];
+}
+
+/** @brief Stackless solver/bruteforcer */
+template< typename State, class Traits >
+template< class Table >
+bool Solver< State, Traits >::Engine< Table >::iterateBestState( const State&
+	root, typename State::Score alpha, typename State::Score beta, Record&
+	result, const Cancellation* cancel, unsigned int ply )
+{
+	Locator where;
+	unsigned int hint;
+	unsigned int depth=0;
+	
+	if( recall( root, alpha, beta, result, where, hint ) ) return true;
+	if( cancel!=NULL && cancel->raised() ) return false; //never mind
+	
+	if( frames.empty() ) frames.push_back( Frame() );
+	prepare( depth, root, alpha, beta, where, hint, ply );
+	
+	for( ;; )
+	{
+		Frame& frame=frames[depth];
+		
+		if( frame.next<frame.order.size() ) //more to examine
+		{
+			unsigned int follower=frame.order[frame.next];
+			Record ofTheMoment;
+			
+			if( recall( frame.successors[follower], frame.alpha,
+				frame.beta, ofTheMoment, where, hint ) )
+				//settled
+			{
+				if( consider( expanding( depth, root ),
+					follower, frame.next==0, ofTheMoment,
+					frame.decision, frame.alpha,
+					frame.beta ) )
+				{
+					reward( ply+depth, follower );
+					frame.next=frame.order.size();
+				}
+				else
+					++frame.next;
+			}
+			else if( cancel!=NULL && cancel->raised() ) //never mind
+				return false; //leaving the open frames unmemoized
+			else //we'll have to look deeper
+			{
+				typename State::Score alpha=frame.alpha,
+					beta=frame.beta;
+				
+				if( depth+1==frames.size() ) //out of frames
+					frames.push_back( Frame() ); //invalidates
+						//frame
+				++depth;
+				prepare( depth, expanding( depth, root ), alpha,
+					beta, where, hint, ply+depth );
+			}
+		}
+		else //we've seen everything we need to
+		{
+			conclude( expanding( depth, root ), frame.originalAlpha,
+				frame.originalBeta, frame.decision, frame.where,
+				ply+depth );
+			
+			if( depth==0 ) //all done
+			{
+				result=frame.decision;
+				
+				return true;
+			}
+			
+			Frame& parent=frames[--depth];
+			unsigned int follower=parent.order[parent.next];
+			
+			if( consider( expanding( depth, root ), follower,
+				parent.next==0, frame.decision,
+				parent.decision, parent.alpha, parent.beta ) )
+			{
+				reward( ply+depth, follower );
+				parent.next=parent.order.size();
+			}
+			else
+				++parent.next;
+		}
+	}
+}
+
+/** @brief Constructor */
+template< typename State, class Traits >
+Solver< State, Traits >::Split::Split( Solver& searcher, const State& position,
+	typename State::Score low, typename State::Score high, unsigned int
+	distance, const Cancellation& origin, const std::vector< Split* >&
+	brothers, unsigned int order, bool max ):
+	result(), completed( false ), cancel( &origin ), solver( searcher ),
+	state( position ), alpha( low ), beta( high ), ply( distance ),
+	siblings( brothers ), index( order ), maximizing( max ) {}
+
+/** @brief Search a younger sibling */
+template< typename State, class Traits >
+void Solver< State, Traits >::Split::run( unsigned int worker )
+{
+	completed=solver.splitBestState( worker, state, alpha, beta, ply,
+		result, cancel );
+	
+	if( completed && Traits::pruning && ( maximizing ?
+		result.value>=beta : result.value<=alpha ) ) //refuted the
+		//parent, so nobody after us matters
+		for( unsigned int younger=index+1; younger<siblings.size();
+			++younger )
+			siblings[younger]->cancel.raise();
+}
+
+/** @brief Parallel solver */
+template< typename State, class Traits >
+bool Solver< State, Traits >::splitBestState( unsigned int worker, const State&
+	state, typename State::Score alpha, typename State::Score beta, unsigned int
+	ply, Record& decision, const Cancellation& cancel )
+{
+	Engine< SharedMemo >& mine=*workers[worker];
+	
+	if( ply>=splitDepth ) //deep enough to go it alone
+		return network!=NULL ? network->delegate( worker, state, alpha,
+			beta, ply, decision, cancel ) : mine.search( state,
+			alpha, beta, decision, &cancel, ply );
+	
+	typename Engine< SharedMemo >::Locator where;
+	unsigned int hint;
+	
+	if( mine.recall( state, alpha, beta, decision, where, hint ) )
+		return true;
+	if( cancel.raised() ) return false; //never mind
+	
+	typename State::Score originalAlpha=alpha, originalBeta=beta;
+	MoveBuffer< State > successors;
+	std::vector< unsigned int > order;
+	Traits::successors( state, successors );
+	assert( successors.size()<=MAX_SUCCESSORS );
+	mine.arrange( state, successors.size(), hint, ply, 0, order ); //just
+		//the state's own ordering, since the others depend on which
+		//thread happened to search what, and we want the same answer
+		//every time
+	
+	//the eldest sets the window for everyone else:
+	Record eldest;
+	if( !splitBestState( worker, successors[order[0]], alpha, beta, ply+1,
+		eldest, cancel ) )
+		return false;
+	
+	if( !mine.consider( state, order[0], true, eldest, decision, alpha,
+		beta ) && order.size()>1 ) //we still need to hear from the rest
+	{
+		std::vector< Split* > younger;
+		TaskGroup group;
+		bool abandoned=false;
+		
+		for( unsigned int rank=1; rank<order.size(); ++rank )
+			younger.push_back( new Split( *this,
+				successors[order[rank]], alpha, beta, ply+1,
+				cancel, younger, rank-1,
+				state.computersTurn() ) );
+		for( typename std::vector< Split* >::iterator sibling=
+			younger.begin(); sibling!=younger.end(); ++sibling )
+			pool->spawn( worker, **sibling, group );
+		pool->wait( worker, group );
+		
+		//fold the results in order, as a serial search would have:
+		for( unsigned int rank=1; rank<order.size(); ++rank )
+		{
+			if( !younger[rank-1]->completed ) //we were cancelled
+			{
+				abandoned=true;
+				break;
+			}
+			
+			if( mine.consider( state, order[rank], false,
+				younger[rank-1]->result, decision, alpha,
+				beta ) )
+				break;
+		}
+		
+		for( typename std::vector< Split* >::iterator sibling=
+			younger.begin(); sibling!=younger.end(); ++sibling )
+			delete *sibling;
+		
+		if( abandoned ) return false;
+	}
+	
+	mine.conclude( state, originalAlpha, originalBeta, decision, where, ply
+		);
+	
+	return true;
+}
+
+/** @brief How often to check on an errand */
+template< typename State, class Traits >
+const unsigned int Solver< State, Traits >::Node::POLL_MILLISECONDS;
+
+/** @brief How long to wait for answers */
+template< typename State, class Traits >
+const unsigned int Solver< State, Traits >::Node::PATIENCE_MILLISECONDS;
+
+/** @brief Constructor */
+template< typename State, class Traits >
+Solver< State, Traits >::Node::Node( Solver& owner ):
+	solver( owner ), lock(), heard(), gone(), errands(), delegated( 0 ),
+	job(), hired( false ), recalled( false ), underway( NULL ),
+	dismissed( false ), mismatched( false ), shallowest( 0 ), serial( 0 ),
+	awaited( 0 ), asked(), askedPly( 0 ), cluster() {}
 
-/** @brief ConSTRUCTor */
-template< typename State >
-Solver< State >::StatePlusScore::StatePlusScore( State initial ):
-	config( initial ), value()
+/** @brief Sign up */
+template< typename State, class Traits >
+bool Solver< State, Traits >::Node::enlist( const char* hosts, unsigned int
+	self )
 {
-	#ifdef DEBUG
-		std::cout<<"New SPS w/ score of "<<value<<std::endl;
-	#endif
+	std::lock_guard< std::mutex > guard( lock ); //nobody hears from anyone
+		//before we've made room for them
+	
+	if( !cluster.join( hosts, self, *this ) ) return false;
+	
+	gone.assign( cluster.size(), false );
+	errands.assign( cluster.size(), Errand() );
+	asked.assign( cluster.size(), std::vector< const State* >() );
+	
+	return true;
 }
 
-/** @brief What would the current player say? */
-template< typename State >
-bool Solver< State >::StatePlusScore::prefersScore( typename State::Score
-	alternative ) const
+/** @brief How many threads? */
+template< typename State, class Traits >
+unsigned int Solver< State, Traits >::Node::hands() const
 {
-	if( config.computersTurn() )
-		return alternative>value; //the machine accepts a machine win
-	else //human's turn
-		return alternative<value; //the human rejects a machine win
+	return cluster.self()==0 && cluster.size()>1 ? cluster.size()-1 : 1;
 }
 
-/** @brief Configuration's hash code */
-template< typename State >
-int Solver< State >::StatePlusScore::hash() const
+/** @brief Whose is it? */
+template< typename State, class Traits >
+unsigned int Solver< State, Traits >::Node::owner( const State& state ) const
 {
-	return config.hash();
+	assert( cluster.size()>2 );
+	
+	return 1+unsigned( Traits::digest( state )%( cluster.size()-1 ) );
+		//anyone but the leader
 }
 
-/** @brief Configuration's identity verification */
-template< typename State >
-bool Solver< State >::StatePlusScore::operator==( const StatePlusScore&
-	another ) const
+/** @brief Wire a position */
+template< typename State, class Traits >
+void Solver< State, Traits >::Node::wrap( const State& state, std::string&
+	bytes, Choice< true > )
 {
-	return this->config==another.config;
+	state.encode( bytes );
 }
 
-/** @brief Current state */
-template< typename State >
-const State& Solver< State >::getCurrentState() const
+/** @brief Nothing to wire */
+template< typename State, class Traits >
+void Solver< State, Traits >::Node::wrap( const State&, std::string&, Choice<
+	false > ) {}
+
+/** @brief Wire a record */
+template< typename State, class Traits >
+void Solver< State, Traits >::Node::pack( const Record& record, std::string&
+	bytes )
 {
-	return current;
+	bytes.push_back( char( record.value ) );
+	bytes.push_back( char( record.bound ) );
+	Encoding::appendVarint( bytes, record.choice );
 }
 
-/** @brief Solver/bruteforcer */
-template< typename State >
-void Solver< State >::nextBestState( const
-	State& state, StatePlusScore& decision ) const
+/** @brief Unwire a record */
+template< typename State, class Traits >
+bool Solver< State, Traits >::Node::unpack( const char*& cursor, const char*
+	end, Record& record )
+{
+	const char* start=cursor;
+	uint64_t choice;
+	
+	if( end-cursor<2 ) return false;
+	
+	signed char value=static_cast< signed char >( *cursor++ );
+	unsigned char bound=static_cast< unsigned char >( *cursor++ );
+	
+	if( value<State::LOSS || value>State::VICTORY || bound>UPPER ||
+		!Encoding::readVarint( cursor, end, choice ) || choice>
+		NO_MOVE )
+	{
+		cursor=start;
+		
+		return false;
+	}
+	
+	record.value=value;
+	record.bound=bound;
+	record.choice=static_cast< unsigned short >( choice );
+	
+	return true;
+}
+
+/** @brief Take note */
+template< typename State, class Traits >
+void Solver< State, Traits >::Node::absorb( const char* payload, const char*
+	end )
+{
+	State position( solver.current ); //of the same variant
+	typename SharedMemo::Locator where;
+	uint64_t ply;
+	Record decision;
+	
+	if( !Encoding::readVarint( payload, end, ply ) || !unpack( payload, end,
+		decision ) || !Traits::decode( std::string( payload, end ),
+		position ) )
+		return;
+	
+	solver.shared->find( position, where );
+	solver.shared->store( where, position, decision, ply<UCHAR_MAX ?
+		UCHAR_MAX-ply : 0 ); //worth what it was to whoever decided it
+}
+
+/** @brief Tell what we know */
+template< typename State, class Traits >
+void Solver< State, Traits >::Node::reply( unsigned int peer, const char*
+	payload, const char* end )
+{
+	State position( solver.current );
+	typename SharedMemo::Locator where;
+	std::string answers;
+	const char* bytes;
+	const char* bytesEnd;
+	uint64_t ticket;
+	
+	if( !Encoding::readVarint( payload, end, ticket ) ) return;
+	
+	Encoding::appendVarint( answers, ticket );
+	while( Encoding::readRecord( payload, end, bytes, bytesEnd ) )
+	{
+		const Record* known=NULL;
+		
+		if( Traits::decode( std::string( bytes, bytesEnd ), position ) )
+			known=solver.shared->find( position, where );
+		answers.push_back( known!=NULL ? 1 : 0 );
+		if( known!=NULL ) pack( *known, answers );
+	}
+	cluster.send( peer, 'A', answers );
+}
+
+/** @brief Hear what they know */
+template< typename State, class Traits >
+void Solver< State, Traits >::Node::learn( unsigned int peer, const char*
+	payload, const char* end )
+{
+	typename SharedMemo::Locator where;
+	uint64_t ticket;
+	
+	if( !Encoding::readVarint( payload, end, ticket ) || ticket!=serial ||
+		asked[peer].empty() )
+		return; //we've stopped waiting for this one
+	
+	for( typename std::vector< const State* >::const_iterator state=
+		asked[peer].begin(); state!=asked[peer].end() && payload<end;
+		++state )
+	{
+		Record known;
+		
+		if( *payload++==0 ) continue; //they don't know either
+		if( !unpack( payload, end, known ) ) break;
+		if( solver.shared->find( **state, where )==NULL )
+			solver.shared->store( where, **state, known, askedPly<
+				UCHAR_MAX ? UCHAR_MAX-askedPly : 0 );
+	}
+	asked[peer].clear();
+	--awaited;
+}
+
+/** @brief Incoming */
+template< typename State, class Traits >
+void Solver< State, Traits >::Node::receive( unsigned int peer, char kind,
+	const char* payload, const char* end )
+{
+	switch( kind )
+	{
+		case 'S': //what someone decided about a position of ours
+			absorb( payload, end );
+			return;
+		
+		case 'Q': //what someone wants to know about them
+			reply( peer, payload, end );
+			return;
+	}
+	
+	std::lock_guard< std::mutex > guard( lock );
+	
+	switch( kind )
+	{
+		case 'V': //the leader's variant
+			if( std::string( payload, end )!=solver.current.variant()
+				)
+				mismatched=true;
+			break;
+		
+		case 'J': //a search from the leader
+			job.assign( payload, end );
+			hired=true;
+			recalled=false;
+			break;
+		
+		case 'C': //the leader calling it off
+			if( underway!=NULL ) underway->raise();
+			else recalled=true;
+			break;
+		
+		case 'R': //what a search we handed out decided
+		{
+			Errand& errand=errands[peer];
+			uint64_t positions;
+			
+			errand.completed=payload<end && *payload++!=0;
+			if( !unpack( payload, end, errand.result ) ||
+				!Encoding::readVarint( payload, end, positions ) )
+				errand.completed=false;
+			else
+				delegated+=positions;
+			errand.answered=true;
+			break;
+		}
+		
+		case 'A': //what someone knows about positions of theirs
+			learn( peer, payload, end );
+			break;
+	}
+	heard.notify_all();
+}
+
+/** @brief Somebody left */
+template< typename State, class Traits >
+void Solver< State, Traits >::Node::depart( unsigned int peer )
+{
+	std::lock_guard< std::mutex > guard( lock );
+	
+	gone[peer]=true;
+	if( !asked[peer].empty() ) //we'll hear no answer
+	{
+		asked[peer].clear();
+		--awaited;
+	}
+	if( peer==0 ) //no more orders
+	{
+		dismissed=true;
+		if( underway!=NULL ) underway->raise();
+	}
+	heard.notify_all();
+}
+
+/** @brief Hand it off */
+template< typename State, class Traits >
+bool Solver< State, Traits >::Node::delegate( unsigned int worker, const State&
+	state, typename State::Score alpha, typename State::Score beta, unsigned
+	int ply, Record& decision, const Cancellation& cancel )
+{
+	unsigned int peer=worker+1;
+	bool reachable=peer<cluster.size();
+	std::string order;
+	
+	if( reachable )
+	{
+		std::lock_guard< std::mutex > guard( lock );
+		
+		reachable=!gone[peer];
+		errands[peer].answered=false;
+	}
+	order.push_back( char( alpha ) );
+	order.push_back( char( beta ) );
+	Encoding::appendVarint( order, ply );
+	wrap( state, order, Choice< Traits::decodable >() );
+	
+	if( reachable && cluster.send( peer, 'J', order ) )
+	{
+		std::unique_lock< std::mutex > guard( lock );
+		bool called=false;
+		
+		while( !errands[peer].answered && !gone[peer] )
+		{
+			heard.wait_for( guard, std::chrono::milliseconds(
+				POLL_MILLISECONDS ) );
+			if( !called && cancel.raised() ) //pass it on, but still
+				//wait to hear that they've stopped
+			{
+				called=true;
+				guard.unlock();
+				cluster.send( peer, 'C', std::string() );
+				guard.lock();
+			}
+		}
+		if( errands[peer].answered )
+		{
+			decision=errands[peer].result;
+			
+			return errands[peer].completed;
+		}
+	}
+	
+	//they've gone, so we'll have to do it ourselves:
+	return solver.workers[worker]->search( state, alpha, beta, decision,
+		&cancel, ply );
+}
+
+/** @brief Spread the word */
+template< typename State, class Traits >
+void Solver< State, Traits >::Node::share( const State& state, const Record&
+	decision, unsigned int ply )
+{
+	if( ply>=shallowest+SHARED_PLIES || cluster.size()<=2 ) return; //only
+		//one node holds everything
+	
+	unsigned int holder=owner( state );
+	std::string news;
+	
+	if( holder==cluster.self() ) return; //we already have it
+	
+	Encoding::appendVarint( news, ply );
+	pack( decision, news );
+	wrap( state, news, Choice< Traits::decodable >() );
+	cluster.post( holder, 'S', news );
+}
+
+/** @brief Ask around */
+template< typename State, class Traits >
+void Solver< State, Traits >::Node::anticipate( const MoveBuffer< State >&
+	successors, unsigned int ply )
+{
+	if( ply>=shallowest+SHARED_PLIES || cluster.size()<=2 ) return;
+	
+	std::vector< std::string > questions( cluster.size() );
+	std::vector< std::vector< const State* > > subjects( cluster.size() );
+	typename SharedMemo::Locator where;
+	std::string bytes;
+	uint64_t ticket;
+	unsigned int askees=0;
+	
+	{
+		std::lock_guard< std::mutex > guard( lock );
+		
+		ticket=++serial;
+	}
+	for( unsigned int index=0; index<successors.size(); ++index )
+	{
+		const State& successor=successors[index];
+		unsigned int holder;
+		
+		if( successor.gameOver() || ( holder=owner( successor ) )==
+			cluster.self() || solver.shared->find( successor, where )
+			!=NULL )
+			continue; //there's nothing we'd learn
+		
+		if( questions[holder].empty() )
+		{
+			Encoding::appendVarint( questions[holder], ticket );
+			++askees;
+		}
+		bytes.clear();
+		wrap( successor, bytes, Choice< Traits::decodable >() );
+		Encoding::appendVarint( questions[holder], bytes.size() );
+		questions[holder].append( bytes );
+		subjects[holder].push_back( &successor );
+	}
+	if( askees==0 ) return;
+	
+	std::unique_lock< std::mutex > guard( lock );
+	std::chrono::steady_clock::time_point deadline=
+		std::chrono::steady_clock::now()+std::chrono::milliseconds(
+		PATIENCE_MILLISECONDS );
+	
+	asked.swap( subjects );
+	awaited=askees;
+	askedPly=ply;
+	for( unsigned int peer=0; peer<questions.size(); ++peer )
+		if( !questions[peer].empty() )
+		{
+			bool sent;
+			
+			guard.unlock();
+			sent=cluster.send( peer, 'Q', questions[peer] );
+			guard.lock();
+			if( !sent && !asked[peer].empty() ) //they've gone
+			{
+				asked[peer].clear();
+				--awaited;
+			}
+		}
+	while( awaited>0 && heard.wait_until( guard, deadline )!=
+		std::cv_status::timeout );
+	
+	++serial; //whatever's still coming is too late
+	awaited=0;
+	for( unsigned int peer=0; peer<asked.size(); ++peer )
+		asked[peer].clear();
+}
+
+/** @brief Take orders */
+template< typename State, class Traits >
+bool Solver< State, Traits >::Node::serve()
+{
+	Engine< SharedMemo >& mine=*solver.workers[0];
+	std::unique_lock< std::mutex > guard( lock );
+	
+	for( ;; )
+	{
+		while( !hired && !dismissed && !mismatched ) heard.wait( guard );
+		if( mismatched ) return false;
+		if( dismissed ) return true;
+		
+		std::string order;
+		Cancellation cancel;
+		
+		order.swap( job );
+		hired=false;
+		if( recalled ) cancel.raise();
+		underway=&cancel;
+		guard.unlock();
+		
+		const char* cursor=order.data();
+		const char* end=cursor+order.size();
+		State position( solver.current );
+		SolverStatistics before, after;
+		std::string report;
+		Record result;
+		uint64_t ply;
+		bool completed=false;
+		
+		mine.tally( before );
+		if( end-cursor>=2 )
+		{
+			typename State::Score alpha=typename State::Score(
+				static_cast< signed char >( *cursor++ ) );
+			typename State::Score beta=typename State::Score(
+				static_cast< signed char >( *cursor++ ) );
+			
+			if( Encoding::readVarint( cursor, end, ply ) &&
+				Traits::decode( std::string( cursor, end ),
+				position ) )
+			{
+				shallowest=ply;
+				completed=mine.search( position, alpha, beta,
+					result, &cancel, ply );
+			}
+		}
+		mine.tally( after );
+		for( unsigned int peer=1; peer<cluster.size(); ++peer )
+			if( peer!=cluster.self() ) cluster.flush( peer ); //the
+				//rest of what we've shared
+		
+		report.push_back( completed ? 1 : 0 );
+		pack( result, report );
+		Encoding::appendVarint( report, after.positions-before.positions
+			);
+		cluster.send( 0, 'R', report );
+		
+		guard.lock();
+		underway=NULL;
+	}
+}
+
+/** @brief How many did they see? */
+template< typename State, class Traits >
+uint64_t Solver< State, Traits >::Node::visited()
+{
+	std::lock_guard< std::mutex > guard( lock );
+	
+	return delegated;
+}
+
+/** @brief Look a little way ahead */
+template< typename State, class Traits >
+template< class Table >
+int Solver< State, Traits >::foresee( Table& memo, const State& state, int
+	alpha, int beta, unsigned int draft, unsigned int ply, Allowance&
+	allowance, bool& proven, unsigned int& choice )
 {
-	State* bestConfig=NULL;
+	typename Table::Locator where;
+	typename HashTable< State, Guess >::Locator guessed;
+	const Record* known;
+	const Guess* guess;
+	unsigned int hint=NO_MOVE;
+	int winning;
 	
+	proven=true;
+	choice=0;
+	if( allowance.exhausted() ) return 0; //our caller won't look
+	if( ply>ledger.peakDepth ) ledger.peakDepth=ply;
 	if( state.gameOver() )
 	{
-		decision.config=state;
-		decision.value=state.scoreGame();
+		++ledger.terminals;
+		
+		return state.scoreGame()*CERTAINTY;
+	}
+	if( ( known=memo.find( state, where ) )==NULL ) ++ledger.memoMisses;
+	else //something's proven
+	{
+		int value=known->value*CERTAINTY;
+		
+		++ledger.memoHits;
+		choice=known->choice;
+		if( known->bound==EXACT || ( known->bound==LOWER && ( value==
+			CERTAINTY || value>=beta ) ) || ( known->bound==UPPER &&
+			( value==-CERTAINTY || value<=alpha ) ) ) //and it's enough
+			return value;
+		hint=known->choice;
+	}
+	
+	if( ( winning=Traits::winner( state ) )>=0 ) //however far we can see
+	{
+		choice=winning;
+		
+		return state.computersTurn() ? CERTAINTY : -CERTAINTY;
+	}
+	
+	proven=false;
+	if( draft==0 ) //we can't see any further, so guess
+		return std::max( -CERTAINTY+1, std::min( CERTAINTY-1,
+			Traits::estimate( state ) ) );
+	if( ( guess=guesses.find( state, guessed ) )!=NULL ) //we've guessed
+		//before, maybe from further away
+	{
+		choice=guess->choice;
+		if( guess->draft>=draft && ( guess->bound==EXACT || (
+			guess->bound==LOWER && guess->value>=beta ) || (
+			guess->bound==UPPER && guess->value<=alpha ) ) )
+			return guess->value;
+		hint=guess->choice; //fresher than the memo's
+	}
+	
+	MoveBuffer< State >& successors=lookahead[ply]; //deeper plies use
+		//their own, so these stay put
+	std::vector< unsigned int >& order=orders[ply];
+	bool maximizing=state.computersTurn();
+	int best=maximizing ? -CERTAINTY-1 : CERTAINTY+1;
+	int low=alpha;
+	int high=beta;
+	
+	successors.clear(); //but hang onto its storage
+	Traits::successors( state, successors );
+	order.clear();
+	suggest( state, successors.size(), order, Choice< Traits::ordered >() );
+	std::vector< unsigned int >::iterator first=std::find( order.begin(),
+		order.end(), hint );
+	if( first!=order.end() ) std::rotate( order.begin(), first, first+1 );
+	
+	proven=true;
+	for( unsigned int rank=0; rank<order.size() && low<high; ++rank )
+	{
+		bool certain;
+		unsigned int unused;
+		int value=foresee( memo, successors[order[rank]], low, high,
+			draft-1, ply+1, allowance, certain, unused );
+		
+		if( allowance.spent ) return 0; //none of this counts
+		proven=proven && certain;
+		if( maximizing ? value>best : value<best )
+		{
+			best=value;
+			choice=order[rank];
+		}
+		if( maximizing ) low=std::max( low, best );
+		else high=std::min( high, best );
+	}
+	
+	Bound bound=best<=alpha ? UPPER : best>=beta ? LOWER : EXACT;
+	
+	if( proven ) //what we learned is worth keeping for good
+	{
+		Record decision;
+		
+		decision.choice=choice;
+		decision.value=static_cast< signed char >( best/CERTAINTY );
+		decision.bound=bound;
+		if( ( bound==LOWER && best==CERTAINTY ) || ( bound==UPPER &&
+			best==-CERTAINTY ) ) //nothing's beyond it
+			decision.bound=EXACT;
+		if( ( decision.bound==LOWER && best<0 ) || ( decision.bound==UPPER
+			&& best>0 ) ) //it tells us nothing
+			return best;
+		memo.store( where, state, decision, ply<UCHAR_MAX ? UCHAR_MAX-ply
+			: 0 );
+	}
+	else //maybe deeper searches can use it
+	{
+		Guess estimate;
+		
+		estimate.value=best;
+		estimate.bound=bound;
+		estimate.draft=static_cast< unsigned char >( draft );
+		estimate.choice=static_cast< unsigned short >( choice );
+		guesses.store( guessed, state, estimate );
+	}
+	
+	return best;
+}
+
+/** @brief Add up */
+template< typename State, class Traits >
+unsigned int Solver< State, Traits >::accumulate( unsigned int total,
+	unsigned int more )
+{
+	if( total>=HOPELESS || more>=HOPELESS ) return HOPELESS;
+	
+	return std::min( total+more, HOPELESS-1 ); //short of hopeless
+}
+
+/** @brief Size up */
+template< typename State, class Traits >
+template< class Table >
+void Solver< State, Traits >::appraise( Table& memo, const State& state, bool
+	computerAttacks, Proof& estimate )
+{
+	typename Table::Locator where;
+	typename HashTable< State, Proof >::Locator guessed;
+	const Record* known;
+	const Proof* partial;
+	int goal=computerAttacks ? State::VICTORY : State::LOSS;
+	
+	estimate=Proof();
+	if( state.gameOver() ) //it's settled one way or the other
+	{
+		bool won=state.scoreGame()==goal;
+		
+		estimate.proof=won ? 0 : HOPELESS;
+		estimate.disproof=won ? HOPELESS : 0;
+	}
+	else if( ( known=memo.find( state, where ) )!=NULL && known->value==goal
+		&& known->bound!=( computerAttacks ? UPPER : LOWER ) ) //won
+	{
+		estimate.proof=0;
+		estimate.disproof=HOPELESS;
+	}
+	else if( known!=NULL && known->value!=goal && known->bound!=(
+		computerAttacks ? LOWER : UPPER ) ) //it's at most a tie, so it
+		//isn't a win
+	{
+		estimate.proof=HOPELESS;
+		estimate.disproof=0;
 	}
-	else if( remembered.contains( decision ) ) //we've evaluated this
-		//whole case before
+	else if( ( partial=proofs.find( state, guessed ) )!=NULL )
+		estimate=*partial;
+}
+
+/** @brief Prove it */
+template< typename State, class Traits >
+template< class Table >
+void Solver< State, Traits >::prove( Table& memo, const State& state, bool
+	computerAttacks, unsigned int proofLimit, unsigned int disproofLimit,
+	unsigned int ply, Proof& result )
+{
+	typename HashTable< State, Proof >::Locator guessed;
+	bool attacking=state.computersTurn()==computerAttacks;
+	unsigned int choice=0;
+	
+	++ledger.positions;
+	if( ply>ledger.peakDepth ) ledger.peakDepth=ply;
+	appraise( memo, state, computerAttacks, result );
+	if( result.proof==0 || result.disproof==0 ) //nothing left to do
 	{
-		#ifdef DEBUG
-			std::cout<<"Memoization saved us work for "
-				<<state.str()<<std::endl;
-		#endif
-		remembered.matching( decision, decision );
+		if( state.gameOver() ) ++ledger.terminals;
+		
+		return;
 	}
-	else //this situation is new to us
+	if( result.proof>=proofLimit || result.disproof>=disproofLimit )
+		return; //we already know it's more than we're prepared to do
+	proofs.find( state, guessed );
+	
+	if( frontier.size()<=ply ) frontier.resize( ply+1 );
+	MoveBuffer< State >& successors=frontier[ply]; //deeper plies use
+		//their own, so these stay put
+	
+	successors.clear(); //but hang onto its storage
+	Traits::successors( state, successors );
+	for( ;; )
 	{
-		std::vector< State > successors;
-		state.successors( successors );
+		//where the attacker is up, one proven successor proves us, and
+		//every one must be refuted to refute us; elsewhere, the reverse:
+		unsigned int& either=attacking ? result.proof : result.disproof;
+		unsigned int& all=attacking ? result.disproof : result.proof;
+		unsigned int runnerUp=HOPELESS;
+		unsigned int choiceAll=0;
 		
-		for( typename std::vector< State >::iterator
-			follower=successors.begin();
-			follower<successors.end(); ++follower )
+		either=HOPELESS;
+		all=0;
+		for( unsigned int index=0; index<successors.size(); ++index )
 		{
-			StatePlusScore ofTheMoment( *follower );
-			nextBestState( *follower, ofTheMoment );
+			Proof child;
+			
+			appraise( memo, successors[index], computerAttacks, child );
+			
+			unsigned int childEither=attacking ? child.proof :
+				child.disproof;
+			unsigned int childAll=attacking ? child.disproof :
+				child.proof;
 			
-			if( bestConfig==NULL || decision.prefersScore(
-				ofTheMoment.value ) )
+			if( childEither<either )
 			{
-				#ifdef DEBUG
-					std::cout<<"Deciding on "
-						<<ofTheMoment.config.str()
-						<<std::endl;
-				#endif
-				
-				bestConfig=&*follower;
-				decision.value=ofTheMoment.value;
+				runnerUp=either;
+				either=childEither;
+				choice=index;
+				choiceAll=childAll;
 			}
+			else if( childEither<runnerUp ) runnerUp=childEither;
+			all=accumulate( all, childAll );
 		}
+		if( result.proof>=proofLimit || result.disproof>=disproofLimit )
+			break;
+		
+		//the limits for the successor closest to settling it, such
+		//that it stops once it's no longer the closest:
+		unsigned int eitherLimit=attacking ? proofLimit : disproofLimit;
+		unsigned int allLimit=attacking ? disproofLimit : proofLimit;
+		unsigned int childEither=std::min( eitherLimit, runnerUp+1 );
+		unsigned int childAll=allLimit-all+choiceAll;
+		Proof ignored;
+		
+		if( attacking )
+			prove( memo, successors[choice], computerAttacks,
+				childEither, childAll, ply+1, ignored );
+		else //the defender is up
+			prove( memo, successors[choice], computerAttacks,
+				childAll, childEither, ply+1, ignored );
+	}
+	
+	proofs.store( guessed, state, result );
+	if( result.proof==0 || result.disproof==0 ) //it's settled for good
+	{
+		typename Table::Locator where;
+		Record decision;
+		bool won=result.proof==0;
+		
+		memo.find( state, where );
+		decision.value=won ? typename State::Score( computerAttacks ?
+			State::VICTORY : State::LOSS ) : State::TIE;
+		decision.bound=won ? EXACT : computerAttacks ? UPPER : LOWER;
+		decision.choice=won==attacking ? choice : 0; //only the
+			//attacker's wins and the defender's refutations single
+			//out a successor
+		memo.store( where, state, decision, ply<UCHAR_MAX ? UCHAR_MAX-ply
+			: 0 );
+	}
+}
+
+/** @brief Peek */
+template< typename State, class Traits >
+template< class Table >
+bool Solver< State, Traits >::glance( Engine< Table >& engine, const State&
+	state, typename State::Score alpha, typename State::Score beta, Record&
+	decision )
+{
+	typename Engine< Table >::Locator where;
+	unsigned int hint;
+	
+	return engine.recall( state, alpha, beta, decision, where, hint );
+}
+
+/** @brief Retrace our steps */
+template< typename State, class Traits >
+unsigned int Solver< State, Traits >::rediscover( typename State::Score value )
+{
+	MoveBuffer< State > successors;
+	bool maximizing=current.computersTurn();
+	typename State::Score alpha=typename State::Score( maximizing ? value-1 :
+		value );
+	typename State::Score beta=typename State::Score( maximizing ? value :
+		value+1 );
+	
+	if( value==( maximizing ? State::LOSS : State::VICTORY ) )
+		return 0; //any move earns that
+	Traits::successors( current, successors );
+	
+	//asked only whether a successor measures up, the memo usually knows
+	//which one did, so we need only search if it's been pushed out:
+	for( unsigned int index=0; index<successors.size(); ++index )
+	{
+		Record reply;
 		
-		decision.config=*bestConfig;
-		remembered.add( StatePlusScore( state ), decision );
-			//cherish this
-			//moment
+		if( ( pool==NULL ? glance( engine, successors[index], alpha, beta,
+			reply ) : glance( *workers[0], successors[index], alpha,
+			beta, reply ) ) && ( maximizing ? reply.value>=value :
+			reply.value<=value ) )
+			return index;
+	}
+	for( unsigned int index=0; index+1<successors.size(); ++index )
+	{
+		Record reply;
 		
-		#ifdef DEBUG
-			std::cout<<"Given "<<state.str()<<" chose "
-				<<decision.config.str()
-				<<" for victory rating "<<decision.value
-				<<std::endl;
-		#endif
+		if( pool==NULL )
+			engine.search( successors[index], alpha, beta, reply,
+				NULL, 1 );
+		else //call in the workers
+		{
+			Cancellation never;
+			splitBestState( 0, successors[index], alpha, beta, 1,
+				reply, never );
+		}
+		if( maximizing ? reply.value>=value : reply.value<=value )
+			return index;
 	}
+	
+	return successors.size()-1; //nothing else did
 }
 
 /** @brief Solver frontend */
-template< typename State >
-const State& Solver< State >::nextBestState()
+template< typename State, class Traits >
+const State& Solver< State, Traits >::nextBestState()
+{
+	if( !current.gameOver() ) //there's a move to make
+	{
+		Record outcome;
+		std::chrono::steady_clock::time_point start=
+			std::chrono::steady_clock::now();
+		
+		if( pool==NULL ) //just us
+			engine.search( current, State::LOSS, State::VICTORY,
+				outcome );
+		else //call in the workers
+		{
+			Cancellation never;
+			splitBestState( 0, current, State::LOSS,
+				State::VICTORY, 0, outcome, never );
+		}
+		
+		double seconds=std::chrono::duration< double >(
+			std::chrono::steady_clock::now()-start ).count();
+		
+		++ledger.searches;
+		ledger.seconds+=seconds;
+		if( seconds>ledger.longestSeconds )
+			ledger.longestSeconds=seconds;
+		
+		//rebuild the position we chose:
+		MoveBuffer< State > successors;
+		Traits::successors( current, successors );
+		if( outcome.choice>=successors.size() ) //the memo may not
+			//have kept the move, or never known it
+			outcome.choice=static_cast< unsigned short >( rediscover(
+				typename State::Score( outcome.value ) ) );
+		current=successors[outcome.choice];
+		if( sweeping ) sweep();
+	}
+	
+	return current;
+}
+
+/** @brief Deepen */
+template< typename State, class Traits >
+const State& Solver< State, Traits >::nextGoodState( double seconds, uint64_t
+	positions )
 {
-	StatePlusScore outcome( current );
-	nextBestState( current, outcome );
-	current=outcome.config;
+	if( !current.gameOver() ) //there's a move to make
+	{
+		Allowance allowance( seconds, positions );
+		std::chrono::steady_clock::time_point start=
+			std::chrono::steady_clock::now();
+		MoveBuffer< State > successors;
+		unsigned int move=0;
+		
+		Traits::successors( current, successors );
+		guesses.purge(); //we'll be looking from somewhere new
+		reach=0;
+		for( unsigned int draft=1; draft<=MAX_DRAFT; ++draft )
+		{
+			bool proven;
+			unsigned int choice;
+			int value;
+			
+			lookahead.resize( draft+1 );
+			orders.resize( draft+1 );
+			allowance.binding=draft>1; //we'll have some move
+			if( shared!=NULL )
+				value=foresee( *shared, current, -CERTAINTY-1,
+					CERTAINTY+1, draft, 0, allowance, proven,
+					choice );
+			else //just us
+				value=foresee( remembered, current,
+					-CERTAINTY-1, CERTAINTY+1, draft, 0,
+					allowance, proven, choice );
+			if( allowance.spent ) break; //this search doesn't count
+			
+			move=choice;
+			reach=draft;
+			if( proven )
+			{
+				if( move>=successors.size() ) //the memo
+					//may not have kept it, or never known it
+					move=rediscover( typename State::Score(
+						value/CERTAINTY ) );
+				reach=0;
+				break;
+			}
+		}
+		
+		double elapsed=std::chrono::duration< double >(
+			std::chrono::steady_clock::now()-start ).count();
+		
+		++ledger.searches;
+		ledger.seconds+=elapsed;
+		if( elapsed>ledger.longestSeconds )
+			ledger.longestSeconds=elapsed;
+		ledger.positions+=allowance.visited;
+		
+		current=successors[move]; //rebuild the position we chose
+		if( sweeping ) sweep();
+	}
 	
 	return current;
 }
 
+/** @brief Is it in the bag? */
+template< typename State, class Traits >
+bool Solver< State, Traits >::forcesWin()
+{
+	if( current.gameOver() ) return false; //there's nothing to win
+	
+	Proof result;
+	bool computerAttacks=current.computersTurn();
+	std::chrono::steady_clock::time_point start=
+		std::chrono::steady_clock::now();
+	
+	proofs.limit( memoBudget ); //forget what we'd proven for whoever
+		//was up last time
+	while( result.proof!=0 && result.disproof!=0 )
+		if( shared!=NULL )
+			prove( *shared, current, computerAttacks, HOPELESS,
+				HOPELESS, 0, result );
+		else //just us
+			prove( remembered, current, computerAttacks, HOPELESS,
+				HOPELESS, 0, result );
+	
+	double elapsed=std::chrono::duration< double >(
+		std::chrono::steady_clock::now()-start ).count();
+	
+	++ledger.searches;
+	ledger.seconds+=elapsed;
+	if( elapsed>ledger.longestSeconds ) ledger.longestSeconds=elapsed;
+	
+	return result.proof==0;
+}
+
+/** @brief How far could we see? */
+template< typename State, class Traits >
+unsigned int Solver< State, Traits >::horizon() const
+{
+	return reach;
+}
+
 /** @brief Human turn */
-template< typename State >
-bool Solver< State >::supplyNextState( const State& future )
+template< typename State, class Traits >
+bool Solver< State, Traits >::supplyNextState( const State& future )
 {
 	if( State::areSubsequent( current, future ) )
 	{
 		current=future;
+		if( sweeping ) sweep();
 		
 		return true;
 	}
 	else return false;
 }
+
+/** @brief Teleport */
+template< typename State, class Traits >
+bool Solver< State, Traits >::reposition( const State& position )
+{
+	if( position.variant()!=current.variant() ) return false;
+	
+	current=position;
+	
+	return true;
+}
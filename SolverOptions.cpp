@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+#include "SolverOptions.h"
+#include "OpeningBook.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+using namespace std;
+
+const char* const SolverOptions::USAGE="[--threads N] [--split-depth N] "
+	"[--memo-mb N] [--load-memo FILE] [--save-memo FILE] [--batch] "
+	"[--packed] [--stats text|json] [--move-ms N] [--move-positions N] "
+	"[--sweep] [--book FILE]";
+
+/**
+Reads a switch's numeric value.
+@param text the value as typed
+@param value where to put it
+@return whether it was a natural number
+*/
+static bool readNatural( const char* text, unsigned int& value )
+{
+	char* end;
+	long number;
+	
+	if( text==NULL || *text=='\0' ) return false;
+	number=strtol( text, &end, 10 );
+	if( *end!='\0' || number<0 ) return false;
+	
+	value=static_cast< unsigned int >( number );
+	
+	return true;
+}
+
+/** @brief Constructor */
+SolverOptions::SolverOptions():
+	threads( 1 ), splitDepth( DEFAULT_SPLIT_DEPTH ), memoMegabytes( 0 ),
+	loadMemo( NULL ), saveMemo( NULL ), batch( false ), packed( false ),
+	stats( NULL ), moveMilliseconds( 0 ), movePositions( 0 ),
+	sweep( false ), book( NULL ) {}
+
+/** @brief Strip switches */
+bool SolverOptions::parse( int& argc, char** argv )
+{
+	int kept=1; //the program name stays put
+	
+	for( int arg=1; arg<argc; ++arg )
+	{
+		unsigned int* target=NULL;
+		const char** path=NULL;
+		
+		if( strcmp( argv[arg], "--batch" )==0 ) //takes no value
+		{
+			batch=true;
+			continue;
+		}
+		else if( strcmp( argv[arg], "--sweep" )==0 ) //nor does this
+		{
+			sweep=true;
+			continue;
+		}
+		else if( strcmp( argv[arg], "--packed" )==0 ) //nor this
+		{
+			packed=true;
+			continue;
+		}
+		else if( strcmp( argv[arg], "--threads" )==0 )
+			target=&threads;
+		else if( strcmp( argv[arg], "--split-depth" )==0 )
+			target=&splitDepth;
+		else if( strcmp( argv[arg], "--memo-mb" )==0 )
+			target=&memoMegabytes;
+		else if( strcmp( argv[arg], "--load-memo" )==0 )
+			path=&loadMemo;
+		else if( strcmp( argv[arg], "--save-memo" )==0 )
+			path=&saveMemo;
+		else if( strcmp( argv[arg], "--stats" )==0 )
+			path=&stats; //not really, but it's a word all the same
+		else if( strcmp( argv[arg], "--move-ms" )==0 )
+			target=&moveMilliseconds;
+		else if( strcmp( argv[arg], "--move-positions" )==0 )
+			target=&movePositions;
+		else if( strcmp( argv[arg], "--book" )==0 )
+			path=&book;
+		
+		if( target==NULL && path==NULL ) //it's the game's
+			argv[kept++]=argv[arg];
+		else if( arg+1>=argc ) //the value's missing
+			return false;
+		else if( path!=NULL )
+			*path=argv[++arg];
+		else if( !readNatural( argv[++arg], *target ) )
+			return false;
+	}
+	argc=kept;
+	argv[argc]=NULL;
+	
+	return stats==NULL || strcmp( stats, "text" )==0 || strcmp( stats,
+		"json" )==0;
+}
+
+/** @brief Open the book */
+void SolverOptions::consult( OpeningBook& pages ) const
+{
+	if( book!=NULL && !pages.open( book ) )
+		cerr<<"WARNING: Ignoring "<<book<<", which isn't an opening "
+			<<"book"<<endl;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOLVEROPTIONS_H
+#define SOLVEROPTIONS_H
+
+class OpeningBook;
+template< typename State, class Traits > class Solver;
+
+/**
+The switches, common to every game, that tune how the <tt>Solver</tt> goes
+about its business rather than what game it plays.  They may appear anywhere
+on the command line.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+class SolverOptions
+{
+	public:
+		/** A summary of the switches, for usage messages */
+		static const char* const USAGE;
+		
+		/** How many plies below the root to split by default, the
+			same as <tt>Solver::DEFAULT_SPLIT_DEPTH</tt> */
+		static const unsigned int DEFAULT_SPLIT_DEPTH=2;
+		
+		/** How many threads to search with, where 0 means one per
+			hardware thread */
+		unsigned int threads;
+		
+		/** How many plies below the root to split parallel work */
+		unsigned int splitDepth;
+		
+		/** How many megabytes the memo may occupy, where 0 means it
+			grows as it needs */
+		unsigned int memoMegabytes;
+		
+		/** A solution database to consult before searching, or
+			<tt>NULL</tt> */
+		const char* loadMemo;
+		
+		/** Where to save what the search learns, or <tt>NULL</tt> */
+		const char* saveMemo;
+		
+		/** Whether to answer a stream of queries rather than just
+			one, as a game sees fit */
+		bool batch;
+		
+		/** Whether a batch's queries are packed binary records rather
+			than text */
+		bool packed;
+		
+		/** How to report what the search went through, either
+			<tt>"text"</tt> or <tt>"json"</tt>, or <tt>NULL</tt> not
+			to */
+		const char* stats;
+		
+		/** How many milliseconds the computer may think about each
+			move, where 0 means until it's sure */
+		unsigned int moveMilliseconds;
+		
+		/** How many positions the computer may visit for each move,
+			where 0 means as many as it takes to be sure */
+		unsigned int movePositions;
+		
+		/** Whether to forget what the memo knows about positions the
+			game has left behind after every move */
+		bool sweep;
+		
+		/** An opening book to look the position up in before
+			building a <tt>Solver</tt>, or <tt>NULL</tt> */
+		const char* book;
+		
+		/**
+		Makes the default options: a single thread with a memo that
+			grows as it needs, without any solution database,
+			opening book, or statistics, for a single query in
+			text, taking as long as it takes to find the best move
+			and remembering every position along the way.
+		*/
+		SolverOptions( void );
+		
+		/**
+		Picks our switches out of the command line, removing them
+			(and their values) so that only the game's own
+			arguments remain.
+		@param argc the number of arguments, which is updated
+		@param argv the arguments, which are shifted down
+		@return whether every switch was well-formed
+		*/
+		bool parse( int& argc, char** argv );
+		
+		/**
+		Applies the options to a <tt>Solver</tt> before it searches:
+			how many threads it uses, how much memory its memo may
+			occupy, and what solution database it consults, if
+			any, warning on <tt>std::cerr</tt> if either of the
+			latter two can't be had, and whether it sweeps its memo
+			as the game goes on.
+		@param game the <tt>Solver</tt>
+		*/
+		template< class Game > void prepare( Game& game ) const;
+		
+		/**
+		Opens the opening book, if we were asked to, warning on
+			<tt>std::cerr</tt> if it isn't one.
+		@param pages where to open it, which stays closed otherwise
+		*/
+		void consult( OpeningBook& pages ) const;
+		
+		/**
+		Saves what a <tt>Solver</tt> has learned, if we were asked to,
+			warning on <tt>std::cerr</tt> if we can't, and reports
+			its statistics there if we were asked for those.
+		@param game the <tt>Solver</tt>
+		*/
+		template< class Game > void finish( const Game& game ) const;
+		
+		/**
+		Readies a <tt>Solver</tt> for the next of a batch of queries:
+			the last query's, along with everything it learned, if
+			it plays the same variant of the game, or else a new
+			one, <tt>prepare()</tt>d to replace it.
+		@param game the last query's <tt>Solver</tt>, or
+			<tt>NULL</tt> before the first, which is deleted if it
+			can't be reused
+		@param position the position being asked about
+		@return a <tt>Solver</tt> at that position, which the caller
+			must delete
+		*/
+		template< class Game, class State > Game* reuse( Game* game,
+			const State& position ) const;
+		
+		/**
+		Has a <tt>Solver</tt> make the computer's move: the best one,
+			or, if each move has a budget, the best one it can find
+			within that.
+		@param game the <tt>Solver</tt>
+		@return the new position
+		*/
+		template< typename State, class Traits > const State& advance(
+			Solver< State, Traits >& game ) const;
+};
+
+#include "SolverOptions.t.h"
+
+#endif
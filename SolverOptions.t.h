@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+//included from "SolverOptions.h"
+#include <cstring>
+#include <iostream>
+#include <stdint.h>
+
+/** @brief Set up */
+template< class Game >
+void SolverOptions::prepare( Game& game ) const
+{
+	game.parallelize( threads, splitDepth );
+	game.tidy( sweep );
+	
+	if( memoMegabytes!=0 && !game.budget( uint64_t( memoMegabytes )<<20 ) )
+		std::cerr<<"WARNING: Couldn't reserve "<<memoMegabytes<<" MB "
+			<<"for the memo, so it will grow as it needs"
+			<<std::endl;
+	if( loadMemo!=NULL && !game.consult( loadMemo ) )
+		std::cerr<<"WARNING: Ignoring "<<loadMemo<<", which isn't a "
+			<<"solution database for this game"<<std::endl;
+}
+
+/** @brief Save up */
+template< class Game >
+void SolverOptions::finish( const Game& game ) const
+{
+	if( saveMemo!=NULL && !game.record( saveMemo ) )
+		std::cerr<<"WARNING: Couldn't save the solution database to "
+			<<saveMemo<<std::endl;
+	if( stats!=NULL )
+		game.statistics().print( std::cerr, strcmp( stats, "json" )==0 );
+}
+
+/** @brief Keep it warm */
+template< class Game, class State >
+Game* SolverOptions::reuse( Game* game, const State& position ) const
+{
+	if( game!=NULL && game->reposition( position ) ) return game;
+	
+	delete game;
+	game=new Game( position );
+	prepare( *game );
+	
+	return game;
+}
+
+/** @brief Think, within reason */
+template< typename State, class Traits >
+const State& SolverOptions::advance( Solver< State, Traits >& game ) const
+{
+	if( moveMilliseconds==0 && movePositions==0 ) //take all day
+		return game.nextBestState();
+	
+	return game.nextGoodState( moveMilliseconds/1000.0, movePositions );
+}
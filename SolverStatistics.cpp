@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+#include "SolverStatistics.h"
+#include <ostream>
+using namespace std;
+
+/**
+Divides without dividing by zero.
+@param part the numerator
+@param whole the denominator
+@return their quotient, or <tt>0</tt> if there's no whole
+*/
+static double ratio( double part, double whole )
+{
+	return whole>0 ? part/whole : 0;
+}
+
+/** @brief Constructor */
+SolverStatistics::SolverStatistics():
+	searches( 0 ), seconds( 0 ), longestSeconds( 0 ), positions( 0 ),
+	terminals( 0 ), memoHits( 0 ), memoMisses( 0 ), libraryHits( 0 ),
+	peakDepth( 0 ), memo() {}
+
+/** @brief Sum */
+void SolverStatistics::add( const SolverStatistics& other )
+{
+	searches+=other.searches;
+	seconds+=other.seconds;
+	if( other.longestSeconds>longestSeconds )
+		longestSeconds=other.longestSeconds;
+	positions+=other.positions;
+	terminals+=other.terminals;
+	memoHits+=other.memoHits;
+	memoMisses+=other.memoMisses;
+	libraryHits+=other.libraryHits;
+	if( other.peakDepth>peakDepth ) peakDepth=other.peakDepth;
+	memo.add( other.memo );
+}
+
+/** @brief Report */
+void SolverStatistics::print( ostream& out, bool json ) const
+{
+	double hitRate=ratio( memoHits, memoHits+memoMisses );
+	double meanProbe=ratio( memo.probes, memo.lookups );
+	double load=ratio( memo.entries, memo.capacity );
+	
+	if( json )
+		out<<"{\"searches\":"<<searches<<",\"seconds\":"<<seconds
+			<<",\"longestSeconds\":"<<longestSeconds
+			<<",\"positions\":"<<positions<<",\"terminals\":"
+			<<terminals<<",\"memoHits\":"<<memoHits
+			<<",\"memoMisses\":"<<memoMisses<<",\"libraryHits\":"
+			<<libraryHits<<",\"hitRate\":"<<hitRate
+			<<",\"peakDepth\":"<<peakDepth<<",\"lookups\":"
+			<<memo.lookups<<",\"meanProbe\":"<<meanProbe
+			<<",\"longestProbe\":"<<memo.longestProbe
+			<<",\"entries\":"<<memo.entries<<",\"peakEntries\":"
+			<<memo.peakEntries<<",\"capacity\":"<<memo.capacity
+			<<",\"load\":"<<load<<",\"grows\":"<<memo.grows
+			<<",\"evictions\":"<<memo.evictions<<",\"swept\":"
+			<<memo.swept<<'}'<<endl;
+	else //for people
+	{
+		out<<"Searches:  "<<searches<<" in "<<seconds<<" s (longest "
+			<<longestSeconds<<" s)"<<endl;
+		out<<"Positions: "<<positions<<" visited, "<<terminals
+			<<" of them terminal, at most "<<peakDepth
+			<<" deep"<<endl;
+		out<<"Memo:      "<<memoHits<<" hits, "<<memoMisses
+			<<" misses ("<<100*hitRate<<"% hit), "<<libraryHits
+			<<" of the misses from the database"<<endl;
+		out<<"Probes:    "<<memo.lookups<<" lookups, "<<meanProbe
+			<<" slots on average, "<<memo.longestProbe
+			<<" at most"<<endl;
+		out<<"Table:     "<<memo.entries<<" entries (peak "
+			<<memo.peakEntries<<") in "<<memo.capacity
+			<<" slots ("<<100*load<<"% load), "<<memo.grows
+			<<" grows, "<<memo.evictions<<" evictions, "
+			<<memo.swept<<" swept"<<endl;
+	}
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOLVERSTATISTICS_H
+#define SOLVERSTATISTICS_H
+
+#include "TableStatistics.h"
+#include <ostream>
+#include <stdint.h>
+
+/**
+What a <tt>Solver</tt> has been up to, summed over all the threads it has
+searched with: how much of the game tree it visited, how often its memo
+spared it the trouble, and how long it took.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+class SolverStatistics
+{
+	public:
+		/** How many moves had to be searched for */
+		uint64_t searches;
+		
+		/** How long those searches took in all, in seconds */
+		double seconds;
+		
+		/** The longest any one of them took, in seconds */
+		double longestSeconds;
+		
+		/** How many positions were visited */
+		uint64_t positions;
+		
+		/** How many of those were already over */
+		uint64_t terminals;
+		
+		/** How many of the rest the memo already held */
+		uint64_t memoHits;
+		
+		/** How many of the rest the memo didn't hold */
+		uint64_t memoMisses;
+		
+		/** How many of the memo's misses a solution database held */
+		uint64_t libraryHits;
+		
+		/** The most stack frames any search had in use at once */
+		uint64_t peakDepth;
+		
+		/** How the memo itself fared */
+		TableStatistics memo;
+		
+		/**
+		Starts every count at zero.
+		*/
+		SolverStatistics( void );
+		
+		/**
+		Folds in the statistics of another search, such as another
+			thread's.
+		@param other the other search's statistics
+		*/
+		void add( const SolverStatistics& other );
+		
+		/**
+		Writes the statistics out, along with the rates and averages
+			they imply.
+		@param out where to write them
+		@param json whether to write a single-line JSON object rather
+			than lines of text meant for people
+		*/
+		void print( std::ostream& out, bool json ) const;
+};
+
+#endif
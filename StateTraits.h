@@ -0,0 +1,405 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STATETRAITS_H
+#define STATETRAITS_H
+
+#include "Encoding.h"
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+What a <tt>Solver</tt> knows about a kind of <tt>State</tt> before it ever sees
+one, which it consults at compile time to decide how to search.  Its facts are
+which optional hooks the <tt>State</tt> provides, all detected here from their
+signatures.  Its policies settle, mostly from those facts, how a
+<tt>Solver</tt> searches and walks the game tree, how it remembers, how it
+lists successors, how it judges positions it hasn't time to search, how it
+spots a winning move, and how it names and ships positions to other
+processes.  A game that wants other policies specializes <tt>StateTraits</tt>
+next to its <tt>State</tt>, deriving from this class and redefining only the
+ones that differ.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+template< typename State > class DetectedTraits
+{
+	private:
+		/** Exists only for the <tt>orderedSuccessors</tt> signature */
+		template< typename Type, void ( Type::* )( std::vector< unsigned
+			int >& ) const > struct Orders {};
+		
+		/** Exists only for the <tt>index</tt> signature */
+		template< typename Type, uint64_t ( Type::* )( void ) const >
+			struct Indexes {};
+		
+		/** Exists only for the <tt>remaining</tt> signature */
+		template< typename Type, unsigned int ( Type::* )( void ) const >
+			struct Measures {};
+		
+		/** Exists only for the <tt>evaluate</tt> signature */
+		template< typename Type, int ( Type::* )( void ) const >
+			struct Evaluates {};
+		
+		/** Exists only for the <tt>winningSuccessor</tt> signature */
+		template< typename Type, int ( Type::* )( void ) const >
+			struct Finishes {};
+		
+		/** Exists only for the <tt>decode</tt> signature */
+		template< typename Type, bool ( Type::* )( const std::string& ) >
+			struct Decodes {};
+		
+		/** Picks an overload at compile time */
+		template< bool Which > struct Choice {};
+		
+		/** Chosen if the hook exists */
+		template< typename Type > static char ordering( Orders< Type,
+			&Type::orderedSuccessors >* );
+		
+		/** Chosen otherwise */
+		template< typename Type > static long ordering( ... );
+		
+		/** Chosen if the method exists */
+		template< typename Type > static char indexing( Indexes< Type,
+			&Type::index >* );
+		
+		/** Chosen otherwise */
+		template< typename Type > static long indexing( ... );
+		
+		/** Chosen if the method exists */
+		template< typename Type > static char measuring( Measures< Type,
+			&Type::remaining >* );
+		
+		/** Chosen otherwise */
+		template< typename Type > static long measuring( ... );
+		
+		/** Chosen if the hook exists */
+		template< typename Type > static char evaluating( Evaluates<
+			Type, &Type::evaluate >* );
+		
+		/** Chosen otherwise */
+		template< typename Type > static long evaluating( ... );
+		
+		/** Chosen if the hook exists */
+		template< typename Type > static char finishing( Finishes< Type,
+			&Type::winningSuccessor >* );
+		
+		/** Chosen otherwise */
+		template< typename Type > static long finishing( ... );
+		
+		/** Chosen if the hook exists */
+		template< typename Type > static char decoding( Decodes< Type,
+			&Type::decode >* );
+		
+		/** Chosen otherwise */
+		template< typename Type > static long decoding( ... );
+		
+		/**
+		Asks a position how it looks.
+		@param state the position
+		@return its own estimate
+		*/
+		inline static int estimate( const State& state, Choice< true > );
+		
+		/**
+		Has no opinion of a position, for lack of a hook.
+		@return an even estimate
+		*/
+		inline static int estimate( const State&, Choice< false > );
+		
+		/**
+		Asks a position whether it can be won on the spot.
+		@param state the position
+		@return its own answer
+		*/
+		inline static int winner( const State& state, Choice< true > );
+		
+		/**
+		Doesn't look for a winning move, for lack of a hook.
+		@return that there is none
+		*/
+		inline static int winner( const State&, Choice< false > );
+		
+		/**
+		Asks a position to become the one whose bytes these are.
+		@param bytes what its <tt>encode()</tt> wrote
+		@param state the position
+		@return its own answer
+		*/
+		inline static bool decode( const std::string& bytes, State&
+			state, Choice< true > );
+		
+		/**
+		Can't rebuild a position, for lack of a hook.
+		@return that it wasn't
+		*/
+		inline static bool decode( const std::string&, State&, Choice<
+			false > );
+		
+		/**
+		Keys a position by its <tt>index()</tt>.
+		@param state the position
+		@param bytes where to append its key
+		*/
+		inline static void identify( const State& state, std::string&
+			bytes, Choice< true > );
+		
+		/**
+		Keys a position by its <tt>encode()</tt> hook.
+		@param state the position
+		@param bytes where to append its key
+		*/
+		inline static void identify( const State& state, std::string&
+			bytes, Choice< false > );
+	
+	public: //facts
+		/** Whether the <tt>State</tt> provides <tt>void
+			orderedSuccessors( std::vector< unsigned int >& order )
+			const</tt>, which lists the indices of its
+			<tt>successors()</tt> from most to least promising */
+		static const bool ordered=sizeof( ordering< State >( NULL ) )==
+			sizeof( char );
+		
+		/** Whether the <tt>State</tt> numbers its positions densely
+			with <tt>uint64_t index( void ) const</tt>, under
+			<tt>uint64_t indices( void ) const</tt> */
+		static const bool indexed=sizeof( indexing< State >( NULL ) )==
+			sizeof( char );
+		
+		/** Whether the <tt>State</tt> provides <tt>unsigned int
+			remaining( void ) const</tt>, which shrinks with every
+			move, so that no position with more left can follow */
+		static const bool measured=sizeof( measuring< State >( NULL ) )==
+			sizeof( char );
+		
+		/** Whether the <tt>State</tt> provides <tt>int evaluate( void )
+			const</tt>, which guesses how an unfinished position
+			will turn out, higher being better for the computer,
+			and zero even */
+		static const bool evaluated=sizeof( evaluating< State >( NULL ) )
+			==sizeof( char );
+		
+		/** Whether the <tt>State</tt> provides <tt>int
+			winningSuccessor( void ) const</tt>, which finds the
+			index of a successor that ends the game in favor of
+			whoever's moving, or <tt>-1</tt>, from its own
+			representation and without building any of them */
+		static const bool decisive=sizeof( finishing< State >( NULL ) )==
+			sizeof( char );
+		
+		/** Whether the <tt>State</tt> provides <tt>bool decode( const
+			std::string& bytes )</tt>, which becomes whichever
+			position of its own <tt>variant()</tt> wrote those bytes
+			with <tt>encode()</tt>, or leaves it alone and returns
+			<tt>false</tt> if none did, so that a position can be
+			sent to another process */
+		static const bool decodable=sizeof( decoding< State >( NULL ) )==
+			sizeof( char );
+	
+	public: //policies
+		/** Whether to skip refuted successors (alpha-beta) rather
+			than visiting every one (full minimax) */
+		static const bool pruning=true;
+		
+		/** Whether to walk the tree on a stack of our own rather
+			than the thread's */
+		static const bool iterative=true;
+		
+		/** Whether the single-threaded memo is looked up by
+			<tt>index()</tt> rather than hashed */
+		static const bool direct=indexed;
+		
+		/**
+		Lists a position's successors, in the order that its
+			<tt>orderedSuccessors()</tt> (if any) refers to.
+		@param state the position
+		@param successors where to put them
+		*/
+		template< class Buffer > inline static void successors( const
+			State& state, Buffer& successors );
+		
+		/**
+		Guesses how an unfinished position will turn out, when there
+			isn't time to search it.
+		@param state the position
+		@return its <tt>evaluate()</tt> if it has one, or else zero
+		*/
+		inline static int estimate( const State& state );
+		
+		/**
+		Finds a move that wins the game outright for whoever's moving,
+			which nothing could better, so that a search needn't
+			look at any of the others.
+		@param state the position, which mustn't be over
+		@return the index of such a successor, if its
+			<tt>winningSuccessor()</tt> spots one, or else
+			<tt>-1</tt>
+		*/
+		inline static int winner( const State& state );
+		
+		/**
+		Keys a position for anything saved outside the program, such
+			as a solution database, so that other runs can find it.
+		@param state the position
+		@param bytes where to append its key
+		*/
+		inline static void identify( const State& state, std::string&
+			bytes );
+		
+		/**
+		Hashes a position the same way in every process, from its
+			<tt>identify()</tt> key, so that the nodes of a cluster
+			agree on which of them holds it.
+		@param state the position
+		@return the hash
+		*/
+		inline static uint64_t digest( const State& state );
+		
+		/**
+		Rebuilds a position sent from another process.
+		@param bytes what its <tt>encode()</tt> wrote
+		@param state any position of the same <tt>variant()</tt>,
+			which becomes the one sent
+		@return whether it did, as only <tt>decodable</tt>
+			<tt>State</tt>s can
+		*/
+		inline static bool decode( const std::string& bytes, State&
+			state );
+};
+
+/**
+Everything a <tt>Solver</tt> knows about a kind of <tt>State</tt> at compile
+time, which is only what <tt>DetectedTraits</tt> detects unless the game
+specializes it.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+template< typename State > class StateTraits : public DetectedTraits< State >
+{
+};
+
+/** @brief Ask the state */
+template< typename State >
+template< class Buffer >
+void DetectedTraits< State >::successors( const State& state, Buffer&
+	successors )
+{
+	state.successors( successors );
+}
+
+/** @brief Ask the state */
+template< typename State >
+int DetectedTraits< State >::estimate( const State& state )
+{
+	return estimate( state, Choice< evaluated >() );
+}
+
+/** @brief Ask the state */
+template< typename State >
+int DetectedTraits< State >::estimate( const State& state, Choice< true > )
+{
+	return state.evaluate();
+}
+
+/** @brief Call it even */
+template< typename State >
+int DetectedTraits< State >::estimate( const State&, Choice< false > )
+{
+	return 0;
+}
+
+/** @brief Ask the state */
+template< typename State >
+int DetectedTraits< State >::winner( const State& state )
+{
+	return winner( state, Choice< decisive >() );
+}
+
+/** @brief Ask the state */
+template< typename State >
+int DetectedTraits< State >::winner( const State& state, Choice< true > )
+{
+	return state.winningSuccessor();
+}
+
+/** @brief Don't look */
+template< typename State >
+int DetectedTraits< State >::winner( const State&, Choice< false > )
+{
+	return -1;
+}
+
+/** @brief Ask the state */
+template< typename State >
+bool DetectedTraits< State >::decode( const std::string& bytes, State& state )
+{
+	return decode( bytes, state, Choice< decodable >() );
+}
+
+/** @brief Ask the state */
+template< typename State >
+bool DetectedTraits< State >::decode( const std::string& bytes, State& state,
+	Choice< true > )
+{
+	return state.decode( bytes );
+}
+
+/** @brief Refuse */
+template< typename State >
+bool DetectedTraits< State >::decode( const std::string&, State&, Choice< false
+	> )
+{
+	return false;
+}
+
+/** @brief Ask the state */
+template< typename State >
+void DetectedTraits< State >::identify( const State& state, std::string&
+	bytes )
+{
+	identify( state, bytes, Choice< indexed >() );
+}
+
+/** @brief Key by index */
+template< typename State >
+void DetectedTraits< State >::identify( const State& state, std::string&
+	bytes, Choice< true > )
+{
+	Encoding::appendVarint( bytes, state.index() );
+}
+
+/** @brief Key by encoding */
+template< typename State >
+void DetectedTraits< State >::identify( const State& state, std::string&
+	bytes, Choice< false > )
+{
+	state.encode( bytes );
+}
+
+/** @brief Hash the key */
+template< typename State >
+uint64_t DetectedTraits< State >::digest( const State& state )
+{
+	std::string bytes;
+	
+	identify( state, bytes );
+	
+	return Encoding::digest( bytes );
+}
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+#include "SubtractionGame.h"
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <utility>
+using namespace std;
+
+/** @brief Constructor */
+SubtractionGame::SubtractionGame( const vector< int >& moves ):
+	takes( moves ), periodicFrom( 0 ), cycle( 0 )
+{
+	sort( takes.begin(), takes.end() );
+	takes.erase( unique( takes.begin(), takes.end() ), takes.end() );
+	assert( !takes.empty() && takes.front()>0 );
+	
+	tabulate();
+}
+
+/** @brief Range constructor */
+SubtractionGame::SubtractionGame( int fewest, int most ):
+	periodicFrom( 0 ), cycle( 0 )
+{
+	assert( 0<fewest && fewest<=most );
+	
+	for( int take=fewest; take<=most; ++take ) takes.push_back( take );
+	
+	tabulate();
+}
+
+/** @brief Tabulate */
+void SubtractionGame::tabulate()
+{
+	const int widest=takes.back(); //how far back any outcome looks
+	map< vector< bool >, int > seen; //each stretch by the pile ending it
+	
+	for( int pile=0; ; ++pile )
+	{
+		bool lose=pile>0; //with none left, the opponent took the last
+		
+		for( vector< int >::const_iterator take=takes.begin(); take!=
+			takes.end() && *take<=pile; ++take )
+			if( lost[pile-*take] ) //leaves the opponent beaten
+			{
+				lose=false;
+				break;
+			}
+		lost.push_back( lose );
+		
+		if( pile+1>=widest ) //every later pile follows from these
+		{
+			pair< map< vector< bool >, int >::iterator, bool > entry=
+				seen.insert( make_pair( vector< bool >( lost.end()-
+				widest, lost.end() ), pile ) );
+			
+			if( !entry.second ) //the same outcomes as before
+			{
+				periodicFrom=entry.first->second-widest+1;
+				cycle=pile-entry.first->second;
+				return;
+			}
+		}
+	}
+}
+
+/** @brief Is it lost? */
+bool SubtractionGame::losing( int pile ) const
+{
+	assert( pile>=0 );
+	
+	if( pile>=periodicFrom+cycle ) //the same as a smaller one
+		pile=periodicFrom+( pile-periodicFrom )%cycle;
+	
+	return lost[pile];
+}
+
+/** @brief Best move */
+int SubtractionGame::bestTake( int pile ) const
+{
+	assert( pile>=0 );
+	
+	for( vector< int >::const_iterator take=takes.begin(); take!=
+		takes.end() && *take<=pile; ++take )
+		if( losing( pile-*take ) ) return *take;
+	
+	if( pile==0 || takes.front()>pile ) return 0; //no move at all
+	return takes.front(); //stall
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUBTRACTIONGAME_H
+#define SUBTRACTIONGAME_H
+
+#include <vector>
+
+/**
+Plays a subtraction game, such as Takeaway, from the pattern of its outcomes
+rather than by searching.  Whether the player to move can win from a pile
+depends only on whether the piles a legal move leaves are lost, so once the
+outcomes of as many consecutive piles as the largest move repeat an earlier
+such stretch, they repeat forever after.  The prefix up to that point is
+tabulated once, at construction; afterward, any pile costs the same to
+evaluate, however large it is.  Like <tt>TakeawayState</tt>, the rules
+have whoever takes the last object lose; a player who has no legal move while
+objects remain loses as well.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+class SubtractionGame
+{
+	private:
+		/** How many objects may be taken at once, in increasing order
+			*/
+		std::vector< int > takes;
+		
+		/** Whether each pile is lost for the player to move, by size,
+			up to at least the end of the first period */
+		std::vector< bool > lost;
+		
+		/** The smallest pile from which the outcomes are periodic */
+		int periodicFrom;
+		
+		/** The length of the outcomes' period */
+		int cycle;
+		
+		/**
+		Computes the outcomes of successive piles until they repeat.
+		*/
+		void tabulate( void );
+	
+	public:
+		/**
+		Solves the game with an arbitrary set of moves.
+		@pre The set is nonempty and its members are positive.
+		@param moves the numbers of objects that may be taken at once
+		*/
+		explicit SubtractionGame( const std::vector< int >& moves );
+		
+		/**
+		Solves the game in which any number of objects within a range
+			may be taken at once.
+		@pre <tt>0<fewest<=most</tt>
+		@param fewest the least that may be taken
+		@param most the most that may be taken
+		*/
+		SubtractionGame( int fewest, int most );
+		
+		/**
+		Judges a pile.
+		@pre <tt>pile>=0</tt>
+		@param pile how many objects remain
+		@return whether the player to move will lose against perfect
+			play
+		*/
+		bool losing( int pile ) const;
+		
+		/**
+		Picks the move a <tt>Solver</tt> would: the smallest take that
+			leaves a lost pile, or just the smallest legal take if
+			there is no such move.
+		@pre <tt>pile>=0</tt>
+		@param pile how many objects remain
+		@return how many objects to take, or <tt>0</tt> if there is
+			no legal move
+		*/
+		int bestTake( int pile ) const;
+		
+		/**
+		Reveals where the outcomes start repeating.
+		@return the smallest pile from which they are periodic
+		*/
+		inline int preperiod( void ) const;
+		
+		/**
+		Reveals how often the outcomes repeat.
+		@return the length of their period
+		*/
+		inline int period( void ) const;
+};
+
+/** @brief Where does it start? */
+int SubtractionGame::preperiod() const
+{
+	return periodicFrom;
+}
+
+/** @brief How long is it? */
+int SubtractionGame::period() const
+{
+	return cycle;
+}
+
+#endif
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TABLESTATISTICS_H
+#define TABLESTATISTICS_H
+
+#include <stdint.h>
+
+/**
+What a memo table has been through: how hard its lookups have had to look,
+and how full it has gotten.  The counters accumulate over the table's
+lifetime, while <tt>entries</tt> and <tt>capacity</tt> describe it as it
+stands; a table made of several others reports their sum.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+class TableStatistics
+{
+	public:
+		/** How many times a key was searched for */
+		uint64_t lookups;
+		
+		/** How many slots those searches examined in all */
+		uint64_t probes;
+		
+		/** The most slots any one search examined */
+		uint64_t longestProbe;
+		
+		/** How many times the table enlarged itself */
+		uint64_t grows;
+		
+		/** How many entries were replaced to make room for others */
+		uint64_t evictions;
+		
+		/** How many entries were swept out as no longer needed */
+		uint64_t swept;
+		
+		/** How many entries the table holds now */
+		uint64_t entries;
+		
+		/** The most entries the table has ever held at once */
+		uint64_t peakEntries;
+		
+		/** How many entries the table has room for now */
+		uint64_t capacity;
+		
+		/**
+		Starts every count at zero.
+		*/
+		inline TableStatistics( void );
+		
+		/**
+		Folds in the statistics of another table.
+		@param other the other table's statistics
+		*/
+		inline void add( const TableStatistics& other );
+};
+
+/** @brief Constructor */
+TableStatistics::TableStatistics():
+	lookups( 0 ), probes( 0 ), longestProbe( 0 ), grows( 0 ),
+	evictions( 0 ), swept( 0 ), entries( 0 ), peakEntries( 0 ),
+	capacity( 0 ) {}
+
+/** @brief Sum */
+void TableStatistics::add( const TableStatistics& other )
+{
+	lookups+=other.lookups;
+	probes+=other.probes;
+	if( other.longestProbe>longestProbe ) longestProbe=other.longestProbe;
+	grows+=other.grows;
+	evictions+=other.evictions;
+	swept+=other.swept;
+	entries+=other.entries;
+	peakEntries+=other.peakEntries; //they needn't have peaked together
+	capacity+=other.capacity;
+}
+
+#endif
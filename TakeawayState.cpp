@@ -1,11 +1,13 @@
 /** @author Sol Boucher <slb1566@rit.edu> */
 #include "TakeawayState.h"
+#include "Encoding.h"
 #include <iostream>
 #include <sstream>
 using namespace std;
 
 /** @brief What might happen next? */
-void TakeawayState::successors( vector< TakeawayState >& possibilities ) const
+void TakeawayState::successors( MoveBuffer< TakeawayState >& possibilities )
+	const
 {
 	#ifdef DEBUG
 		cout<<"Success calculating successors for "<<str()<<'\n';
@@ -37,3 +39,20 @@ string TakeawayState::str() const
 	
 	return assembler.str();
 }
+
+/** @brief Which rules? */
+string TakeawayState::variant() const
+{
+	stringstream assembler;
+	
+	assembler<<"takeaway "<<MIN_TAKEN<<'-'<<MAX_TAKEN;
+	
+	return assembler.str();
+}
+
+/** @brief Serializes */
+void TakeawayState::encode( string& bytes ) const
+{
+	Encoding::appendVarint( bytes, uint64_t( pileSize )<<1|( ourTurn ? 1 :
+		0 ) );
+}
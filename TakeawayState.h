@@ -17,6 +17,7 @@
 #ifndef TAKEAWAYSTATE_H
 #define TAKEAWAYSTATE_H
 
+#include "MoveBuffer.h"
 #include <cassert>
 #include <string>
 #include <vector>
@@ -102,7 +103,7 @@ class TakeawayState
 		Returns all possible successor states.
 		@return whatever might happen next
 		*/
-		void successors( std::vector< TakeawayState >& result ) const;
+		void successors( MoveBuffer< TakeawayState >& result ) const;
 		
 		/**
 		Retrieves the pile size.
@@ -110,12 +111,34 @@ class TakeawayState
 		*/
 		inline int getPileSize( void ) const;
 		
+		/**
+		Counts the pennies left, at least one of which every move
+			takes.
+		@return how many there are
+		*/
+		inline unsigned int remaining( void ) const;
+		
 		/**
 		Produces a synopsis of this <tt>State</tt>'s particulars.
 		@return the <tt>string</tt> representation
 		*/
 		std::string str( void ) const;
 		
+		/**
+		Names the variant of the game this <tt>State</tt> belongs
+			to, which decides which others it can be compared with.
+		@return the name, including any parameters of the rules
+		*/
+		std::string variant( void ) const;
+		
+		/**
+		Identifies this <tt>State</tt> among the others of its
+			<tt>variant()</tt>.
+		@param bytes where to append a byte string that equal
+			<tt>State</tt>s, and they alone, share
+		*/
+		void encode( std::string& bytes ) const;
+		
 		/**
 		Hashes the <tt>State</tt>.
 		@post The result is nonnegative.
@@ -190,6 +213,12 @@ int TakeawayState::getPileSize() const
 	return pileSize;
 }
 
+/** @brief How many left? */
+unsigned int TakeawayState::remaining() const
+{
+	return pileSize;
+}
+
 /** @brief Hashing */
 int TakeawayState::hash() const
 {
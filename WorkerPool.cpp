@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @author Sol Boucher <slb1566@rit.edu> */
+#include "WorkerPool.h"
+#include <cassert>
+using namespace std;
+
+/** @brief Destructor */
+Task::~Task() {}
+
+/** @brief Constructor */
+TaskGroup::TaskGroup():
+	pending( 0 ) {}
+
+/** @brief All done? */
+bool TaskGroup::finished() const
+{
+	return pending==0;
+}
+
+/** @brief Constructor */
+WorkerPool::WorkerPool( unsigned int workers ):
+	queues(), threads(), queued( 0 ), closing( false ), idleLock(), idle()
+{
+	if( workers==0 ) workers=1; //we're always here
+	
+	for( unsigned int worker=0; worker<workers; ++worker )
+		queues.push_back( new Queue() );
+	for( unsigned int worker=1; worker<workers; ++worker )
+		threads.push_back( thread( &WorkerPool::work, this, worker ) );
+}
+
+/** @brief Destructor */
+WorkerPool::~WorkerPool()
+{
+	{
+		lock_guard< mutex > guard( idleLock );
+		closing=true;
+	}
+	idle.notify_all();
+	
+	for( vector< thread >::iterator worker=threads.begin();
+		worker!=threads.end(); ++worker )
+		worker->join();
+	for( vector< Queue* >::iterator queue=queues.begin();
+		queue!=queues.end(); ++queue )
+	{
+		assert( ( *queue )->tasks.empty() );
+		delete *queue;
+	}
+}
+
+/** @brief Head count */
+unsigned int WorkerPool::size() const
+{
+	return queues.size();
+}
+
+/** @brief Find something to do */
+bool WorkerPool::runOne( unsigned int worker )
+{
+	pair< Task*, TaskGroup* > job( NULL, NULL );
+	
+	//our own newest task is likeliest to share our cache:
+	{
+		Queue& mine=*queues[worker];
+		lock_guard< mutex > guard( mine.lock );
+		
+		if( !mine.tasks.empty() )
+		{
+			job=mine.tasks.back();
+			mine.tasks.pop_back();
+		}
+	}
+	
+	//failing that, someone else's oldest is likeliest to be big:
+	for( unsigned int offset=1; job.first==NULL && offset<queues.size();
+		++offset )
+	{
+		Queue& victim=*queues[( worker+offset )%queues.size()];
+		lock_guard< mutex > guard( victim.lock );
+		
+		if( !victim.tasks.empty() )
+		{
+			job=victim.tasks.front();
+			victim.tasks.pop_front();
+		}
+	}
+	
+	if( job.first==NULL ) return false; //nothing doing
+	
+	--queued;
+	job.first->run( worker );
+	--job.second->pending;
+	
+	return true;
+}
+
+/** @brief Worker thread main */
+void WorkerPool::work( unsigned int worker )
+{
+	while( !closing )
+		if( !runOne( worker ) ) //nothing to do, so nap
+		{
+			unique_lock< mutex > guard( idleLock );
+			
+			while( !closing && queued==0 )
+				idle.wait( guard );
+		}
+}
+
+/** @brief Enqueue */
+void WorkerPool::spawn( unsigned int worker, Task& task, TaskGroup& group )
+{
+	assert( worker<queues.size() );
+	
+	++group.pending;
+	{
+		Queue& mine=*queues[worker];
+		lock_guard< mutex > guard( mine.lock );
+		
+		mine.tasks.push_back( make_pair( &task, &group ) );
+	}
+	{
+		lock_guard< mutex > guard( idleLock );
+		++queued;
+	}
+	idle.notify_one();
+}
+
+/** @brief Help out until our work is done */
+void WorkerPool::wait( unsigned int worker, TaskGroup& group )
+{
+	while( !group.finished() )
+		if( !runOne( worker ) ) //it's all in progress elsewhere
+			this_thread::yield();
+}
+
+/** @brief How many can we have? */
+unsigned int WorkerPool::available()
+{
+	unsigned int hardware=thread::hardware_concurrency();
+	
+	return hardware ? hardware : 1;
+}
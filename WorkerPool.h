@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2012 Sol Boucher and Kyle Savarese
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with it.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+A unit of work that may be run on any of a <tt>WorkerPool</tt>'s threads.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+class Task
+{
+	public:
+		/**
+		Destroys the <tt>Task</tt>.
+		*/
+		virtual ~Task( void );
+		
+		/**
+		Does the work.
+		@param worker the index of the thread doing it
+		*/
+		virtual void run( unsigned int worker )=0;
+};
+
+/**
+A set of <tt>Task</tt>s whose completion someone is waiting on.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+class TaskGroup
+{
+	friend class WorkerPool;
+	
+	private:
+		/** How many of the group's tasks haven't finished */
+		std::atomic< unsigned int > pending;
+	
+	public:
+		/**
+		Creates an empty group.
+		*/
+		TaskGroup( void );
+		
+		/**
+		Checks whether everything has finished.
+		@return whether no tasks are pending
+		*/
+		bool finished( void ) const;
+};
+
+/**
+A fixed set of threads that run <tt>Task</tt>s by work stealing: each worker
+keeps its own deque, works from the newest end of it, and steals from the
+oldest end of someone else's once it runs dry.  The thread that creates the
+pool counts as worker 0 and only works while it is waiting on a group.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+class WorkerPool
+{
+	private:
+		/**
+		One worker's backlog.
+		*/
+		struct Queue
+		{
+			/** Protects <tt>tasks</tt> */
+			std::mutex lock;
+			
+			/** The work, newest at the back */
+			std::deque< std::pair< Task*, TaskGroup* > > tasks;
+		};
+		
+		/** Each worker's backlog */
+		std::vector< Queue* > queues;
+		
+		/** The threads for workers 1 and up */
+		std::vector< std::thread > threads;
+		
+		/** How many tasks are waiting to be picked up */
+		std::atomic< unsigned int > queued;
+		
+		/** Whether the pool is shutting down */
+		std::atomic< bool > closing;
+		
+		/** Protects the idle workers' sleep */
+		std::mutex idleLock;
+		
+		/** Wakes up idle workers */
+		std::condition_variable idle;
+		
+		/**
+		Runs a single task, if one is available anywhere.
+		@param worker the index of the calling thread
+		@return whether a task was run
+		*/
+		bool runOne( unsigned int worker );
+		
+		/**
+		Runs tasks until the pool shuts down.
+		@param worker the index of the calling thread
+		*/
+		void work( unsigned int worker );
+		
+		/**
+		Copying is unsupported.
+		*/
+		WorkerPool( const WorkerPool& );
+		
+		/**
+		Assignment is unsupported.
+		*/
+		WorkerPool& operator=( const WorkerPool& );
+	
+	public:
+		/**
+		Starts the workers.
+		@param workers how many threads to work with, including the
+			calling one
+		*/
+		explicit WorkerPool( unsigned int workers );
+		
+		/**
+		Stops the workers.
+		@pre No tasks are outstanding.
+		*/
+		~WorkerPool( void );
+		
+		/**
+		Counts the workers.
+		@return how many threads work, including worker 0
+		*/
+		unsigned int size( void ) const;
+		
+		/**
+		Queues up a task.
+		@param worker the index of the calling thread
+		@param task the work to do, which must outlive its execution
+		@param group the group to which the task belongs
+		*/
+		void spawn( unsigned int worker, Task& task, TaskGroup& group );
+		
+		/**
+		Works on queued tasks until every task in a group has finished.
+		@param worker the index of the calling thread
+		@param group the group to wait on
+		*/
+		void wait( unsigned int worker, TaskGroup& group );
+		
+		/**
+		Decides how many threads to use when the user leaves it up to
+			us.
+		@return the number of hardware threads, or 1 if unknown
+		*/
+		static unsigned int available( void );
+};
+
+#endif
@@ -0,0 +1,236 @@
+/**
+The benchmark driver, which has the Solver decide a fixed corpus of positions
+from each game, one process apiece, and reports how quickly it did and how much
+memory that took as one line of JSON per position.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+#include "Solver.h"
+#include "SolverOptions.h"
+#include "Connect3State.h"
+#include "CrossoutState.h"
+#include "KaylesState.h"
+#include "TakeawayState.h"
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+using namespace std;
+
+/** The Takeaway piles to decide */
+static const int PILES[]={ 100, 1000, 10000, 100000 };
+
+/** The Kayles rows to decide */
+static const char* const ROWS[]={ "6 5 4", "10 8 6", "12 10 7", "5 5 5 5" };
+
+/** The empty Connect-3 boards to decide, as columns by height */
+static const unsigned int BOARDS[][2]={ { 4, 4 }, { 5, 4 }, { 6, 5 }, { 7, 5 },
+	{ 6, 6 } };
+
+/** The Crossout trays to decide, as max_num and max_sum */
+static const int TRAYS[][2]={ { 10, 30 }, { 14, 40 }, { 16, 60 }, { 18,
+	80 } };
+
+/**
+Counts the elements of an array.
+@param array the array
+@return how many
+*/
+template< typename Element, size_t COUNT >
+static size_t lengthOf( const Element ( & )[COUNT] )
+{
+	return COUNT;
+}
+
+/**
+Decides a position, keeping the fastest of several tries, and reports it.
+@param game the game's name
+@param label the position's name
+@param root the position
+@param options how to configure each <tt>Solver</tt>
+@param repeat how many times to try
+*/
+template< typename State >
+static void measure( const char* game, const string& label, const State&
+	root, const SolverOptions& options, unsigned int repeat )
+{
+	SolverStatistics best;
+	struct rusage usage;
+	
+	for( unsigned int trial=0; trial<repeat; ++trial )
+	{
+		Solver< State > solver( root );
+		
+		options.prepare( solver );
+		solver.nextBestState();
+		
+		SolverStatistics latest=solver.statistics();
+		
+		if( trial==0 || latest.seconds<best.seconds ) best=latest;
+	}
+	getrusage( RUSAGE_SELF, &usage );
+	
+	cout<<"{\"game\":\""<<game<<"\",\"position\":\""<<label
+		<<"\",\"seconds\":"<<best.seconds<<",\"positions\":"
+		<<best.positions<<",\"positionsPerSecond\":"<<( best.seconds>0 ?
+		best.positions/best.seconds : 0 )<<",\"memoEntries\":"
+		<<best.memo.entries<<",\"peakMemoEntries\":"
+		<<best.memo.peakEntries<<",\"peakRssKb\":"<<usage.ru_maxrss
+		<<'}'<<endl;
+}
+
+/**
+Runs <tt>measure()</tt> in a process of its own, so that each position's peak
+	memory use is its own and no position inherits another's warm heap.
+@param game the game's name
+@param label the position's name
+@param root the position
+@param options how to configure each <tt>Solver</tt>
+@param repeat how many times to try
+@return whether it went through
+*/
+template< typename State >
+static bool isolate( const char* game, const string& label, const State&
+	root, const SolverOptions& options, unsigned int repeat )
+{
+	int status;
+	pid_t child;
+	
+	cout.flush(); //or the child would repeat what's still buffered
+	if( ( child=fork() )==0 )
+	{
+		measure( game, label, root, options, repeat );
+		_exit( 0 );
+	}
+	else if( child<0 ) //do without
+	{
+		measure( game, label, root, options, repeat );
+		
+		return true;
+	}
+	
+	return waitpid( child, &status, 0 )==child && WIFEXITED( status ) &&
+		WEXITSTATUS( status )==0;
+}
+
+/**
+Decides whether a game was asked for.
+@param game the game's name
+@param names the games asked for, or none for all of them
+@return whether to benchmark it
+*/
+static bool wanted( const char* game, const vector< string >& names )
+{
+	if( names.empty() ) return true;
+	
+	for( vector< string >::const_iterator name=names.begin();
+		name!=names.end(); ++name )
+		if( *name==game ) return true;
+	
+	return false;
+}
+
+/**
+Reads a natural number from the command line.
+@param text the number as typed
+@param value where to put it
+@return whether it was a positive integer
+*/
+static bool readPositive( const char* text, unsigned int& value )
+{
+	char* end;
+	long number=strtol( text, &end, 10 );
+	
+	if( *text=='\0' || *end!='\0' || number<=0 || number>INT_MAX )
+		return false;
+	
+	value=static_cast< unsigned int >( number );
+	
+	return true;
+}
+
+int main( int argc, char** argv )
+{
+	const char* REPEAT="--repeat";
+	const char* GAMES[]={ "takeaway", "kayles", "connect3", "crossout" };
+	const int FAILURE=1;
+	SolverOptions options;
+	unsigned int repeat=1;
+	vector< string > names;
+	bool usable=options.parse( argc, argv );
+	
+	for( int arg=1; arg<argc && usable; ++arg )
+		if( strcmp( argv[arg], REPEAT )==0 )
+			usable=arg+1<argc && readPositive( argv[++arg], repeat );
+		else
+		{
+			usable=false;
+			for( size_t game=0; game<lengthOf( GAMES ); ++game )
+				if( strcmp( argv[arg], GAMES[game] )==0 )
+					usable=true;
+			names.push_back( argv[arg] );
+		}
+	if( !usable )
+	{
+		cerr<<"USAGE: benchmark "<<SolverOptions::USAGE<<" [--repeat N] "
+			<<"[takeaway] [kayles] [connect3] [crossout]"<<endl;
+		
+		return FAILURE; //I have failed, Master
+	}
+	
+	bool succeeded=true;
+	
+	if( wanted( GAMES[0], names ) )
+		for( size_t pile=0; pile<lengthOf( PILES ); ++pile )
+		{
+			ostringstream label;
+			
+			label<<PILES[pile];
+			succeeded&=isolate( GAMES[0], label.str(), TakeawayState(
+				PILES[pile] ), options, repeat );
+		}
+	if( wanted( GAMES[1], names ) )
+		for( size_t row=0; row<lengthOf( ROWS ); ++row )
+		{
+			istringstream counts( ROWS[row] );
+			vector< int > pins;
+			int count;
+			
+			while( counts>>count ) pins.push_back( count );
+			succeeded&=isolate( GAMES[1], ROWS[row], KaylesState( pins ),
+				options, repeat );
+		}
+	if( wanted( GAMES[2], names ) )
+		for( size_t board=0; board<lengthOf( BOARDS ); ++board )
+		{
+			unsigned int columns=BOARDS[board][0];
+			unsigned int height=BOARDS[board][1];
+			ostringstream label;
+			
+			if( !Connect3State::fits( columns, height ) ) continue;
+			label<<columns<<'x'<<height;
+			succeeded&=isolate( GAMES[2], label.str(), Connect3State(
+				columns, height, vector< vector< char > >( columns ) ),
+				options, repeat );
+		}
+	if( wanted( GAMES[3], names ) )
+		for( size_t tray=0; tray<lengthOf( TRAYS ); ++tray )
+		{
+			int maxNum=TRAYS[tray][0];
+			int maxSum=TRAYS[tray][1];
+			ostringstream label;
+			
+			if( !CrossoutState::fits( maxSum, maxNum ) ) continue;
+			label<<maxNum<<' '<<maxSum;
+			succeeded&=isolate( GAMES[3], label.str(), CrossoutState(
+				maxSum, maxNum ), options, repeat );
+		}
+	
+	return succeeded ? 0 : FAILURE;
+}
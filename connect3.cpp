@@ -4,13 +4,176 @@ The Connect-3 game.
 @author Sol Boucher <slb1566@rit.edu>
 */
 #include "Solver.h"
+#include "SolverOptions.h"
 #include "Connect3State.h"
 #include "Connect3Helper.h"
+#include "MappedFile.h"
+#include "OpeningBook.h"
+#include <climits>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 using namespace std;
 
+/**
+Tells the player who's up where to place a piece.
+@param game the <tt>Solver</tt>, at the position in question
+@param options how long to think about it
+@param proving whether only a forced win will do
+*/
+static void advise( Solver< Connect3State >& game, const SolverOptions&
+	options, bool proving )
+{
+	Connect3State config=game.getCurrentState();
+	
+	if( config.gameOver() )
+		cout<<"You have no move to make;"<<"you have already "
+			<<( config.scoreGame()==Connect3State::VICTORY ? "won" :
+			"lost" )<<'.'<<endl;
+	else if( !proving )
+		cout<<"Place a piece in column "<<Connect3State::diff( config,
+			options.advance( game ) )<<endl;
+	else if( game.forcesWin() ) //and now the memo knows how
+		cout<<"Place a piece in column "<<Connect3State::diff( config,
+			game.nextBestState() )<<" to force a win"<<endl;
+	else
+		cout<<"There is no forced win from here."<<endl;
+}
+
+/**
+Tells the player who's up where to place a piece without searching, if the
+	opening book knows.
+@param book the opening book
+@param config the position in question
+@return whether it did
+*/
+static bool recite( const OpeningBook& book, const Connect3State& config )
+{
+	Connect3State outcome=config;
+	
+	if( !book.move( config, outcome ) ) return false;
+	
+	cout<<"Place a piece in column "<<Connect3State::diff( config,
+		outcome )<<endl;
+	
+	return true;
+}
+
+/**
+Advises on each of a series of boards, one after another, in a single line
+	apiece.
+@param boards the encoded boards
+@param options how to go about it
+@param proving whether only a forced win will do
+@return whether every board was readable
+*/
+static bool advise( istream& boards, const SolverOptions& options, bool
+	proving )
+{
+	Solver< Connect3State >* game=NULL;
+	OpeningBook book;
+	vector< vector< char > > board;
+	int height;
+	bool read=true;
+	
+	options.consult( book );
+	while( read && ( boards>>ws ).peek()!=EOF ) //there's another board
+	{
+		read=Connect3Helper::decodeBoard( boards, board, height ); //if
+			//not, we can't even find the next one
+		if( !read ) continue;
+		
+		if( !Connect3State::fits( board.size(), height ) )
+			cout<<"ERROR: Board too large for this build."<<endl;
+		else
+		{
+			Connect3State config( board.size(), height, board );
+			
+			if( proving || !recite( book, config ) ) //the book
+				//knows best moves, not forced wins
+			{
+				game=options.reuse( game, config );
+				advise( *game, options, proving );
+			}
+		}
+	}
+	
+	if( game!=NULL ) options.finish( *game );
+	delete game;
+	
+	return read;
+}
+
+/**
+Advises on each of a batch of boards packed one to a record, as
+	<tt>Connect3Helper::unpackBoard()</tt> reads them, in a single line
+	apiece.
+@param path where the batch is
+@param options how to go about it
+@param proving whether only a forced win will do
+@return whether the whole batch was readable
+*/
+static bool advise( const char* path, const SolverOptions& options, bool
+	proving )
+{
+	Solver< Connect3State >* game=NULL;
+	OpeningBook book;
+	MappedFile batch;
+	const char* cursor;
+	const char* record;
+	const char* recordEnd;
+	
+	if( !batch.open( path ) ) return false;
+	options.consult( book );
+	for( cursor=batch.begin(); Encoding::readRecord( cursor, batch.end(),
+		record, recordEnd ); )
+	{
+		Connect3State::Board pieces[2];
+		unsigned int width, height;
+		
+		if( !Connect3Helper::unpackBoard( record, recordEnd, width,
+			height, pieces ) || record!=recordEnd )
+			cout<<"ERROR: Not a valid board."<<endl;
+		else if( !Connect3State::fits( width, height ) )
+			cout<<"ERROR: Board too large for this build."<<endl;
+		else
+		{
+			Connect3State config( width, height, pieces );
+			
+			if( proving || !recite( book, config ) )
+			{
+				game=options.reuse( game, config );
+				advise( *game, options, proving );
+			}
+		}
+	}
+	
+	if( game!=NULL ) options.finish( *game );
+	delete game;
+	
+	return cursor==batch.end();
+}
+
+/**
+Reads a natural number from the command line.
+@param text the number as typed
+@param value where to put it
+@return whether it was a nonnegative integer
+*/
+static bool readNatural( const char* text, unsigned int& value )
+{
+	char* end;
+	long number=strtol( text, &end, 10 );
+	
+	if( *text=='\0' || *end!='\0' || number<0 || number>INT_MAX )
+		return false;
+	
+	value=static_cast< unsigned int >( number );
+	
+	return true;
+}
+
 int main( int argc, char** argv )
 {
 	const int MIN_ARGS=2;
@@ -19,14 +182,83 @@ int main( int argc, char** argv )
 	const char* PLAY="play";
 	const int SIG_INDEX=1; //significant index
 	const int FAILURE=1; //return code
+	const char* ASYMMETRIC="--asymmetric";
+	const char* PROVE="--prove";
+	const char* CLUSTER="--cluster";
+	const char* NODE="--node";
 	
-	if( argc<MIN_ARGS || argc>PLAY_ARGS || ( argc==PLAY_ARGS &&
+	SolverOptions options;
+	bool proving=false;
+	const char* hosts=NULL;
+	unsigned int node=0;
+	bool usable=true;
+	int kept=1;
+	for( int arg=1; arg<argc && usable; ++arg )
+		if( strcmp( argv[arg], ASYMMETRIC )==0 )
+			Connect3State::symmetric=false; //tell mirror images apart
+		else if( strcmp( argv[arg], PROVE )==0 )
+			proving=true; //just find out whether there's a win
+		else if( strcmp( argv[arg], CLUSTER )==0 ) //search with others
+		{
+			usable=arg+1<argc;
+			if( usable ) hosts=argv[++arg];
+		}
+		else if( strcmp( argv[arg], NODE )==0 )
+			usable=arg+1<argc && readNatural( argv[++arg], node );
+		else argv[kept++]=argv[arg];
+	argc=kept;
+	if( !usable || ( node>0 && hosts==NULL ) || !options.parse( argc,
+		argv ) || argc<MIN_ARGS ||
+		argc>PLAY_ARGS || ( argc==PLAY_ARGS &&
 		strcmp( argv[SIG_INDEX], PLAY )!=0 ) )
 	{
-		cerr<<"USAGE: connect3 [play] -"<<endl;
+		cerr<<"USAGE: connect3 "<<SolverOptions::USAGE
+			<<" [--asymmetric] [--prove] [--cluster hosts_file [--node N]] "
+			<<"[play] <filename | ->"<<endl;
+		cerr<<"       (with --batch, the file may hold many boards, one "
+			<<"after another, packed with --packed)"<<endl;
 		
 		return FAILURE; //I have failed, Master
 	}
+	else if( hosts!=NULL && ( options.batch || argc!=MIN_ARGS ) )
+	{
+		cerr<<"FATAL: --cluster only advises on a single board"<<endl;
+		
+		return FAILURE;
+	}
+	else if( options.batch ) //advise on many boards
+	{
+		if( argc!=MIN_ARGS ) //there's no playing them all at once
+		{
+			cerr<<"FATAL: --batch can't be used to play"<<endl;
+			
+			return FAILURE;
+		}
+		
+		if( options.packed ) //map it, whether file or stdin
+		{
+			if( advise( argv[argc-1], options, proving ) ) return 0;
+			
+			cerr<<"FATAL: Unable to read batch "<<argv[argc-1]
+				<<endl;
+			
+			return FAILURE;
+		}
+		if( strcmp( argv[argc-1], STDIN )==0 ) //read from stdin
+			return advise( cin, options, proving ) ? 0 : FAILURE;
+		
+		ifstream file( argv[argc-1] );
+		
+		if( file.fail() )
+		{
+			cerr<<"FATAL: Unable to open file "<<argv[argc-1]
+				<<endl;
+			
+			return FAILURE;
+		}
+		
+		return advise( file, options, proving ) ? 0 : FAILURE;
+	}
 	else //valid argument syntax
 	{
 		vector< vector< char > > board;
@@ -60,28 +292,56 @@ int main( int argc, char** argv )
 			file.close();
 		}
 		
+		if( !Connect3State::fits( board.size(), height ) )
+		{
+			cerr<<"FATAL: Board too large for this build (try make "
+				<<"wide)"<<endl;
+			
+			return FAILURE;
+		}
+		
 		if( argc==MIN_ARGS ) //advice hotline
 		{
 			Connect3State config=Connect3State( board.size(),
 				height, board );
-			Solver< Connect3State > game( config );
+			OpeningBook book;
+			options.consult( book );
 			
 			cout<<config.str()<<endl;
-			if( config.gameOver() )
-				cout<<"You have no move to make;"
-				<<"you have already "<<( config.scoreGame()==
-				Connect3State::VICTORY ? "won" : "lost" )<<'.'
-				<<endl;
-			else
-				cout<<"Place a piece in column "
-					<<Connect3State::diff( config,
-					game.nextBestState() )<<endl;
+			if( proving || hosts!=NULL || !recite( book, config ) )
+				//the rest of the cluster is waiting for us
+			{
+				Solver< Connect3State > game( config );
+				options.prepare( game );
+				
+				if( hosts!=NULL && !game.distribute( hosts, node,
+					options.splitDepth ) )
+				{
+					cerr<<"FATAL: Unable to reach every node "
+						<<"in "<<hosts<<endl;
+					
+					return FAILURE;
+				}
+				if( node>0 ) //we're just helping out
+				{
+					if( game.serve() ) return 0;
+					
+					cerr<<"FATAL: Node 0 is on another board"
+						<<endl;
+					
+					return FAILURE;
+				}
+				
+				advise( game, options, proving );
+				options.finish( game );
+			}
 		}
 		else //interact
 		{
 			Connect3State current( board.size(), height, board,
 				false ); //human's turn
 			Solver< Connect3State > game( current );
+			options.prepare( game );
 			
 			while( !game.getCurrentState().gameOver() )
 			{
@@ -92,8 +352,8 @@ int main( int argc, char** argv )
 					current=game.getCurrentState();
 					cout<<"Computer: augments column "
 						<<Connect3State::diff(
-						current, game.nextBestState()
-						)<<endl;
+						current, options.advance( game
+						) )<<endl;
 				}
 				else //player's turn
 				{
@@ -134,6 +394,7 @@ int main( int argc, char** argv )
 				Connect3State::LOSS ? "You win" : "You tie" )
 				)<<"!  (Your score was "<<-game.
 				getCurrentState().scoreGame()<<".)"<<endl;
+			options.finish( game );
 		}
 	}
 }
@@ -4,7 +4,12 @@ The Crossout game.
 @author Sol Boucher <slb1566@rit.edu>
 */
 #include "Solver.h"
+#include "SolverOptions.h"
 #include "CrossoutState.h"
+#include "Encoding.h"
+#include "MappedFile.h"
+#include "OpeningBook.h"
+#include <climits>
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
@@ -12,6 +17,109 @@ The Crossout game.
 #include <iostream>
 using namespace std;
 
+/**
+Tells the player who's up which numbers to cross out.
+@param starting the position in question
+@param outcome the position after the move
+*/
+static void suggest( const CrossoutState& starting, const CrossoutState&
+	outcome )
+{
+	vector< int > advice=CrossoutState::diff( starting, outcome );
+	
+	cout<<"Cross out:";
+	for( vector< int >::iterator piece=advice.begin();
+		piece!=advice.end(); ++piece )
+		cout<<' '<<*piece;
+	cout<<endl;
+}
+
+/**
+Tells the player who's up which numbers to cross out.
+@param game the <tt>Solver</tt>, at the position in question
+@param options how long to think about it
+*/
+static void advise( Solver< CrossoutState >& game, const SolverOptions&
+	options )
+{
+	CrossoutState starting=game.getCurrentState();
+	
+	if( starting.gameOver() )
+		cout<<"There is nothing you can cross out; you have already "
+			<<"won."<<endl;
+	else
+		suggest( starting, options.advance( game ) );
+}
+
+/**
+Tells the player who's up which numbers to cross out without searching, if
+	the opening book knows.
+@param book the opening book
+@param starting the position in question
+@return whether it did
+*/
+static bool recite( const OpeningBook& book, const CrossoutState& starting )
+{
+	CrossoutState outcome=starting;
+	
+	if( !book.move( starting, outcome ) ) return false;
+	
+	suggest( starting, outcome );
+	
+	return true;
+}
+
+/**
+Advises on each of a batch of trays packed one to a record, each holding its
+	max_num and then its max_sum as varints.
+@param path where the batch is
+@param options how to go about it
+@return whether the whole batch was readable
+*/
+static bool advise( const char* path, const SolverOptions& options )
+{
+	Solver< CrossoutState >* game=NULL;
+	OpeningBook book;
+	MappedFile batch;
+	const char* cursor;
+	const char* record;
+	const char* recordEnd;
+	
+	if( !batch.open( path ) ) return false;
+	options.consult( book );
+	for( cursor=batch.begin(); Encoding::readRecord( cursor, batch.end(),
+		record, recordEnd ); )
+	{
+		uint64_t maxNum, maxSum;
+		
+		//answer even what we can't, to keep in step:
+		if( !Encoding::readVarint( record, recordEnd, maxNum ) ||
+			!Encoding::readVarint( record, recordEnd, maxSum ) ||
+			record!=recordEnd || maxNum==0 || maxSum==0 ||
+			maxNum>INT_MAX || maxSum>INT_MAX )
+			cout<<"ERROR: Not a valid max_num and max_sum."<<endl;
+		else if( !CrossoutState::fits( int( maxSum ), int( maxNum ) ) )
+			cout<<"ERROR: Too many numbers may be taken for this "
+				<<"build."<<endl;
+		else
+		{
+			CrossoutState starting( static_cast< int >( maxSum ),
+				static_cast< int >( maxNum ) ); //our turn
+			
+			if( !recite( book, starting ) )
+			{
+				game=options.reuse( game, starting );
+				advise( *game, options );
+			}
+		}
+	}
+	
+	if( game!=NULL ) options.finish( *game );
+	delete game;
+	
+	return cursor==batch.end();
+}
+
 int main( int argc, char** argv )
 {
 	const char* PLAY = "play";
@@ -22,15 +130,67 @@ int main( int argc, char** argv )
 	const int WHICH_SUM = 1; //where to find max sum after parsing
 	const int FAILURE = 1;
 	
+	SolverOptions options;
 	//check argument count and switches
-	if( argc<MIN_ARGS || argc>PLAY_ARGS || ( argc==PLAY_ARGS &&
-		strcmp( argv[SIG_INDEX], PLAY )!=0 ) ) //ba
+	if( !options.parse( argc, argv ) || ( options.batch ? argc!=1 :
+		argc<MIN_ARGS || argc>PLAY_ARGS || ( argc==PLAY_ARGS &&
+		strcmp( argv[SIG_INDEX], PLAY )!=0 ) ) ) //ba
 		//d arguments
 	{
-		cerr<<"USAGE: crossout [play] max_num max_sum"<<endl;
+		cerr<<"USAGE: crossout "<<SolverOptions::USAGE
+			<<" [play] max_num max_sum"<<endl;
+		cerr<<"       (with --batch, one max_num max_sum per line of "
+			<<"standard input, or per record with --packed)"<<endl;
 		
 		return FAILURE; //I have failed, Master
 	}
+	if( options.batch && options.packed ) //advise on packed trays
+	{
+		if( advise( MappedFile::STDIN, options ) ) return 0;
+		
+		cerr<<"FATAL: Unreadable or truncated batch"<<endl;
+		
+		return FAILURE;
+	}
+	if( options.batch ) //advise on one tray after another
+	{
+		Solver< CrossoutState >* game=NULL;
+		OpeningBook book;
+		string line;
+		
+		options.consult( book );
+		while( getline( cin, line ) )
+		{
+			istringstream query( line );
+			int maxNum, maxSum;
+			
+			//answer even what we can't, to keep the replies in
+			//step with the queries:
+			if( !( query>>maxNum>>maxSum ) || !( query>>ws ).eof()
+				|| maxNum<=0 || maxSum<=0 )
+				cout<<"ERROR: "<<line<<" is not a valid max_num "
+					<<"and max_sum."<<endl;
+			else if( !CrossoutState::fits( maxSum, maxNum ) )
+				cout<<"ERROR: Too many numbers may be taken for "
+					<<"this build."<<endl;
+			else
+			{
+				CrossoutState starting( maxSum, maxNum ); //our
+					//turn
+				
+				if( !recite( book, starting ) )
+				{
+					game=options.reuse( game, starting );
+					advise( *game, options );
+				}
+			}
+		}
+		
+		if( game!=NULL ) options.finish( *game );
+		delete game;
+		
+		return 0;
+	}
 	
 	int index=SIG_INDEX;
 	if( argc>MIN_ARGS ) ++index; //play mode
@@ -62,25 +222,31 @@ int main( int argc, char** argv )
 		}
 	}
 	
+	if( !CrossoutState::fits( descriptors[WHICH_SUM],
+		descriptors[WHICH_MAX] ) )
+	{
+		cerr<<"FATAL: Too many numbers may be taken for this build"
+			<<endl;
+		
+		return FAILURE;
+	}
+	
 	//all systems go
 	if( argc==MIN_ARGS ) //advisory mode
 	{
 		CrossoutState starting( descriptors[WHICH_SUM],
 			descriptors[WHICH_MAX] ); //our turn
-		Solver< CrossoutState > game( starting );
+		OpeningBook book;
+		options.consult( book );
 		
-		if( starting.gameOver() )
-			cout<<"There is nothing you can cross out; you have "
-				<<"already won."<<endl;
-		else
+		if( !recite( book, starting ) )
 		{
-			vector< int > advice=CrossoutState::diff( starting,
-				game.nextBestState() );
-			cout<<"Cross out:";
-			for( vector< int >::iterator piece=advice.begin();
-				piece!=advice.end(); ++piece )
-				cout<<' '<<*piece;
-			cout<<endl;
+			Solver< CrossoutState > game( starting );
+			options.prepare( game );
+			
+			advise( game, options );
+			if( !starting.gameOver() ) options.finish( game );
+				//otherwise, we learned nothing
 		}
 	}
 	else //argc==3 ... interactive mode
@@ -88,6 +254,7 @@ int main( int argc, char** argv )
 		CrossoutState current( descriptors[WHICH_SUM],
 			descriptors[WHICH_MAX], false ); //human's turn
 		Solver< CrossoutState > game( current );
+		options.prepare( game );
 		
 		while( !game.getCurrentState().gameOver() )
 		{
@@ -98,7 +265,7 @@ int main( int argc, char** argv )
 				current=game.getCurrentState();
 				cout<<"Computer: crosses";
 				vector< int > action=CrossoutState::diff(
-					current, game.nextBestState() );
+					current, options.advance( game ) );
 				for( vector< int >::iterator
 					piece=action.begin();
 					piece!=action.end(); ++piece )
@@ -129,6 +296,8 @@ int main( int argc, char** argv )
 					traySize() || optional<0 ||
 					optional==response || optional>game.
 					getCurrentState().traySize() ||
+					unsigned( response+optional )>game.
+					getCurrentState().MAX_SUM ||
 					!game.supplyNextState( CrossoutState
 					( game.getCurrentState(), response,
 					optional ) ) ); //tried and failed to
@@ -147,5 +316,6 @@ int main( int argc, char** argv )
 			CrossoutState::VICTORY ? "Computer wins" : "You win" )
 			<<"!  (Your score was "<<-game.getCurrentState().
 			scoreGame()<<".)"<<endl;
+		options.finish( game );
 	}
 }
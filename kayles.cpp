@@ -5,8 +5,14 @@ The Kayles game.
 @author Kyle Savarese <kms7341@rit.edu>
 */
 #include "Solver.h"
+#include "SolverOptions.h"
+#include "Encoding.h"
+#include "KaylesGrundy.h"
 #include "KaylesState.h"
+#include "MappedFile.h"
+#include "OpeningBook.h"
 #include <cctype>
+#include <climits>
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
@@ -15,94 +21,243 @@ The Kayles game.
 #include <sstream>
 using namespace std;
 
+/**
+Tells the player who's up which pins to bowl over.
+@param starting the position in question
+@param outcome the position after the move
+*/
+static void suggest( const KaylesState& starting, const KaylesState& outcome )
+{
+	vector< int > advice=KaylesState::diff( starting, outcome );
+	
+	cout<<"Target " <<advice[2]<<" pins starting at number "<<advice[1]
+		<<" from line "<<advice[0]<<endl;
+}
+
+/**
+Tells the player who's up which pins to bowl over.
+@param game the <tt>Solver</tt>, at the position in question
+@param options how long to think about it
+@param searching whether to search instead of consulting the nimbers
+*/
+static void advise( Solver< KaylesState >& game, const SolverOptions& options,
+	bool searching )
+{
+	KaylesState starting=game.getCurrentState();
+	
+	if( starting.gameOver() )
+		cout<<"There are no pins; you have already lost."<<endl;
+	else
+		suggest( starting, searching ? options.advance( game ) :
+			KaylesGrundy::nextBestState( starting ) );
+}
+
+/**
+Tells the player who's up which pins to bowl over without searching, if the
+	opening book knows.
+@param book the opening book
+@param starting the position in question
+@return whether it did
+*/
+static bool recite( const OpeningBook& book, const KaylesState& starting )
+{
+	KaylesState outcome=starting;
+	
+	if( !book.move( starting, outcome ) ) return false;
+	
+	suggest( starting, outcome );
+	
+	return true;
+}
+
+/**
+Reads a whole number of pins straight from the command line.
+@param text the number as typed
+@param value where to put it
+@return whether it was an integer and nothing else
+*/
+static bool readInteger( const char* text, int& value )
+{
+	char* end;
+	long number=strtol( text, &end, 10 );
+	
+	if( *text=='\0' || *end!='\0' || number<INT_MIN || number>INT_MAX )
+		return false;
+	
+	value=int( number );
+	
+	return true;
+}
+
+/**
+Advises on each of a batch of alleys packed one to a record, each holding the
+	number of pins in each of its lines as a varint.
+@param path where the batch is
+@param options how to go about it
+@param searching whether to search instead of consulting the nimbers
+@return whether the whole batch was readable
+*/
+static bool advise( const char* path, const SolverOptions& options, bool
+	searching )
+{
+	Solver< KaylesState >* game=NULL;
+	OpeningBook book;
+	MappedFile batch;
+	const char* cursor;
+	const char* record;
+	const char* recordEnd;
+	vector< int > lines;
+	
+	if( !batch.open( path ) ) return false;
+	if( searching ) options.consult( book ); //the nimbers are quicker
+		//still
+	for( cursor=batch.begin(); Encoding::readRecord( cursor, batch.end(),
+		record, recordEnd ); )
+	{
+		uint64_t pins;
+		bool valid=true;
+		
+		lines.clear();
+		while( valid && record<recordEnd )
+		{
+			valid=Encoding::readVarint( record, recordEnd, pins ) &&
+				pins<=INT_MAX;
+			lines.push_back( int( pins ) );
+		}
+		if( !valid ) //answer anyway, to keep in step
+			cout<<"ERROR: Not a valid list of numbers of pins."
+				<<endl;
+		else
+		{
+			KaylesState starting( lines ); //our turn
+			
+			if( !recite( book, starting ) )
+			{
+				game=options.reuse( game, starting );
+				advise( *game, options, searching );
+			}
+		}
+	}
+	
+	if( game!=NULL && searching ) options.finish( *game );
+	delete game;
+	
+	return cursor==batch.end();
+}
+
 int main( int argc, char** argv )
 {
 	const int MIN_ARGS = 2;
 	const char* PLAY = "play";
+	const char* SEARCH = "--search";
+	SolverOptions options;
+	bool searching=false; //whether to search instead of using nimbers
+	int kept=1;
+	for( int arg=1; arg<argc; ++arg )
+		if( strcmp( argv[arg], SEARCH )==0 ) searching=true;
+		else argv[kept++]=argv[arg];
+	argc=kept;
 	//check argument count and switches
-	if( argc<MIN_ARGS || ( !isdigit( argv[1][0] ) &&
-		strcmp( argv[1], PLAY )!=0 ) )
+	if( !options.parse( argc, argv ) || ( options.batch ? argc!=1 :
+		argc<MIN_ARGS || ( !isdigit( argv[1][0] ) &&
+		strcmp( argv[1], PLAY )!=0 ) ) )
 		//bad arguments
 	{
-		cerr<<"USAGE: kayles [play] num_pins_1 num_pins_2 ..."<<endl;
+		cerr<<"USAGE: kayles "<<SolverOptions::USAGE<<" [--search] "
+			<<"[play] num_pins_1 num_pins_2 ..."<<endl;
+		cerr<<"       (with --batch, one set of num_pins per line of "
+			<<"standard input, or per record with --packed)"<<endl;
 		
 		return 1; //I have failed, Master
 	}
-	//collect line counts
-	string s = "";
-	for ( int i = 1; i < argc; i++ ) {
-		s += argv[i];
-		s += " ";
+	if( options.batch && options.packed ) //advise on packed alleys
+	{
+		if( advise( MappedFile::STDIN, options, searching ) ) return 0;
+		
+		cerr<<"FATAL: Unreadable or truncated batch"<<endl;
+		
+		return 1;
 	}
-	stringstream in( s, ios_base::in );
-	vector< int > world;
-	int data;
-	if( isdigit( argv[1][0] ) ) { //Not in play mode
-		while ( in >> data ) {
-			world.push_back( data );
-			if ( data < 0 ) {
-				cerr << data << " is not a valid number of"
-					<<"pins." << endl;
-				return 0;
+	if( options.batch ) //advise on one alley after another
+	{
+		Solver< KaylesState >* game=NULL;
+		OpeningBook book;
+		string line;
+		
+		if( searching ) options.consult( book ); //the nimbers are
+			//quicker still
+		while( getline( cin, line ) )
+		{
+			istringstream query( line );
+			vector< int > lines;
+			int pins;
+			bool valid=true;
+			
+			while( valid && query>>pins )
+			{
+				valid=pins>=0;
+				lines.push_back( pins );
+			}
+			if( !valid || !( query>>ws ).eof() ) //answer anyway,
+				//to keep the replies in step with the queries
+				cout<<"ERROR: "<<line<<" is not a valid list "
+					<<"of numbers of pins."<<endl;
+			else
+			{
+				KaylesState starting( lines ); //our turn
+				
+				if( !recite( book, starting ) )
+				{
+					game=options.reuse( game, starting );
+					advise( *game, options, searching );
+				}
 			}
 		}
-		if ( !in.eof() ) {
-			cerr << in.get() << " is not a valid number of pins."
-				<< endl;
-			return 0;
-		}
+		
+		if( game!=NULL && searching ) options.finish( *game );
+		delete game;
+		
+		return 0;
 	}
-	else { //Play mode
-		string played;
-		unsigned int i;
-		for ( i = 0; !isdigit(s[i]); i++ ) {
-			played += s[i];
-		}
-		string num;
-		while ( i < s.size() ) {
-			num += s[i];
-			i++;
-		}
+	//collect line counts, which follow "play" if it's there
+	vector< int > world;
+	for( int arg=isdigit( argv[1][0] ) ? 1 : 2; arg<argc; ++arg )
+	{
+		int data;
 		
-		stringstream in2( num, ios_base::in );
-		while( in2 >> data ) {
-			world.push_back( data );
-			if ( data < 0 ) {
-				cerr << data << " is not a valid number of"
-					<<"pins." << endl;
-				return 0;
-			}
-		}
-		if ( !in2.eof() ) {
-			cerr << in2.get() << " is not a valid number of"
-				<<"pins." << endl;
+		if( !readInteger( argv[arg], data ) || data<0 )
+		{
+			cerr<<argv[arg]<<" is not a valid number of pins."<<endl;
+			
 			return 0;
 		}
+		world.push_back( data );
 	}
-
+	
 	//all systems go
 	if( isdigit( argv[1][0] ) ) //advisory mode
 	{
 		KaylesState starting( world ); //our turn
-		Solver< KaylesState > game( starting );
+		OpeningBook book;
+		if( searching ) options.consult( book ); //the nimbers are
+			//quicker still
 		
-		if( starting.gameOver() )
-			cout<<"There are no pins; you have already lost."
-				<<endl;
-		else
+		if( !recite( book, starting ) )
 		{
-			KaylesState outcome=game.nextBestState();
-			vector< int > advice=KaylesState::diff( starting,
-				outcome );
-			cout<<"Target " <<advice[2]<<" pins starting at "
-				<<"number "<<advice[1]<<" from line "
-				<<advice[0]<<endl;
+			Solver< KaylesState > game( starting );
+			options.prepare( game );
+			
+			advise( game, options, searching );
+			if( searching && !starting.gameOver() )
+				options.finish( game ); //otherwise, we learned
+				//nothing worth saving
 		}
 	}
 	else //interactive mode
 	{
 		KaylesState current( world, false ); //human's turn
 		Solver< KaylesState > game( current );
+		options.prepare( game );
 		
 		while( !game.getCurrentState().gameOver() )
 		{
@@ -111,8 +266,13 @@ int main( int argc, char** argv )
 			if( game.getCurrentState().computersTurn() )
 			{
 				current=game.getCurrentState();
+				if( searching )
+					options.advance( game );
+				else //consult the nimbers
+					game.supplyNextState( KaylesGrundy::
+						nextBestState( current ) );
 				vector< int > delta=KaylesState::diff(
-					current, game.nextBestState() );
+					current, game.getCurrentState() );
 				
 				cout<<"Computer: downs "<<delta[2]
 					<<" pins starting at number "
@@ -194,5 +354,6 @@ int main( int argc, char** argv )
 			VICTORY ? "Computer wins" : "You win" )<<"!  (Your "
 			<<"score was "<<-game.getCurrentState().scoreGame()
 			<<".)"<<endl;
+		if( searching ) options.finish( game );
 	}
 }
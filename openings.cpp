@@ -0,0 +1,340 @@
+/**
+The opening-book generator, which decides every position within a few plies of
+the usual openings of Connect-3, Crossout, and Kayles on all the cores at once,
+and saves the best move from each as an opening book for the games to consult
+with --book.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+#include "Solver.h"
+#include "SolverOptions.h"
+#include "OpeningBook.h"
+#include "Connect3State.h"
+#include "CrossoutState.h"
+#include "KaylesState.h"
+#include "WorkerPool.h"
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+/** The empty Connect-3 boards to open with, as columns by height */
+static const unsigned int BOARDS[][2]={ { 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 },
+	{ 7, 5 }, { 6, 6 } };
+
+/** The Crossout trays to open with, as max_num and max_sum */
+static const int TRAYS[][2]={ { 10, 30 }, { 14, 40 }, { 16, 60 }, { 18,
+	80 } };
+
+/** The longest single row of Kayles pins to open with */
+static const int LONGEST_ROW=20;
+
+/**
+Decides one of the positions in an opening book, using whichever worker's
+<tt>Solver</tt> picks it up.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+template< typename State >
+class Study : public Task
+{
+	public:
+		/** The index of the best move among the position's
+			successors */
+		OpeningBook::Page choice;
+	
+	private:
+		/** The position to decide */
+		const State position;
+		
+		/** Each worker's <tt>Solver</tt>, or <tt>NULL</tt> if it
+			hasn't needed one yet */
+		vector< Solver< State >* >& solvers;
+		
+		/** How to configure the <tt>Solver</tt>s */
+		const SolverOptions& options;
+		
+		/**
+		Copying is unsupported.
+		*/
+		Study( const Study& );
+		
+		/**
+		Assignment is unsupported.
+		*/
+		Study& operator=( const Study& );
+	
+	public:
+		/**
+		Readies a position for deciding.
+		@param state the position
+		@param workers each worker's <tt>Solver</tt>
+		@param configuration how to configure them
+		*/
+		Study( const State& state, vector< Solver< State >* >& workers,
+			const SolverOptions& configuration );
+		
+		/**
+		Decides the position, on a <tt>Solver</tt> that remembers
+			whatever its worker decided before.
+		@param worker the index of the thread doing it
+		*/
+		virtual void run( unsigned int worker );
+};
+
+/** @brief Constructor */
+template< typename State >
+Study< State >::Study( const State& state, vector< Solver< State >* >&
+	workers, const SolverOptions& configuration ):
+	choice( 0 ), position( state ), solvers( workers ),
+	options( configuration ) {}
+
+/** @brief Decide */
+template< typename State >
+void Study< State >::run( unsigned int worker )
+{
+	MoveBuffer< State > successors;
+	
+	solvers[worker]=options.reuse( solvers[worker], position );
+	
+	const State& best=solvers[worker]->nextBestState();
+	
+	StateTraits< State >::successors( position, successors );
+	for( choice=0; choice<successors.size() && !( successors[choice]==
+		best ); ++choice );
+}
+
+/**
+Lists the distinct positions within some plies of an opening at which it's the
+	computer's turn, which are the ones the games ask about.
+@param roots the opening, with each player to move first
+@param depth how many plies to look ahead
+@param positions where to put them, keyed as the opening book keys them
+@param keys the keys of the positions already in the book, which is updated
+*/
+template< typename State >
+static void survey( const vector< State >& roots, unsigned int depth, vector<
+	State >& positions, set< string >& keys )
+{
+	vector< State > layer( roots );
+	string bytes;
+	
+	for( unsigned int ply=0; ply<=depth && !layer.empty(); ++ply )
+	{
+		vector< State > next;
+		
+		for( typename vector< State >::const_iterator state=
+			layer.begin(); state!=layer.end(); ++state )
+		{
+			if( state->gameOver() ) continue;
+			
+			OpeningBook::key( *state, bytes );
+			if( !keys.insert( bytes ).second ) continue; //been here
+			
+			if( state->computersTurn() ) positions.push_back( *state );
+			if( ply<depth )
+			{
+				MoveBuffer< State > successors;
+				
+				StateTraits< State >::successors( *state,
+					successors );
+				for( unsigned int index=0; index<successors.size();
+					++index )
+					next.push_back( successors[index] );
+			}
+		}
+		layer.swap( next );
+	}
+}
+
+/**
+Decides an opening's positions across the workers and adds them to the book.
+@param label the opening's name
+@param roots the opening, with each player to move first
+@param depth how many plies to look ahead
+@param pool the workers
+@param entries the book's pages so far, which is updated
+@param keys the keys of the positions already in the book, which is updated
+*/
+template< typename State >
+static void compile( const string& label, const vector< State >& roots,
+	unsigned int depth, WorkerPool& pool, vector< OpeningBook::Entry >& entries,
+	set< string >& keys )
+{
+	vector< State > positions;
+	vector< Solver< State >* > solvers( pool.size(), NULL );
+	vector< Study< State >* > studies;
+	SolverOptions options;
+	TaskGroup group;
+	
+	survey( roots, depth, positions, keys );
+	for( typename vector< State >::const_iterator position=
+		positions.begin(); position!=positions.end(); ++position )
+	{
+		studies.push_back( new Study< State >( *position, solvers,
+			options ) );
+		pool.spawn( 0, *studies.back(), group );
+	}
+	pool.wait( 0, group );
+	
+	for( size_t index=0; index<positions.size(); ++index )
+	{
+		entries.push_back( OpeningBook::Entry( string(),
+			studies[index]->choice ) );
+		OpeningBook::key( positions[index], entries.back().first );
+		delete studies[index];
+	}
+	for( size_t worker=0; worker<solvers.size(); ++worker )
+		delete solvers[worker];
+	
+	cout<<label<<": "<<positions.size()<<" positions"<<endl;
+}
+
+/**
+Counts the elements of an array.
+@param array the array
+@return how many
+*/
+template< typename Element, size_t COUNT >
+static size_t lengthOf( const Element ( & )[COUNT] )
+{
+	return COUNT;
+}
+
+/**
+Decides whether a game was asked for.
+@param game the game's name
+@param names the games asked for, or none for all of them
+@return whether to include it
+*/
+static bool wanted( const char* game, const vector< string >& names )
+{
+	if( names.empty() ) return true;
+	
+	for( vector< string >::const_iterator name=names.begin();
+		name!=names.end(); ++name )
+		if( *name==game ) return true;
+	
+	return false;
+}
+
+/**
+Reads a natural number from the command line.
+@param text the number as typed
+@param value where to put it
+@return whether it was a nonnegative integer
+*/
+static bool readNatural( const char* text, unsigned int& value )
+{
+	char* end;
+	long number=strtol( text, &end, 10 );
+	
+	if( *text=='\0' || *end!='\0' || number<0 || number>INT_MAX )
+		return false;
+	
+	value=static_cast< unsigned int >( number );
+	
+	return true;
+}
+
+int main( int argc, char** argv )
+{
+	const char* THREADS="--threads";
+	const char* DEPTH="--depth";
+	const char* ASYMMETRIC="--asymmetric";
+	const char* GAMES[]={ "connect3", "crossout", "kayles" };
+	const unsigned int DEFAULT_DEPTH=4;
+	const int FAILURE=1;
+	unsigned int threads=0;
+	unsigned int depth=DEFAULT_DEPTH;
+	const char* path=NULL;
+	vector< string > names;
+	bool usable=true;
+	
+	for( int arg=1; arg<argc && usable; ++arg )
+		if( strcmp( argv[arg], THREADS )==0 )
+			usable=arg+1<argc && readNatural( argv[++arg], threads );
+		else if( strcmp( argv[arg], DEPTH )==0 )
+			usable=arg+1<argc && readNatural( argv[++arg], depth );
+		else if( strcmp( argv[arg], ASYMMETRIC )==0 )
+			Connect3State::symmetric=false; //tell mirror images apart
+		else if( path==NULL ) path=argv[arg];
+		else
+		{
+			usable=false;
+			for( size_t game=0; game<lengthOf( GAMES ); ++game )
+				if( strcmp( argv[arg], GAMES[game] )==0 )
+					usable=true;
+			names.push_back( argv[arg] );
+		}
+	if( !usable || path==NULL )
+	{
+		cerr<<"USAGE: openings [--threads N] [--depth N] [--asymmetric] "
+			<<"output_file [connect3] [crossout] [kayles]"<<endl;
+		
+		return FAILURE; //I have failed, Master
+	}
+	
+	WorkerPool pool( threads==0 ? WorkerPool::available() : threads );
+	vector< OpeningBook::Entry > entries;
+	set< string > keys;
+	
+	if( wanted( GAMES[0], names ) )
+		for( size_t board=0; board<lengthOf( BOARDS ); ++board )
+		{
+			unsigned int columns=BOARDS[board][0];
+			unsigned int height=BOARDS[board][1];
+			vector< vector< char > > empty( columns );
+			vector< Connect3State > roots;
+			ostringstream label;
+			
+			if( !Connect3State::fits( columns, height ) ) continue;
+			roots.push_back( Connect3State( columns, height, empty ) );
+			roots.push_back( Connect3State( columns, height, empty,
+				false ) ); //the human may go first
+			label<<GAMES[0]<<' '<<columns<<'x'<<height;
+			compile( label.str(), roots, depth, pool, entries, keys );
+		}
+	if( wanted( GAMES[1], names ) )
+		for( size_t tray=0; tray<lengthOf( TRAYS ); ++tray )
+		{
+			int maxNum=TRAYS[tray][0];
+			int maxSum=TRAYS[tray][1];
+			vector< CrossoutState > roots;
+			ostringstream label;
+			
+			if( !CrossoutState::fits( maxSum, maxNum ) ) continue;
+			roots.push_back( CrossoutState( maxSum, maxNum ) );
+			roots.push_back( CrossoutState( maxSum, maxNum, false ) );
+			label<<GAMES[1]<<' '<<maxNum<<' '<<maxSum;
+			compile( label.str(), roots, depth, pool, entries, keys );
+		}
+	if( wanted( GAMES[2], names ) )
+		for( int pins=1; pins<=LONGEST_ROW; ++pins )
+		{
+			vector< int > row( 1, pins );
+			vector< KaylesState > roots;
+			ostringstream label;
+			
+			roots.push_back( KaylesState( row ) );
+			roots.push_back( KaylesState( row, false ) );
+			label<<GAMES[2]<<' '<<pins;
+			compile( label.str(), roots, depth, pool, entries, keys );
+		}
+	
+	if( !OpeningBook::write( path, entries ) )
+	{
+		cerr<<"FATAL: Unable to write file "<<path<<endl;
+		
+		return FAILURE;
+	}
+	
+	cout<<"Wrote "<<entries.size()<<" positions into "<<path<<endl;
+	
+	return 0;
+}
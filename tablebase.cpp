@@ -0,0 +1,145 @@
+/**
+The tablebase generator, which decides every position reachable from a starting
+one from the end of the game back, and saves them all as a solution database
+for the games to consult with --load-memo.
+
+@author Sol Boucher <slb1566@rit.edu>
+*/
+#include "Solver.h"
+#include "Connect3State.h"
+#include "Connect3Helper.h"
+#include "CrossoutState.h"
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+using namespace std;
+
+/**
+Decides everything reachable from a position and saves it.
+@param root the position
+@param path where to put the tablebase
+@return the program's exit status
+*/
+template< typename State >
+static int tabulate( const State& root, const char* path )
+{
+	Solver< State > game( root );
+	uint64_t positions=game.tabulate();
+	
+	if( positions==0 )
+	{
+		cerr<<"FATAL: Out of memory for positions"<<endl;
+		
+		return 1;
+	}
+	if( !game.record( path ) )
+	{
+		cerr<<"FATAL: Unable to write file "<<path<<endl;
+		
+		return 1;
+	}
+	
+	cout<<"Decided "<<positions<<" positions into "<<path<<endl;
+	
+	return 0;
+}
+
+/**
+Reads a natural number from the command line.
+@param text the number as typed
+@param value where to put it
+@return whether it was a positive integer
+*/
+static bool readPositive( const char* text, int& value )
+{
+	char* end;
+	long number=strtol( text, &end, 10 );
+	
+	if( *text=='\0' || *end!='\0' || number<=0 || number>INT_MAX )
+		return false;
+	
+	value=int( number );
+	
+	return true;
+}
+
+int main( int argc, char** argv )
+{
+	const char* CONNECT3="connect3";
+	const char* CROSSOUT="crossout";
+	const char* STDIN="-";
+	const char* ASYMMETRIC="--asymmetric";
+	const int FAILURE=1;
+	
+	int kept=1;
+	for( int arg=1; arg<argc; ++arg )
+		if( strcmp( argv[arg], ASYMMETRIC )==0 )
+			Connect3State::symmetric=false; //tell mirror images apart
+		else argv[kept++]=argv[arg];
+	argc=kept;
+	
+	if( argc==4 && strcmp( argv[1], CONNECT3 )==0 )
+	{
+		vector< vector< char > > board;
+		int height;
+		bool read;
+		
+		if( strcmp( argv[2], STDIN )==0 ) //read from stdin
+			read=Connect3Helper::decodeBoard( cin, board, height );
+		else //read from file
+		{
+			ifstream file( argv[2] );
+			
+			if( file.fail() )
+			{
+				cerr<<"FATAL: Unable to open file "<<argv[2]
+					<<endl;
+				
+				return FAILURE;
+			}
+			read=Connect3Helper::decodeBoard( file, board, height );
+		}
+		if( !read ) return FAILURE;
+		
+		if( !Connect3State::fits( board.size(), height ) )
+		{
+			cerr<<"FATAL: Board too large for this build (try make "
+				<<"wide)"<<endl;
+			
+			return FAILURE;
+		}
+		
+		return tabulate( Connect3State( board.size(), height, board ),
+			argv[3] );
+	}
+	else if( argc==5 && strcmp( argv[1], CROSSOUT )==0 )
+	{
+		int maxNum, maxSum;
+		
+		if( !readPositive( argv[2], maxNum ) || !readPositive( argv[3],
+			maxSum ) )
+		{
+			cerr<<"FATAL: max_num and max_sum must be positive "
+				<<"integers"<<endl;
+			
+			return FAILURE;
+		}
+		if( !CrossoutState::fits( maxSum, maxNum ) )
+		{
+			cerr<<"FATAL: Too many numbers may be taken for this "
+				<<"build"<<endl;
+			
+			return FAILURE;
+		}
+		
+		return tabulate( CrossoutState( maxSum, maxNum ), argv[4] );
+	}
+	
+	cerr<<"USAGE: tablebase [--asymmetric] connect3 <filename | -> "
+		<<"output_file"<<endl;
+	cerr<<"       tablebase crossout max_num max_sum output_file"<<endl;
+	
+	return FAILURE; //I have failed, Master
+}
@@ -5,7 +5,12 @@ The Takeaway game.
 @author Kyle Savarese <kms7341@rit.edu>
 */
 #include "Solver.h"
+#include "SolverOptions.h"
+#include "Encoding.h"
+#include "MappedFile.h"
+#include "SubtractionGame.h"
 #include "TakeawayState.h"
+#include <climits>
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
@@ -13,52 +18,161 @@ The Takeaway game.
 #include <iostream>
 using namespace std;
 
+/**
+Tells the player who's up how many pennies to take.
+@param game the <tt>Solver</tt>, at the position in question
+@param rules the period of the game's outcomes
+@param options how long to think about it
+@param searching whether to search instead of consulting the period
+*/
+static void advise( Solver< TakeawayState >& game, const SubtractionGame&
+	rules, const SolverOptions& options, bool searching )
+{
+	TakeawayState starting=game.getCurrentState();
+	
+	if( starting.gameOver() )
+		cout<<"There are no pennies; you have already won."<<endl;
+	else
+	{
+		TakeawayState outcome=searching ? options.advance( game ) :
+			TakeawayState( starting, rules.bestTake(
+			starting.getPileSize() ) );
+		cout<<"Take "<<TakeawayState::diff( starting, outcome )
+			<<" pennies ";
+		cout<<"to leave "<<outcome.getPileSize()<<" for the opponent."
+			<<endl;
+	}
+}
+
+/**
+Reads a whole number of pennies straight from the command line.
+@param text the number as typed
+@param value where to put it
+@return whether it was an integer and nothing else
+*/
+static bool readInteger( const char* text, int& value )
+{
+	char* end;
+	long number=strtol( text, &end, 10 );
+	
+	if( *text=='\0' || *end!='\0' || number<INT_MIN || number>INT_MAX )
+		return false;
+	
+	value=int( number );
+	
+	return true;
+}
+
+/**
+Advises on each of a batch of piles packed one to a record, each holding its
+	number of pennies as a varint.
+@param path where the batch is
+@param rules the period of the game's outcomes
+@param options how to go about it
+@param searching whether to search instead of consulting the period
+@return whether the whole batch was readable
+*/
+static bool advise( const char* path, const SubtractionGame& rules, const
+	SolverOptions& options, bool searching )
+{
+	Solver< TakeawayState >* game=NULL;
+	MappedFile batch;
+	const char* cursor;
+	const char* record;
+	const char* recordEnd;
+	uint64_t pennies;
+	
+	if( !batch.open( path ) ) return false;
+	for( cursor=batch.begin(); Encoding::readRecord( cursor, batch.end(),
+		record, recordEnd ); )
+		if( !Encoding::readVarint( record, recordEnd, pennies ) ||
+			record!=recordEnd || pennies>INT_MAX ) //answer anyway
+			cout<<"ERROR: Not a valid number of pennies."<<endl;
+		else
+		{
+			game=options.reuse( game, TakeawayState( int( pennies )
+				) ); //our turn
+			advise( *game, rules, options, searching );
+		}
+	
+	if( game!=NULL && searching ) options.finish( *game );
+	delete game;
+	
+	return cursor==batch.end();
+}
+
 int main( int argc, char** argv )
 {
 	const char* PLAY = "play";
 	const int MIN_ARGS = 2;
 	const int PLAY_ARGS = 3;
-	const int SIG_INDEX = 1;
 	const int MIN_PENNIES = 0;
+	const char* SEARCH = "--search";
+	SolverOptions options;
+	bool searching=false; //whether to search instead of using the period
+	int kept=1;
+	for( int arg=1; arg<argc; ++arg )
+		if( strcmp( argv[arg], SEARCH )==0 ) searching=true;
+		else argv[kept++]=argv[arg];
+	argc=kept;
 	//check argument count and switches
-	if( argc<MIN_ARGS || argc>PLAY_ARGS || ( argc==PLAY_ARGS &&
-		strcmp( argv[1], PLAY )!=0 ) ) //ba
+	if( !options.parse( argc, argv ) || ( options.batch ? argc!=1 :
+		argc<MIN_ARGS || argc>PLAY_ARGS || ( argc==PLAY_ARGS &&
+		strcmp( argv[1], PLAY )!=0 ) ) ) //ba
 		//d arguments
 	{
-		cerr<<"USAGE: takeaway [play] num_pennies"<<endl;
+		cerr<<"USAGE: takeaway "<<SolverOptions::USAGE<<" [--search] "
+			<<"[play] num_pennies"<<endl;
+		cerr<<"       (with --batch, one num_pennies per line of "
+			<<"standard input, or per record with --packed)"<<endl;
 		
 		return 1; //I have failed, Master
 	}
-	string s = "";
-	for ( int i = 1; i < argc; i++ ) {
-		s+= argv[i];
-	}
-	stringstream in( s, ios_base::in);
-	int startingNumber;
-	if ( argc==MIN_ARGS ) { //Not in play mode
-		if ( !( in >> startingNumber ) ) {
-			cerr << argv[SIG_INDEX] << " is an invalid number of"
-				<<"pennies."<< endl;
+	const SubtractionGame rules( TakeawayState::MIN_TAKEN,
+		TakeawayState::MAX_TAKEN );
+	if( options.batch && options.packed ) //advise on packed piles
+	{
+		if( advise( MappedFile::STDIN, rules, options, searching ) )
 			return 0;
-		}
+		
+		cerr<<"FATAL: Unreadable or truncated batch"<<endl;
+		
+		return 1;
 	}
-	else { //Play mode
-		string played;
-		unsigned int i;
-		for ( i = 0; !isdigit(s[i]) && s[i] != '-'; i++ ) {
-			played += s[i];
-		}
-		string num;
-		while ( i < s.size() ) {
-			num += s[i];
-			i++;
-		}
-		stringstream in2( num, ios_base::in);
-		if ( !( in2 >> startingNumber) ) {
-			cerr << argv[SIG_INDEX+1] << " is an invalid number"
-				<<"of pennies." << endl;
-			return 0;
+	if( options.batch ) //advise on one pile after another
+	{
+		Solver< TakeawayState >* game=NULL;
+		string line;
+		
+		while( getline( cin, line ) )
+		{
+			istringstream query( line );
+			int pennies;
+			
+			if( !( query>>pennies ) || !( query>>ws ).eof() ||
+				pennies<MIN_PENNIES ) //answer anyway, to keep
+				//the replies in step with the queries
+				cout<<"ERROR: "<<line<<" is an invalid number "
+					<<"of pennies."<<endl;
+			else
+			{
+				game=options.reuse( game, TakeawayState(
+					pennies ) ); //our turn
+				advise( *game, rules, options, searching );
+			}
 		}
+		
+		if( game!=NULL && searching ) options.finish( *game );
+		delete game;
+		
+		return 0;
+	}
+	int startingNumber;
+	if( !readInteger( argv[argc-1], startingNumber ) ) //the pile comes
+		//last, whether or not we're playing
+	{
+		cerr<<argv[argc-1]<<" is an invalid number of pennies."<<endl;
+		return 0;
 	}
 	
 	//check initial pile count
@@ -75,22 +189,17 @@ int main( int argc, char** argv )
 	{
 		TakeawayState starting( startingNumber ); //our turn
 		Solver< TakeawayState > game( starting );
+		options.prepare( game );
 		
-		if( starting.gameOver() )
-			cout<<"There are no pennies; you have already won."
-				<<endl;
-		else
-		{
-			cout<<"Take "<<TakeawayState::diff( starting,
-				game.nextBestState() )<<" pennies ";
-			cout<<"to leave "<<game.getCurrentState().
-				getPileSize()<<" for the opponent."<<endl;
-		}
+		advise( game, rules, options, searching );
+		if( searching && !starting.gameOver() ) options.finish( game );
+			//otherwise, we learned nothing worth saving
 	}
 	else //argc==3 ... interactive mode
 	{
 		TakeawayState current( startingNumber, false ); //human's turn
 		Solver< TakeawayState > game( current );
+		options.prepare( game );
 		
 		while( !game.getCurrentState().gameOver() )
 		{
@@ -99,8 +208,14 @@ int main( int argc, char** argv )
 			if( game.getCurrentState().computersTurn() )
 			{
 				current=game.getCurrentState();
+				if( searching )
+					options.advance( game );
+				else //consult the period
+					game.supplyNextState( TakeawayState(
+						current, rules.bestTake(
+						current.getPileSize() ) ) );
 				cout<<"Computer: takes "<<TakeawayState::diff(
-					current, game.nextBestState() )
+					current, game.getCurrentState() )
 					<<" pennies"<<endl;
 			}
 			else //player's turn
@@ -136,5 +251,6 @@ int main( int argc, char** argv )
 			TakeawayState::VICTORY ? "Computer wins" : "You win" )
 			<<"!  (Your score was "<<-game.getCurrentState().
 			scoreGame()<<".)"<<endl;
+		if( searching ) options.finish( game );
 	}
 }